@@ -0,0 +1,323 @@
+#!/usr/bin/env python3
+"""
+回归基准测试套件
+
+按命名的工作负载 profile 对固定语料（tests/integration/test_data/complex_c）
+压测，从 PerformanceMetrics 汇出 P50/P95/P99，
+与存储的基线对比并按可配置阈值判定回归。
+
+用法:
+    python scripts/benchmark_suite.py                      # 跑全部 profile 并对比基线
+    python scripts/benchmark_suite.py --profiles interactive,callgraph
+    python scripts/benchmark_suite.py --update-baseline    # 把本次结果存为新基线
+    python scripts/benchmark_suite.py --threshold 0.3      # 允许 30% 退化
+
+退出码: 0 = 无回归, 1 = 检出回归, 2 = 环境/执行错误
+"""
+
+import argparse
+import asyncio
+import json
+import sys
+from datetime import datetime
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).parent.parent / "src"))
+
+from loguru import logger
+
+from joern_mcp.joern.executor_optimized import OptimizedQueryExecutor
+from joern_mcp.joern.manager import JoernManager, JoernNotFoundError
+from joern_mcp.joern.server import JoernServerManager
+from joern_mcp.joern.templates import QueryTemplates
+from joern_mcp.models.taint_rules import VULNERABILITY_RULES
+from joern_mcp.services.callgraph import CallGraphService
+from joern_mcp.services.taint import TaintAnalysisService
+from joern_mcp.utils.performance import get_metrics, reset_metrics
+
+# 固定语料：复杂度适中的多文件 C 项目，结果可跨机器纵向对比
+DEFAULT_CORPUS = (
+    Path(__file__).parent.parent / "tests" / "integration" / "test_data" / "complex_c"
+)
+DEFAULT_BASELINE = Path(__file__).parent / "benchmark_baselines.json"
+PROJECT_NAME = "benchmark-corpus"
+
+# 回归判定的默认阈值：当前 P95 超过基线 P95 的 20% 视为回归
+DEFAULT_THRESHOLD = 0.2
+
+# complex_c 语料中的代表性函数（用于调用图/模板查询）
+CORPUS_FUNCTIONS = ["main", "process_data", "execute_command", "receive_network_data"]
+
+
+class BenchmarkSuite:
+    """命名工作负载基准套件"""
+
+    def __init__(self, corpus: Path):
+        self.corpus = corpus
+        self.server: JoernServerManager | None = None
+        self.executor: OptimizedQueryExecutor | None = None
+        self.callgraph: CallGraphService | None = None
+        self.taint: TaintAnalysisService | None = None
+
+    async def setup(self) -> None:
+        """启动 Joern 并导入基准语料"""
+        if not self.corpus.exists():
+            raise FileNotFoundError(f"Benchmark corpus not found: {self.corpus}")
+
+        logger.info(f"Setting up benchmark environment (corpus: {self.corpus})")
+
+        manager = JoernManager()
+        self.server = JoernServerManager(joern_manager=manager, port=19998)
+        await self.server.start(timeout=120)
+
+        self.executor = OptimizedQueryExecutor(self.server)
+        self.callgraph = CallGraphService(self.executor)
+        self.taint = TaintAnalysisService(self.executor)
+
+        result = await self.server.import_code(
+            str(self.corpus.absolute()), PROJECT_NAME
+        )
+        if not result.get("success"):
+            raise RuntimeError(f"Corpus import failed: {result.get('stderr')}")
+
+        logger.info("Benchmark environment ready")
+
+    async def teardown(self) -> None:
+        """清理环境"""
+        if self.server:
+            await self.server.stop()
+
+    def _fresh_metrics(self):
+        """重置全局指标并重新绑定到执行器"""
+        reset_metrics()
+        self.executor.metrics = get_metrics()
+        return self.executor.metrics
+
+    # ==========================================
+    # 工作负载 profile
+    # ==========================================
+
+    async def profile_interactive(self) -> None:
+        """交互式查询：分析师逐个函数查看的典型节奏"""
+        for name in CORPUS_FUNCTIONS:
+            await self.executor.execute(
+                QueryTemplates.build("GET_FUNCTION", name=name), use_cache=False
+            )
+        await self.executor.execute(
+            QueryTemplates.build("LIST_FUNCTIONS", limit=50), use_cache=False
+        )
+        for pattern in ("alloc", "copy", "free"):
+            await self.executor.execute(
+                QueryTemplates.build(
+                    "SEARCH_CALLS_BY_PATTERN", pattern=pattern, limit=20
+                ),
+                use_cache=False,
+            )
+
+    async def profile_callgraph(self) -> None:
+        """调用图扩展：callers/callees/调用链遍历"""
+        for name in CORPUS_FUNCTIONS:
+            await self.callgraph.get_callers(name, project_name=PROJECT_NAME)
+            await self.callgraph.get_callees(name, project_name=PROJECT_NAME)
+        await self.callgraph.get_call_chain(
+            "main", max_depth=3, direction="down", project_name=PROJECT_NAME
+        )
+
+    async def profile_taint_sweep(self) -> None:
+        """全量污点扫描：按内置规则集跑融合扫描"""
+        await self.taint.scan_all_rules(
+            max_flows_per_group=20, project_name=PROJECT_NAME
+        )
+
+    async def profile_batch(self) -> None:
+        """批量模式：并发提交一批独立查询"""
+        queries = [
+            "cpg.method.size",
+            "cpg.call.size",
+            "cpg.file.name.l",
+            'cpg.method.name("main").parameter.name.l',
+            'cpg.call.name("(str|mem)cpy").code.l',
+            "cpg.method.isExternal(false).name.l",
+        ]
+        await asyncio.gather(
+            *(self.executor.execute(q, use_cache=False) for q in queries),
+            return_exceptions=True,
+        )
+
+    # ==========================================
+    # 运行与对比
+    # ==========================================
+
+    PROFILES = {
+        "interactive": profile_interactive,
+        "callgraph": profile_callgraph,
+        "taint_sweep": profile_taint_sweep,
+        "batch": profile_batch,
+    }
+
+    async def run(self, profile_names: list[str], iterations: int) -> dict:
+        """运行指定 profile，返回机器可读的报告"""
+        report = {
+            "timestamp": datetime.now().isoformat(),
+            "corpus": str(self.corpus),
+            "iterations": iterations,
+            "rule_count": len(VULNERABILITY_RULES),
+            "profiles": {},
+        }
+
+        for name in profile_names:
+            profile = self.PROFILES[name]
+            logger.info(f"Running profile: {name} ({iterations} iteration(s))")
+
+            metrics = self._fresh_metrics()
+            errors = 0
+            for _ in range(iterations):
+                try:
+                    await profile(self)
+                except Exception as e:
+                    errors += 1
+                    logger.warning(f"Profile {name} iteration failed: {e}")
+
+            snapshot = metrics.to_dict()
+            snapshot["profile_errors"] = errors
+            report["profiles"][name] = snapshot
+            logger.info(
+                f"  {name}: p50={snapshot['p50']}s "
+                f"p95={snapshot['p95']}s p99={snapshot['p99']}s "
+                f"({snapshot['total_queries']} queries)"
+            )
+
+        return report
+
+
+def compare_with_baseline(
+    report: dict, baseline: dict, threshold: float
+) -> list[dict]:
+    """对比基线，返回回归列表
+
+    判定标准：P95 超过基线 (1 + threshold) 倍即回归；
+    P50 同样参与对比，便于发现整体劣化而非仅尾延迟。
+    """
+    regressions = []
+    baseline_profiles = baseline.get("profiles", {})
+
+    for name, current in report["profiles"].items():
+        base = baseline_profiles.get(name)
+        if base is None:
+            logger.warning(f"No baseline for profile {name}, skipping comparison")
+            continue
+
+        for metric in ("p50", "p95"):
+            base_value = base.get(metric, 0)
+            current_value = current.get(metric, 0)
+            if base_value <= 0:
+                continue
+            ratio = current_value / base_value
+            if ratio > 1 + threshold:
+                regressions.append(
+                    {
+                        "profile": name,
+                        "metric": metric,
+                        "baseline": base_value,
+                        "current": current_value,
+                        "ratio": round(ratio, 2),
+                    }
+                )
+
+    return regressions
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Joern MCP 回归基准套件")
+    parser.add_argument(
+        "--profiles",
+        default=",".join(BenchmarkSuite.PROFILES),
+        help="逗号分隔的 profile 列表",
+    )
+    parser.add_argument(
+        "--corpus", type=Path, default=DEFAULT_CORPUS, help="基准语料路径"
+    )
+    parser.add_argument(
+        "--baseline", type=Path, default=DEFAULT_BASELINE, help="基线文件路径"
+    )
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=DEFAULT_THRESHOLD,
+        help="回归阈值（0.2 = 允许 20%% 退化）",
+    )
+    parser.add_argument(
+        "--iterations", type=int, default=3, help="每个 profile 的迭代次数"
+    )
+    parser.add_argument(
+        "--update-baseline",
+        action="store_true",
+        help="把本次结果写入基线文件",
+    )
+    parser.add_argument(
+        "--output", type=Path, default=None, help="报告输出路径（默认带时间戳）"
+    )
+    args = parser.parse_args()
+
+    profile_names = [p.strip() for p in args.profiles.split(",") if p.strip()]
+    unknown = [p for p in profile_names if p not in BenchmarkSuite.PROFILES]
+    if unknown:
+        logger.error(f"Unknown profiles: {unknown}")
+        return 2
+
+    suite = BenchmarkSuite(args.corpus)
+
+    async def run_suite() -> dict:
+        try:
+            await suite.setup()
+            return await suite.run(profile_names, args.iterations)
+        finally:
+            await suite.teardown()
+
+    try:
+        report = asyncio.run(run_suite())
+    except (JoernNotFoundError, FileNotFoundError, RuntimeError) as e:
+        logger.error(f"Benchmark failed: {e}")
+        return 2
+
+    # 保存报告
+    output = args.output
+    if output is None:
+        output_dir = Path(__file__).parent.parent / "benchmark_results"
+        output_dir.mkdir(exist_ok=True)
+        timestamp = datetime.now().strftime("%Y%m%d_%H%M%S")
+        output = output_dir / f"benchmark_suite_{timestamp}.json"
+    output.write_text(json.dumps(report, indent=2), encoding="utf-8")
+    logger.info(f"Report saved to: {output}")
+
+    # 基线更新或对比
+    if args.update_baseline:
+        args.baseline.write_text(json.dumps(report, indent=2), encoding="utf-8")
+        logger.info(f"Baseline updated: {args.baseline}")
+        return 0
+
+    if not args.baseline.exists():
+        logger.warning(
+            f"No baseline at {args.baseline}; "
+            f"run with --update-baseline to create one"
+        )
+        return 0
+
+    baseline = json.loads(args.baseline.read_text(encoding="utf-8"))
+    regressions = compare_with_baseline(report, baseline, args.threshold)
+
+    if regressions:
+        logger.error(f"Detected {len(regressions)} regression(s):")
+        for r in regressions:
+            logger.error(
+                f"  {r['profile']}.{r['metric']}: "
+                f"{r['baseline']}s -> {r['current']}s ({r['ratio']}x)"
+            )
+        return 1
+
+    logger.info("No regressions detected")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -34,6 +34,38 @@ class Settings(BaseSettings):
         default=None,
         description="Joern 服务器认证密码（可选）",
     )
+    joern_server_pool_size: int = Field(
+        default=1,
+        description="Joern 服务器进程池大小（>1 时启用多进程负载均衡）",
+    )
+    joern_shard_endpoints: str = Field(
+        default="",
+        description="Joern 分片端点列表（逗号分隔 host:port）；非空时启用按项目分片路由，项目分散到多台主机承载",
+    )
+    joern_background_boot: bool = Field(
+        default=True,
+        description="后台启动 Joern 进程（MCP 立即可响应，早到的查询排队等待就绪）",
+    )
+    joern_warmup_enabled: bool = Field(
+        default=True,
+        description="启动后执行预热查询（触发 JVM JIT 编译，降低首查询延迟）",
+    )
+    joern_boot_wait_timeout: int = Field(
+        default=180,
+        description="查询等待后台启动完成的最长时间（秒）",
+    )
+    supervisor_enabled: bool = Field(
+        default=True,
+        description="启用后台健康监督器（被动巡检 + 挂死自动重启）",
+    )
+    supervisor_check_interval: int = Field(
+        default=15,
+        description="监督器巡检间隔（秒）",
+    )
+    supervisor_hang_threshold: int = Field(
+        default=120,
+        description="有在途查询但无任何完成超过此时长（秒）视为疑似挂死",
+    )
 
     # ==========================================
     # Joern 路径配置
@@ -58,6 +90,10 @@ class Settings(BaseSettings):
         default=5,
         description="最大并发查询数",
     )
+    parse_queue_parallelism: int = Field(
+        default=2,
+        description="解析队列并行度（parse_projects 同时执行的导入数）",
+    )
     query_timeout: int = Field(
         default=300,
         description="查询超时时间（秒）",
@@ -70,6 +106,38 @@ class Settings(BaseSettings):
         default=3600,
         description="查询结果缓存 TTL（秒）",
     )
+    query_cache_persist: bool = Field(
+        default=True,
+        description="是否启用磁盘持久化查询缓存（跨进程重启存活）",
+    )
+    query_cache_persist_ttl: int = Field(
+        default=604800,
+        description="持久化查询缓存 TTL（秒），默认 7 天",
+    )
+    query_cache_backend: str = Field(
+        default="sqlite",
+        description="L2 查询缓存后端: sqlite(单机磁盘) 或 redis(多实例共享)",
+    )
+    redis_url: str = Field(
+        default="redis://localhost:6379/0",
+        description="Redis 连接 URL（query_cache_backend=redis 时使用）",
+    )
+    dot_inline_max_bytes: int = Field(
+        default=1048576,
+        description="DOT 图内联返回的大小上限（字节），超过时返回文件路径",
+    )
+    query_advisor_enabled: bool = Field(
+        default=True,
+        description="启用慢查询顾问（自动改写已知病态 CPGQL 模式并附带优化提示）",
+    )
+    flow_summary_enabled: bool = Field(
+        default=True,
+        description="启用汇函数数据流摘要缓存（同汇多源的配对探查首查后即答）",
+    )
+    flow_summary_max_flows: int = Field(
+        default=200,
+        description="单个汇摘要保留的最大流数量（达到上限视为截断，未命中源时退回直查）",
+    )
 
     # ==========================================
     # 安全配置
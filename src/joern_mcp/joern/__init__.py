@@ -2,17 +2,23 @@
 
 提供与 Joern Server 交互的组件：
 - JoernServerManager: 服务器生命周期管理
+- JoernServerPool: 多进程服务器池（负载均衡）
 - JoernHTTPClient: HTTP+WebSocket 客户端
 - QueryExecutor: 查询执行器
+- PreparedQueryRegistry: 预编译查询注册表
 - queries: 查询辅助函数
 """
 
 from joern_mcp.joern.http_client import JoernHTTPClient
 from joern_mcp.joern.manager import JoernManager
+from joern_mcp.joern.pool import JoernServerPool
+from joern_mcp.joern.prepared import PreparedQueryRegistry
 from joern_mcp.joern.server import JoernServerManager
 
 __all__ = [
     "JoernHTTPClient",
     "JoernManager",
     "JoernServerManager",
+    "JoernServerPool",
+    "PreparedQueryRegistry",
 ]
@@ -9,6 +9,8 @@ from loguru import logger
 
 from joern_mcp.config import settings
 from joern_mcp.joern.server import JoernServerManager
+from joern_mcp.utils.cache_key import get_cache_key_stats, normalize_query
+from joern_mcp.utils.projection import apply_projection
 
 
 class QueryExecutionError(Exception):
@@ -49,6 +51,8 @@ class QueryExecutor:
         format: str = "json",
         timeout: int | None = None,
         use_cache: bool = True,
+        prepared: tuple | None = None,  # noqa: ARG002 基础执行器不支持预编译，直接执行 query
+        fields: list[str] | None = None,
     ) -> dict:
         """
         执行查询
@@ -58,6 +62,8 @@ class QueryExecutor:
             format: 输出格式 (json, dot等)
             timeout: 超时时间（秒）
             use_cache: 是否使用缓存
+            prepared: 预编译查询规格（仅 OptimizedQueryExecutor 支持，此处忽略）
+            fields: 投影字段列表；指定时裸遍历在序列化前被改写为只输出这些字段
 
         Returns:
             查询结果字典
@@ -68,12 +74,17 @@ class QueryExecutor:
             logger.warning(f"Query validation failed: {error_msg}")
             raise QueryValidationError(error_msg)
 
-        # 2. 确保查询返回正确格式
-        query = self._format_query(query, format)
+        # 2. 投影下推 + 确保查询返回正确格式
+        try:
+            query = self._format_query(query, format, fields)
+        except ValueError as e:
+            raise QueryValidationError(str(e)) from None
 
         # 3. 检查缓存
         cache_key = self._get_cache_key(query)
-        if use_cache and cache_key in self.cache:
+        hit = use_cache and cache_key in self.cache
+        get_cache_key_stats().observe(query, normalize_query(query), hit)
+        if hit:
             logger.debug("Cache hit")
             return self.cache[cache_key]
 
@@ -128,11 +139,15 @@ class QueryExecutor:
 
         return True, ""
 
-    def _format_query(self, query: str, format: str) -> str:
+    def _format_query(
+        self, query: str, format: str, fields: list[str] | None = None
+    ) -> str:
         """格式化查询以返回指定格式"""
         query = query.strip()
 
         if format == "json":
+            if fields:
+                query = apply_projection(query, fields)
             if not query.endswith(".toJson"):
                 # 如果查询是一个语句块，需要用括号包裹
                 if "\n" in query or query.count(";") > 0:
@@ -145,8 +160,8 @@ class QueryExecutor:
         return query
 
     def _get_cache_key(self, query: str) -> str:
-        """生成缓存键"""
-        return hashlib.md5(query.encode()).hexdigest()
+        """生成缓存键（规范化后哈希，纯格式差异共享条目）"""
+        return hashlib.md5(normalize_query(query).encode()).hexdigest()
 
     def clear_cache(self) -> None:
         """清空缓存"""
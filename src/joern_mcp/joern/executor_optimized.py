@@ -12,14 +12,24 @@ import time
 from loguru import logger
 
 from joern_mcp.config import settings
+from joern_mcp.joern.prepared import PreparedQueryRegistry
 from joern_mcp.joern.server import JoernServerManager
+from joern_mcp.utils.cache_backend import create_cache_backend
+from joern_mcp.utils.cache_key import get_cache_key_stats, normalize_query
+from joern_mcp.utils.cpg_generation import cache_key_salt
+from joern_mcp.utils.dot_transfer import dot_transfer_path
 from joern_mcp.utils.performance import (
-    AdaptiveSemaphore,
     HybridCache,
+    PriorityScheduler,
     QueryComplexityAnalyzer,
+    QueryCostModel,
     SlowQueryLogger,
+    extract_project_name,
     get_metrics,
+    trace_stage,
 )
+from joern_mcp.utils.projection import apply_projection
+from joern_mcp.utils.query_advisor import QueryAdvisor
 
 
 class QueryExecutionError(Exception):
@@ -40,7 +50,7 @@ class OptimizedQueryExecutor:
 
     特性：
     - 混合缓存（LRU + TTL）
-    - 自适应并发控制
+    - 优先级调度（高优先级查询插队）+ 自适应并发控制
     - 查询复杂度分析
     - 慢查询监控
     - 性能指标收集
@@ -49,27 +59,43 @@ class OptimizedQueryExecutor:
     def __init__(self, server_manager: JoernServerManager) -> None:
         self.server_manager = server_manager
 
+        # L2 共享缓存后端（可选）：
+        # 单机用 SQLite（重启后缓存不从零开始），
+        # 多实例部署配置 Redis 共享一份结果缓存
+        persistent = create_cache_backend()
+
         # 高级缓存
         self.cache = HybridCache(
             hot_size=100,
             cold_size=settings.query_cache_size,
             ttl=settings.query_cache_ttl,
             compress_threshold=10240,  # 10KB
+            persistent=persistent,
         )
 
-        # 自适应并发控制
-        self.semaphore = AdaptiveSemaphore(
+        # 优先级调度 + 自适应并发控制
+        self.scheduler = PriorityScheduler(
             min_concurrent=settings.max_concurrent_queries,
             max_concurrent=settings.max_concurrent_queries * 4,
             target_response_time=1.0,
         )
 
-        # 查询分析器
+        # 查询分析器（启发式，作为成本模型的先验保留）
         self.complexity_analyzer = QueryComplexityAnalyzer()
 
+        # 在线成本模型：用实测耗时修正启发式估计，
+        # 驱动超时放大、调度优先级和冷热缓存分层
+        self.cost_model = QueryCostModel()
+
         # 慢查询日志
         self.slow_query_logger = SlowQueryLogger(threshold=5.0)
 
+        # 预编译查询注册表（模板定义一次编译，后续按名调用）
+        self.prepared = PreparedQueryRegistry()
+
+        # 慢查询顾问（病态模式改写 + 优化提示）
+        self.advisor = QueryAdvisor()
+
         # 禁止的查询模式
         self.forbidden_patterns = [
             r"System\.exit",
@@ -89,7 +115,9 @@ class OptimizedQueryExecutor:
         format: str = "json",
         timeout: int | None = None,
         use_cache: bool = True,
-        priority: int | None = None,  # noqa: ARG002 - Reserved for future use
+        priority: int | None = None,
+        prepared: tuple | None = None,
+        fields: list[str] | None = None,
     ) -> dict:
         """
         执行查询
@@ -99,13 +127,29 @@ class OptimizedQueryExecutor:
             format: 输出格式 (json, dot等)
             timeout: 超时时间（秒）
             use_cache: 是否使用缓存
-            priority: 查询优先级（1-5，5最高）
+            priority: 查询优先级（1-5，5最高）；
+                      不指定时根据复杂度自动推导，
+                      低复杂度的交互式查询会插队到排队的重量级扫描之前
+            prepared: 预编译查询规格 (函数名, cpg前缀表达式, *参数)；
+                      指定时优先发送预编译函数调用（跳过模板的重复编译），
+                      安装失败则回退执行 query 本身
+            fields: 投影字段列表；指定时裸遍历在序列化前被改写为
+                    只输出这些字段（大幅缩小方法/调用列表类查询的载荷），
+                    已自带 .map 投影的查询不受影响
 
         Returns:
             查询结果字典
         """
         start_time = time.time()
         cached = False
+        # 指标的 by_project 维度（工具维度由 track_tool 上下文提供）
+        project = extract_project_name(query)
+
+        # 预编译路径：用短调用表达式替换完整插值查询
+        if prepared is not None:
+            prepared_query = await self._resolve_prepared(prepared)
+            if prepared_query is not None:
+                query = prepared_query
 
         try:
             # 1. 验证查询
@@ -114,26 +158,65 @@ class OptimizedQueryExecutor:
                 logger.warning(f"Query validation failed: {error_msg}")
                 raise QueryValidationError(error_msg)
 
-            # 2. 分析查询复杂度
-            complexity_info = self.complexity_analyzer.analyze(query)
-            logger.debug(f"Query complexity: {complexity_info['complexity']}/10")
+            # 1.5 查询顾问：安全改写病态模式，收集优化提示
+            advisor_hints: list = []
+            if settings.query_advisor_enabled:
+                advice = self.advisor.advise(query)
+                if advice["rewrites"]:
+                    logger.debug(
+                        f"Query rewritten by advisor: "
+                        f"{[r['type'] for r in advice['rewrites']]}"
+                    )
+                    query = advice["query"]
+                advisor_hints = advice["hints"]
+
+            # 2. 估计查询成本（样本足够时用实测耗时，否则启发式）
+            complexity_info = self.cost_model.analyze(query)
+            logger.debug(
+                f"Query complexity: {complexity_info['complexity']}/10 "
+                f"({complexity_info['source']})"
+            )
 
-            # 3. 确保查询返回正确格式
-            query = self._format_query(query, format)
+            # 3. 投影下推 + 确保查询返回正确格式
+            try:
+                query = self._format_query(query, format, fields)
+            except ValueError as e:
+                raise QueryValidationError(str(e)) from None
 
             # 4. 检查缓存
             cache_key = self._get_cache_key(query)
             if use_cache:
-                cached_result = self.cache.get(cache_key)
+                # aget 把持久层（SQLite/Redis）访问转到工作线程，
+                # 后端慢或不可用时不会阻塞事件循环上的其他查询
+                cached_result = await self.cache.aget(cache_key)
+                get_cache_key_stats().observe(
+                    query, normalize_query(query), hit=cached_result is not None
+                )
                 if cached_result is not None:
                     logger.debug("Cache hit")
                     cached = True
                     duration = time.time() - start_time
-                    self.metrics.record_query(duration, success=True, cached=True)
+                    self.metrics.record_query(
+                        duration, success=True, cached=True, project=project
+                    )
                     return cached_result
 
-            # 5. 执行查询（自适应并发控制）
-            async with self.semaphore:
+            # 4.5 DOT 结果走文件通道：|> 落盘后直接读文件，
+            # 避免多 MB 字符串经 REPL stdout 序列化/清洗
+            # （缓存键用落盘前的查询计算，结果读回后按原键缓存）
+            dot_file = None
+            if format == "dot":
+                dot_file = dot_transfer_path()
+                query = f'{query} |> "{dot_file}"'
+
+            # 5. 执行查询（优先级调度 + 自适应并发控制）
+            # 未指定优先级时使用复杂度分析推导的优先级
+            effective_priority = (
+                priority if priority is not None else complexity_info["priority"]
+            )
+            with trace_stage("scheduler_wait"):
+                await self.scheduler.acquire(effective_priority)
+            try:
                 self.metrics.current_concurrent += 1
                 self.metrics.max_concurrent = max(
                     self.metrics.max_concurrent, self.metrics.current_concurrent
@@ -147,12 +230,15 @@ class OptimizedQueryExecutor:
                         timeout_val = int(timeout_val * 1.5)
 
                     # 使用异步方法执行查询
-                    result = await asyncio.wait_for(
-                        self.server_manager.execute_query_async(query),
-                        timeout=timeout_val,
-                    )
+                    with trace_stage("server_execute"):
+                        result = await asyncio.wait_for(
+                            self.server_manager.execute_query_async(query),
+                            timeout=timeout_val,
+                        )
                 finally:
                     self.metrics.current_concurrent -= 1
+            finally:
+                self.scheduler.release()
 
             # 6. 处理结果
             if not result.get("success"):
@@ -160,18 +246,36 @@ class OptimizedQueryExecutor:
                 logger.error(f"Query failed: {stderr}")
                 raise QueryExecutionError(stderr) from None
 
+            # 6.2 文件通道的 DOT 结果读回 stdout（保持执行器返回契约不变）
+            if dot_file is not None:
+                try:
+                    result["stdout"] = dot_file.read_text(encoding="utf-8")
+                    result["via_dot_file"] = True
+                except OSError as e:
+                    # 落盘失败（旧版本 |> 行为差异等）：保留原始 stdout
+                    logger.warning(f"DOT transfer file unreadable: {e}")
+                finally:
+                    dot_file.unlink(missing_ok=True)
+
+            # 6.5 附加无法自动改写的优化提示（随结果返回，供调用方修正后续查询）
+            if advisor_hints:
+                result["advisor_hints"] = advisor_hints
+
             # 7. 缓存结果
             if use_cache:
                 # 简单查询放入热缓存，复杂查询放入冷缓存
                 hot = complexity_info["complexity"] <= 3
-                self.cache.set(cache_key, result, hot=hot)
+                await self.cache.aset(cache_key, result, hot=hot)
 
-            # 8. 性能记录
+            # 8. 性能记录 + 喂给成本模型（同型查询的后续估计用实测修正）
             duration = time.time() - start_time
-            self.metrics.record_query(duration, success=True, cached=False)
+            self.metrics.record_query(
+                duration, success=True, cached=False, project=project
+            )
+            self.cost_model.observe(complexity_info["signature"], duration)
 
             # 9. 调整并发限制
-            await self.semaphore.adjust(duration)
+            await self.scheduler.adjust(duration)
 
             # 10. 慢查询日志
             self.slow_query_logger.log(
@@ -183,23 +287,63 @@ class OptimizedQueryExecutor:
 
         except QueryValidationError:
             duration = time.time() - start_time
-            self.metrics.record_query(duration, success=False, cached=False)
+            self.metrics.record_query(
+                duration, success=False, cached=False, project=project
+            )
             raise
         except QueryExecutionError:
             duration = time.time() - start_time
-            self.metrics.record_query(duration, success=False, cached=False)
+            self.metrics.record_query(
+                duration, success=False, cached=False, project=project
+            )
             raise
         except asyncio.TimeoutError:
             duration = time.time() - start_time
-            self.metrics.record_query(duration, success=False, cached=False)
+            self.metrics.record_query(
+                duration, success=False, cached=False, project=project
+            )
             logger.error(f"Query timeout after {timeout or settings.query_timeout}s")
             raise QueryExecutionError("Query timeout") from None
         except Exception as e:
             duration = time.time() - start_time
-            self.metrics.record_query(duration, success=False, cached=False)
+            self.metrics.record_query(
+                duration, success=False, cached=False, project=project
+            )
             logger.exception(f"Query execution failed: {e}")
             raise QueryExecutionError(str(e)) from None
 
+    async def _resolve_prepared(self, prepared: tuple) -> str | None:
+        """解析预编译查询规格为调用表达式
+
+        首次使用时把全部函数定义注入 Joern 会话（一次编译）。
+        注入失败（或本次会话已标记失败）返回 None，
+        调用方回退到原始内联查询。
+        """
+        if not self.prepared.available:
+            return None
+
+        if not self.prepared.installed:
+            try:
+                result = await self.server_manager.execute_query_async(
+                    self.prepared.definitions_script()
+                )
+                if result.get("success"):
+                    self.prepared.mark_installed()
+                else:
+                    logger.warning(
+                        f"Prepared query install rejected: "
+                        f"{result.get('stderr', 'Unknown error')}"
+                    )
+                    self.prepared.mark_failed()
+                    return None
+            except Exception as e:
+                logger.warning(f"Prepared query install error: {e}")
+                self.prepared.mark_failed()
+                return None
+
+        name, cpg_expr, *args = prepared
+        return self.prepared.invocation(name, cpg_expr, *args)
+
     def _validate_query(self, query: str) -> tuple[bool, str]:
         """验证查询安全性"""
         # 检查长度
@@ -219,11 +363,19 @@ class OptimizedQueryExecutor:
 
         return True, ""
 
-    def _format_query(self, query: str, format: str) -> str:
-        """格式化查询以返回指定格式"""
+    def _format_query(
+        self, query: str, format: str, fields: list[str] | None = None
+    ) -> str:
+        """格式化查询以返回指定格式
+
+        json 格式下若指定投影字段，先把投影下推到遍历末尾
+        再追加 .toJson，JVM 只序列化声明过的字段。
+        """
         query = query.strip()
 
         if format == "json":
+            if fields:
+                query = apply_projection(query, fields)
             if not query.endswith(".toJson"):
                 if "\n" in query or query.count(";") > 0:
                     query = f"({query}).toJson"
@@ -235,8 +387,17 @@ class OptimizedQueryExecutor:
         return query
 
     def _get_cache_key(self, query: str) -> str:
-        """生成缓存键"""
-        return hashlib.md5(query.encode()).hexdigest()
+        """生成缓存键
+
+        查询先做语义保持的规范化（见 utils/cache_key.py），
+        模板缩进、多余空白、Map 投影键顺序等纯格式差异
+        不再各占一个键。键中另编入查询涉及项目的 CPG 代数
+        （generation），parse_project 重新导入后代数递增，
+        旧缓存条目自然失效。持久化缓存依赖这一点保证
+        跨重启的正确性。
+        """
+        salt = cache_key_salt(query)
+        return hashlib.md5(f"{salt}|{normalize_query(query)}".encode()).hexdigest()
 
     def clear_cache(self) -> None:
         """清空缓存"""
@@ -245,7 +406,11 @@ class OptimizedQueryExecutor:
 
     def get_cache_stats(self) -> dict:
         """获取缓存统计"""
-        return self.cache.get_stats()
+        stats = self.cache.get_stats()
+        # 键规范化统计：rescued_hits 即"纯格式差异本会未命中、
+        # 规范化后救回"的近似计数
+        stats["key_normalization"] = get_cache_key_stats().get_stats()
+        return stats
 
     def get_performance_stats(self) -> dict:
         """获取性能统计"""
@@ -257,7 +422,15 @@ class OptimizedQueryExecutor:
 
     def get_current_concurrent_limit(self) -> int:
         """获取当前并发限制"""
-        return self.semaphore.get_current_limit()
+        return self.scheduler.get_current_limit()
+
+    def get_scheduler_stats(self) -> dict:
+        """获取调度器状态（并发限制、在途查询、队列深度）"""
+        return self.scheduler.get_stats()
+
+    def get_cost_model_stats(self) -> dict:
+        """获取成本模型状态（学习到的桶数与最贵查询形态）"""
+        return self.cost_model.get_stats()
 
 
 # 兼容性：保留原有的QueryExecutor类名
@@ -11,17 +11,28 @@ Joern Server工作模式（参考cpgqls-client实现）：
 1. Event loop冲突（run_until_complete）
 2. 控制台输出解析（ANSI颜色码）
 3. 同步阻塞调用
+
+HTTP 传输使用 httpx.AsyncClient 连接池（keep-alive + 连接复用），
+所有 HTTP 往返都是真正的异步操作，不会阻塞 event loop，
+并发查询可以真正并行执行。
+
+WebSocket 使用共享连接 + 分发器模式：
+每个客户端只维护一条持久 WebSocket 连接，由后台分发器任务
+将收到的 UUID 完成通知路由到对应查询的 Future。
+避免每次查询重新建立连接（每次数十毫秒），
+也消除了多查询并发时互相"吃掉"对方完成通知的竞争问题。
 """
 
 import asyncio
 import re
-import time
 from typing import Any
 
-import requests  # 使用同步requests，与cpgqls-client一致
+import httpx
 import websockets
 from loguru import logger
 
+from joern_mcp.utils.performance import trace_stage
+
 # ANSI 颜色控制码正则表达式
 _ANSI_ESCAPE_PATTERN = re.compile(r"\x1B(?:[@-Z\\-_]|\[[0-?]*[ -/]*[@-~])")
 
@@ -39,19 +50,6 @@ def strip_ansi_codes(text: str) -> str:
     return _ANSI_ESCAPE_PATTERN.sub("", text)
 
 
-# 全局信号量：限制并发WebSocket连接数，避免资源竞争
-_connection_semaphore: asyncio.Semaphore | None = None
-_MAX_CONCURRENT_CONNECTIONS = 5  # 最大并发连接数（支持4-5个并发查询）
-
-
-def _get_semaphore() -> asyncio.Semaphore:
-    """获取或创建连接信号量（延迟初始化，避免事件循环问题）"""
-    global _connection_semaphore
-    if _connection_semaphore is None:
-        _connection_semaphore = asyncio.Semaphore(_MAX_CONCURRENT_CONNECTIONS)
-    return _connection_semaphore
-
-
 class JoernHTTPClient:
     """通过HTTP+WebSocket与Joern Server交互的客户端"""
 
@@ -75,8 +73,37 @@ class JoernHTTPClient:
         self.auth = auth
         self.timeout = timeout
 
+        # 连接池化的异步HTTP客户端（延迟初始化，避免事件循环问题）
+        self._http_client: httpx.AsyncClient | None = None
+
+        # 共享WebSocket连接 + 分发器状态
+        self._ws_conn: websockets.WebSocketClientProtocol | None = None
+        self._ws_lock = asyncio.Lock()
+        self._dispatcher_task: asyncio.Task | None = None
+        # 等待完成通知的查询: uuid -> Future
+        self._pending: dict[str, asyncio.Future] = {}
+        # 在Future注册之前就到达的完成通知（POST返回UUID与注册之间的窗口）
+        self._unclaimed: set[str] = set()
+
         logger.info(f"Joern HTTP client initialized for http://{endpoint}")
 
+    def _get_http_client(self) -> httpx.AsyncClient:
+        """获取或创建池化的异步HTTP客户端
+
+        使用 keep-alive 连接池复用TCP连接，
+        避免每次查询重新建立连接的开销。
+        """
+        if self._http_client is None or self._http_client.is_closed:
+            self._http_client = httpx.AsyncClient(
+                auth=self.auth,
+                timeout=httpx.Timeout(self.timeout),
+                limits=httpx.Limits(
+                    max_connections=20,
+                    max_keepalive_connections=10,
+                ),
+            )
+        return self._http_client
+
     def _connect_endpoint(self) -> str:
         """WebSocket连接端点"""
         return f"ws://{self.endpoint}/connect"
@@ -113,24 +140,20 @@ class JoernHTTPClient:
         Raises:
             Exception: 连接或查询失败
         """
-        # 使用信号量限制并发连接数，避免资源竞争
-        semaphore = _get_semaphore()
-
-        async with semaphore:
-            if use_sync_endpoint:
-                return await self._execute_sync(query)
+        if use_sync_endpoint:
+            return await self._execute_sync(query)
 
-            # 尝试 WebSocket 异步模式，失败时自动回退到同步模式
-            result = await self._execute_internal(query)
+        # 尝试 WebSocket 异步模式，失败时自动回退到同步模式
+        result = await self._execute_internal(query)
 
-            # 如果 WebSocket 连接失败（404），尝试同步模式
-            if not result.get("success") and "HTTP 404" in result.get("stderr", ""):
-                logger.warning(
-                    "WebSocket endpoint not available, falling back to sync endpoint"
-                )
-                return await self._execute_sync(query)
+        # 如果 WebSocket 连接失败（404），尝试同步模式
+        if not result.get("success") and "HTTP 404" in result.get("stderr", ""):
+            logger.warning(
+                "WebSocket endpoint not available, falling back to sync endpoint"
+            )
+            return await self._execute_sync(query)
 
-            return result
+        return result
 
     async def _execute_sync(self, query: str) -> dict[str, Any]:
         """使用同步端点执行查询（/query-sync）
@@ -143,12 +166,10 @@ class JoernHTTPClient:
             sync_endpoint = self._post_query_sync_endpoint()
             logger.debug(f"POST同步查询到: {sync_endpoint}")
 
-            response = requests.post(
-                sync_endpoint,
-                json={"query": query},
-                auth=self.auth,
-                timeout=self.timeout,
-            )
+            with trace_stage("query_post_sync"):
+                response = await self._get_http_client().post(
+                    sync_endpoint, json={"query": query}
+                )
             logger.debug(f"同步查询响应状态: {response.status_code}")
 
             if response.status_code == 401:
@@ -189,126 +210,158 @@ class JoernHTTPClient:
                 "stderr": f"Execution Error: {e}",
             }
 
-    async def _execute_internal(self, query: str) -> dict[str, Any]:
-        """内部执行方法（在信号量保护下调用）"""
-        try:
-            # 1. 建立WebSocket连接
+    async def _ensure_dispatcher(self) -> None:
+        """确保共享WebSocket连接和分发器任务存在
+
+        每个客户端只维护一条持久连接，连接断开后
+        下一次查询会自动重建连接并重启分发器。
+        """
+        async with self._ws_lock:
+            if (
+                self._ws_conn is not None
+                and self._dispatcher_task is not None
+                and not self._dispatcher_task.done()
+            ):
+                return
+
             connect_endpoint = self._connect_endpoint()
-            logger.debug(f"连接WebSocket: {connect_endpoint}")
-
-            async with websockets.connect(
-                connect_endpoint, ping_interval=None
-            ) as ws_conn:
-                logger.debug("WebSocket连接成功，等待确认消息...")
-                # 等待连接确认消息
-                connected_msg = await ws_conn.recv()
-                logger.debug(f"收到消息: {connected_msg}")
-
-                if connected_msg != self.CPGQLS_MSG_CONNECTED:
-                    raise Exception(
-                        f"Unexpected first message on websocket: {connected_msg}"
-                    )
-                logger.debug("WebSocket连接已确认")
+            logger.debug(f"建立共享WebSocket连接: {connect_endpoint}")
 
-                # 2. POST查询（使用同步requests，与cpgqls-client一致）
-                post_endpoint = self._post_query_endpoint()
-                logger.debug(f"POST查询到: {post_endpoint}")
+            ws_conn = await websockets.connect(connect_endpoint, ping_interval=None)
 
-                post_res = requests.post(
-                    post_endpoint,
-                    json={"query": query},
-                    auth=self.auth,
-                    timeout=self.timeout,
+            # 等待连接确认消息
+            connected_msg = await ws_conn.recv()
+            if connected_msg != self.CPGQLS_MSG_CONNECTED:
+                await ws_conn.close()
+                raise Exception(
+                    f"Unexpected first message on websocket: {connected_msg}"
                 )
-                logger.debug(f"POST响应状态: {post_res.status_code}")
-
-                # 检查认证
-                if post_res.status_code == 401:
-                    raise Exception("Basic authentication failed")
-                elif post_res.status_code != 200:
-                    raise Exception(
-                        f"Could not post query: HTTP {post_res.status_code}, body: {post_res.text}"
+
+            self._ws_conn = ws_conn
+            self._dispatcher_task = asyncio.create_task(self._dispatch_loop(ws_conn))
+            logger.debug("共享WebSocket连接已确认，分发器已启动")
+
+    async def _dispatch_loop(self, ws_conn) -> None:
+        """分发器循环：将UUID完成通知路由到等待的Future
+
+        不属于任何等待者的通知暂存到 _unclaimed，
+        覆盖"POST返回UUID之前完成通知已到达"的窗口。
+        """
+        try:
+            async for message in ws_conn:
+                uuid = message
+                future = self._pending.get(uuid)
+                if future is not None and not future.done():
+                    logger.debug(f"分发完成通知: {uuid}")
+                    future.set_result(True)
+                else:
+                    self._unclaimed.add(uuid)
+        except Exception as e:
+            logger.debug(f"WebSocket dispatcher stopped: {e}")
+        finally:
+            # 连接断开：唤醒所有等待者，让调用方报错或重试
+            for future in self._pending.values():
+                if not future.done():
+                    future.set_exception(
+                        ConnectionError("WebSocket connection closed")
                     )
+            if self._ws_conn is ws_conn:
+                self._ws_conn = None
+
+    async def _wait_for_completion(self, query_uuid: str) -> None:
+        """等待指定查询的完成通知（由分发器路由）"""
+        # 完成通知可能先于Future注册到达（暂存于 _unclaimed）
+        if query_uuid in self._unclaimed:
+            self._unclaimed.discard(query_uuid)
+            return
+
+        future: asyncio.Future = asyncio.get_event_loop().create_future()
+        self._pending[query_uuid] = future
+        try:
+            await asyncio.wait_for(future, timeout=self.timeout)
+        finally:
+            self._pending.pop(query_uuid, None)
+
+    async def _execute_internal(self, query: str) -> dict[str, Any]:
+        """内部执行方法（共享WebSocket + 查询多路复用）"""
+        try:
+            # 1. 确保共享WebSocket连接与分发器就绪
+            with trace_stage("ws_connect"):
+                await self._ensure_dispatcher()
 
-                # 获取查询UUID
-                query_uuid = post_res.json()["uuid"]
-                logger.debug(f"查询已提交，UUID: {query_uuid}")
+            # 2. POST查询（异步，走连接池）
+            post_endpoint = self._post_query_endpoint()
+            logger.debug(f"POST查询到: {post_endpoint}")
 
-                # 3. 等待WebSocket完成通知（必须等到我们提交的查询完成）
-                logger.debug(
-                    f"等待查询 {query_uuid} 的完成通知（超时: {self.timeout}s）..."
+            with trace_stage("query_post"):
+                post_res = await self._get_http_client().post(
+                    post_endpoint, json={"query": query}
                 )
+            logger.debug(f"POST响应状态: {post_res.status_code}")
 
-                # 循环等待，直到收到我们查询的UUID
-                start_time = time.time()
-                while True:
-                    remaining_timeout = self.timeout - (time.time() - start_time)
-                    if remaining_timeout <= 0:
-                        raise asyncio.TimeoutError(f"等待查询 {query_uuid} 完成超时")
+            # 检查认证
+            if post_res.status_code == 401:
+                raise Exception("Basic authentication failed")
+            elif post_res.status_code != 200:
+                raise Exception(
+                    f"Could not post query: HTTP {post_res.status_code}, body: {post_res.text}"
+                )
 
-                    completion_msg = await asyncio.wait_for(
-                        ws_conn.recv(), timeout=remaining_timeout
-                    )
-                    logger.debug(f"收到完成通知: {completion_msg}")
-
-                    # 检查是否是我们的查询完成
-                    if completion_msg == query_uuid:
-                        logger.debug(f"查询 {query_uuid} 已完成")
-                        break
-                    else:
-                        # 收到其他查询的通知，继续等待
-                        logger.debug(
-                            f"收到其他查询的通知 {completion_msg}，继续等待 {query_uuid}"
-                        )
-
-                # 4. GET查询结果（同步requests）
-                result_endpoint = self._get_result_endpoint(query_uuid)
-                logger.debug(f"GET结果从: {result_endpoint}")
-
-                get_res = requests.get(
-                    result_endpoint,
-                    auth=self.auth,
-                    timeout=self.timeout,
+            # 获取查询UUID
+            query_uuid = post_res.json()["uuid"]
+            logger.debug(f"查询已提交，UUID: {query_uuid}")
+
+            # 3. 等待分发器路由的完成通知（Joern 侧真实执行时间）
+            logger.debug(f"等待查询 {query_uuid} 的完成通知（超时: {self.timeout}s）...")
+            with trace_stage("joern_execute"):
+                await self._wait_for_completion(query_uuid)
+            logger.debug(f"查询 {query_uuid} 已完成")
+
+            # 4. GET查询结果（异步，复用同一个连接池）
+            result_endpoint = self._get_result_endpoint(query_uuid)
+            logger.debug(f"GET结果从: {result_endpoint}")
+
+            with trace_stage("result_get"):
+                get_res = await self._get_http_client().get(result_endpoint)
+            logger.debug(f"GET响应状态: {get_res.status_code}")
+
+            # 检查结果获取
+            if get_res.status_code == 401:
+                raise Exception("Basic authentication failed")
+            elif get_res.status_code != 200:
+                raise Exception(
+                    f"Could not retrieve result: HTTP {get_res.status_code}, body: {get_res.text}"
                 )
-                logger.debug(f"GET响应状态: {get_res.status_code}")
-
-                # 检查结果获取
-                if get_res.status_code == 401:
-                    raise Exception("Basic authentication failed")
-                elif get_res.status_code != 200:
-                    raise Exception(
-                        f"Could not retrieve result: HTTP {get_res.status_code}, body: {get_res.text}"
-                    )
 
-                # 获取Joern Server的原始响应
-                raw_result = get_res.json()
-                logger.debug(f"查询成功完成: {query[:50]}...")
-
-                # 检查Joern Server的错误响应
-                if "err" in raw_result:
-                    # Joern Server返回错误
-                    error_msg = raw_result["err"]
-                    logger.error(f"Joern Server error: {error_msg}")
-                    return {
-                        "success": False,
-                        "stdout": "",
-                        "stderr": f"Joern Error: {error_msg}",
-                    }
-
-                # Joern Server返回格式: {"success": true, "uuid": "...", "stdout": "..."}
-                # stdout 包含 Scala REPL 风格输出，可能有 ANSI 颜色码
-                # 统一在此处清理，下游代码无需重复处理
-                stdout_content = raw_result.get("stdout", "")
-
-                # 移除 ANSI 颜色控制码
-                clean_stdout = strip_ansi_codes(stdout_content)
+            # 获取Joern Server的原始响应
+            raw_result = get_res.json()
+            logger.debug(f"查询成功完成: {query[:50]}...")
 
+            # 检查Joern Server的错误响应
+            if "err" in raw_result:
+                # Joern Server返回错误
+                error_msg = raw_result["err"]
+                logger.error(f"Joern Server error: {error_msg}")
                 return {
-                    "success": True,
-                    "stdout": clean_stdout,
-                    "stderr": "",
+                    "success": False,
+                    "stdout": "",
+                    "stderr": f"Joern Error: {error_msg}",
                 }
 
+            # Joern Server返回格式: {"success": true, "uuid": "...", "stdout": "..."}
+            # stdout 包含 Scala REPL 风格输出，可能有 ANSI 颜色码
+            # 统一在此处清理，下游代码无需重复处理
+            stdout_content = raw_result.get("stdout", "")
+
+            # 移除 ANSI 颜色控制码
+            clean_stdout = strip_ansi_codes(stdout_content)
+
+            return {
+                "success": True,
+                "stdout": clean_stdout,
+                "stderr": "",
+            }
+
         except Exception as e:
             logger.error(f"Query execution failed: {e}")
             # 返回错误格式与cpgqls-client一致
@@ -346,7 +399,19 @@ class JoernHTTPClient:
         return await self.execute("workspace")
 
     async def close(self) -> None:
-        """关闭客户端（HTTP客户端无需显式关闭）"""
+        """关闭客户端，释放连接池和WebSocket资源"""
+        if self._dispatcher_task is not None:
+            self._dispatcher_task.cancel()
+            self._dispatcher_task = None
+        if self._ws_conn is not None:
+            try:
+                await self._ws_conn.close()
+            except Exception:  # noqa: S110
+                pass
+            self._ws_conn = None
+        if self._http_client is not None and not self._http_client.is_closed:
+            await self._http_client.aclose()
+            self._http_client = None
         logger.debug("HTTP client closed")
 
     def __repr__(self) -> str:
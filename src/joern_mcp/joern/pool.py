@@ -0,0 +1,257 @@
+"""Joern Server 进程池
+
+单个 Joern JVM 的 REPL 一次只能执行一个查询，
+一条耗时的污点查询会让其他所有查询排队等待。
+进程池模式启动 N 个 Joern 进程（N 由 joern_server_pool_size 配置），
+把同一个 workspace 导入到每个进程，
+查询按"最少未完成工作"策略路由到空闲的进程。
+
+对外接口与 JoernServerManager 保持一致
+（start/stop/restart/health_check/execute_query_async/import_code），
+QueryExecutor 无需感知自己面对的是单进程还是进程池。
+"""
+
+import asyncio
+
+from loguru import logger
+
+from joern_mcp.config import settings
+from joern_mcp.joern.server import JoernServerError, JoernServerManager
+
+
+class JoernServerPool:
+    """Joern Server 进程池
+
+    - 启动 N 个 Joern 进程（端口自动分配）
+    - execute_query_async 按最少未完成工作路由
+    - import_code 广播到所有进程，保证 workspace 一致
+    """
+
+    def __init__(self, pool_size: int | None = None) -> None:
+        self.pool_size = pool_size or settings.joern_server_pool_size
+        if self.pool_size < 1:
+            raise ValueError("Pool size must be >= 1")
+
+        # 每个成员一个独立的 JoernServerManager（端口冲突时自动选择新端口）
+        self.members: list[JoernServerManager] = [
+            JoernServerManager() for _ in range(self.pool_size)
+        ]
+        # 每个成员的未完成查询数，用于负载均衡
+        self._outstanding: list[int] = [0] * self.pool_size
+
+        # 后台启动状态（语义同 JoernServerManager）
+        self._ready = asyncio.Event()
+        self._boot_task: asyncio.Task | None = None
+        self._boot_error: str | None = None
+        self.is_warm = False
+
+    @property
+    def endpoint(self) -> str:
+        """主端点（第一个成员，用于日志和诊断）"""
+        return self.members[0].endpoint
+
+    @property
+    def endpoints(self) -> list[str]:
+        """所有成员端点"""
+        return [m.endpoint for m in self.members]
+
+    async def start(self, **kwargs) -> None:
+        """启动池中所有 Joern 进程
+
+        各进程并发启动；任何一个启动失败则停止已启动的进程并报错。
+        """
+        logger.info(f"Starting Joern server pool (size: {self.pool_size})")
+
+        results = await asyncio.gather(
+            *(m.start(**kwargs) for m in self.members), return_exceptions=True
+        )
+
+        failures = [r for r in results if isinstance(r, Exception)]
+        if failures:
+            logger.error(f"Failed to start {len(failures)} pool member(s)")
+            await self.stop()
+            raise JoernServerError(
+                f"Failed to start server pool: {failures[0]}"
+            ) from None
+
+        logger.info(f"Joern server pool ready: {', '.join(self.endpoints)}")
+        self._ready.set()
+
+    def start_background(self, **kwargs) -> asyncio.Task:
+        """后台启动整个进程池（立即返回，就绪前的查询排队等待）"""
+        if self._boot_task and not self._boot_task.done():
+            logger.warning("Pool background boot already in progress")
+            return self._boot_task
+
+        self._boot_error = None
+        self._boot_task = asyncio.create_task(self._boot(**kwargs))
+        return self._boot_task
+
+    async def _boot(self, **kwargs) -> None:
+        """后台启动流程：启动所有成员 + 并发预热"""
+        try:
+            await self.start(**kwargs)
+            if settings.joern_warmup_enabled:
+                await asyncio.gather(
+                    *(m.warm_up() for m in self.members), return_exceptions=True
+                )
+            self.is_warm = True
+        except Exception as e:
+            logger.error(f"Pool background boot failed: {e}")
+            self._boot_error = str(e)
+            self._ready.set()
+
+    async def _wait_boot(self) -> None:
+        """等待后台启动完成（语义同 JoernServerManager._wait_boot）"""
+        if self._boot_task is None:
+            raise JoernServerError("Server pool not started") from None
+
+        logger.debug("Query arrived before pool boot completed, waiting...")
+        try:
+            await asyncio.wait_for(
+                self._ready.wait(), timeout=settings.joern_boot_wait_timeout
+            )
+        except asyncio.TimeoutError:
+            raise JoernServerError(
+                f"Pool boot did not complete within "
+                f"{settings.joern_boot_wait_timeout}s"
+            ) from None
+
+        if self._boot_error:
+            raise JoernServerError(
+                f"Pool boot failed: {self._boot_error}"
+            ) from None
+
+    async def stop(self) -> None:
+        """停止池中所有进程"""
+        logger.info("Stopping Joern server pool")
+        if self._boot_task and self._boot_task is not asyncio.current_task():
+            if not self._boot_task.done():
+                self._boot_task.cancel()
+            self._boot_task = None
+        self._ready.clear()
+        self.is_warm = False
+        await asyncio.gather(
+            *(m.stop() for m in self.members), return_exceptions=True
+        )
+
+    async def restart(self) -> None:
+        """重启整个进程池"""
+        logger.info("Restarting Joern server pool")
+        await self.stop()
+        await self.start()
+
+    def is_running(self) -> bool:
+        """至少有一个成员在运行即认为池可用"""
+        return any(m.is_running() for m in self.members)
+
+    async def health_check(self) -> bool:
+        """健康检查：所有运行中的成员都健康才算健康"""
+        checks = await asyncio.gather(
+            *(m.health_check() for m in self.members), return_exceptions=True
+        )
+        healthy = [c for c in checks if c is True]
+        if len(healthy) < len(self.members):
+            logger.warning(
+                f"Pool health: {len(healthy)}/{len(self.members)} members healthy"
+            )
+        return len(healthy) == len(self.members)
+
+    def _pick_member(self) -> int:
+        """选择未完成工作最少的成员（只考虑运行中的成员）"""
+        best_index = -1
+        best_load = None
+        for i, member in enumerate(self.members):
+            if not member.is_running():
+                continue
+            if best_load is None or self._outstanding[i] < best_load:
+                best_index = i
+                best_load = self._outstanding[i]
+
+        if best_index < 0:
+            raise JoernServerError("No running server in pool") from None
+        return best_index
+
+    async def execute_query_async(self, query: str) -> dict:
+        """执行查询（路由到负载最低的进程）"""
+        if not self._ready.is_set() and self._boot_task is not None:
+            # 后台启动尚未完成时排队等待，而不是直接失败
+            await self._wait_boot()
+        index = self._pick_member()
+        self._outstanding[index] += 1
+        logger.debug(
+            f"Routing query to pool member {index} "
+            f"(outstanding: {self._outstanding[index]})"
+        )
+        try:
+            return await self.members[index].execute_query_async(query)
+        finally:
+            self._outstanding[index] -= 1
+
+    async def import_code(self, source_path: str, project_name: str) -> dict:
+        """导入代码到所有池成员
+
+        每个进程都需要看到同样的 workspace，
+        否则路由到未导入项目的进程会查询失败。
+        返回第一个成员的结果（失败的成员记录警告）。
+        """
+        logger.info(
+            f"Importing {project_name} into {len(self.members)} pool member(s)"
+        )
+
+        results = await asyncio.gather(
+            *(m.import_code(source_path, project_name) for m in self.members),
+            return_exceptions=True,
+        )
+
+        first_result: dict = {"success": False, "stdout": "", "stderr": "No members"}
+        for i, result in enumerate(results):
+            if isinstance(result, Exception):
+                logger.warning(f"Import failed on pool member {i}: {result}")
+                continue
+            if i == 0:
+                first_result = result
+            if not result.get("success"):
+                logger.warning(
+                    f"Import failed on pool member {i}: {result.get('stderr')}"
+                )
+
+        return first_result
+
+    async def import_cpg(self, cpg_path: str, project_name: str) -> dict:
+        """加载预构建 CPG 到所有池成员（语义同 import_code 广播）"""
+        logger.info(
+            f"Importing prebuilt CPG {project_name} into "
+            f"{len(self.members)} pool member(s)"
+        )
+
+        results = await asyncio.gather(
+            *(m.import_cpg(cpg_path, project_name) for m in self.members),
+            return_exceptions=True,
+        )
+
+        first_result: dict = {"success": False, "stdout": "", "stderr": "No members"}
+        for i, result in enumerate(results):
+            if isinstance(result, Exception):
+                logger.warning(f"CPG import failed on pool member {i}: {result}")
+                continue
+            if i == 0:
+                first_result = result
+            if not result.get("success"):
+                logger.warning(
+                    f"CPG import failed on pool member {i}: {result.get('stderr')}"
+                )
+
+        return first_result
+
+    def get_pool_stats(self) -> dict:
+        """获取池状态（用于诊断和性能监控）"""
+        return {
+            "pool_size": self.pool_size,
+            "running": sum(1 for m in self.members if m.is_running()),
+            "endpoints": self.endpoints,
+            "outstanding": list(self._outstanding),
+        }
+
+    def __repr__(self) -> str:
+        return f"JoernServerPool(size={self.pool_size})"
@@ -0,0 +1,182 @@
+"""预编译查询注册表
+
+Joern REPL 对每条查询都要做一次 Scala 编译，模板驱动的查询
+（callers/callees/数据流追踪等）每次插值出的字符串都不同，
+编译成本（数百毫秒）无法摊销。
+
+本模块把这些模板定义成命名的 Scala 函数，会话启动后一次性
+注入 Joern Server（只编译一次），后续调用只需发送
+``mcpGetCallers(cpg, "main")`` 这样的短调用表达式，REPL 仅编译
+这一行简单调用，模板本体不再重复编译。
+
+所有函数的第一个参数是 Cpg 对象，由调用方传入 CPG 前缀表达式
+（``cpg`` 或 ``workspace.project("x").get.cpg.get``），
+与 get_safe_cpg_prefix 的多项目机制兼容。
+"""
+
+from loguru import logger
+
+# Cpg 类型使用全限定名，避免依赖 REPL predef 的导入集合
+_CPG_TYPE = "io.shiftleft.codepropertygraph.generated.Cpg"
+
+# 预编译函数定义：名称 -> Scala def 源码
+# 函数体与 services 中对应的内联查询保持一致，
+# 修改内联查询时需同步修改这里
+DEFINITIONS: dict[str, str] = {
+    "mcpGetCallers": f"""
+def mcpGetCallers(g: {_CPG_TYPE}, name: String) =
+  g.method.name(name)
+   .callIn
+   .map(c => Map(
+       "name" -> c.method.name,
+       "methodFullName" -> c.method.fullName,
+       "signature" -> c.method.signature,
+       "filename" -> c.file.name.headOption.getOrElse("<unknown>"),
+       "lineNumber" -> c.lineNumber.getOrElse(-1),
+       "code" -> c.code
+   ))
+   .dedup
+""",
+    "mcpGetCallees": f"""
+def mcpGetCallees(g: {_CPG_TYPE}, name: String) =
+  g.method.name(name)
+   .call
+   .filterNot(_.name.startsWith("<operator>"))
+   .map(c => Map(
+       "name" -> c.name,
+       "methodFullName" -> c.methodFullName,
+       "signature" -> c.signature,
+       "filename" -> c.file.name.headOption.getOrElse("<unknown>"),
+       "lineNumber" -> c.lineNumber.getOrElse(-1),
+       "code" -> c.code
+   ))
+   .dedup
+""",
+    "mcpTrackDataflow": f"""
+def mcpTrackDataflow(g: {_CPG_TYPE}, sourceName: String, sinkName: String, maxFlows: Int) = {{
+  val source = g.method.name(sourceName).parameter
+  val sink = g.call.name(sinkName).argument
+  sink.reachableByFlows(source).take(maxFlows).map {{ path =>
+    val sourceNode = path.elements.head
+    val sinkNode = path.elements.last
+    Map(
+      "source" -> Map(
+          "code" -> sourceNode.code,
+          "file" -> sourceNode.file.name.headOption.getOrElse("unknown"),
+          "line" -> sourceNode.lineNumber.getOrElse(-1)
+      ),
+      "sink" -> Map(
+          "code" -> sinkNode.code,
+          "file" -> sinkNode.file.name.headOption.getOrElse("unknown"),
+          "line" -> sinkNode.lineNumber.getOrElse(-1)
+      ),
+      "pathLength" -> path.elements.size,
+      "path" -> path.elements.take(20).map(e => Map(
+          "type" -> e.label,
+          "code" -> e.code,
+          "line" -> e.lineNumber.getOrElse(-1)
+      ))
+    )
+  }}
+}}
+""",
+    "mcpVariableFlow": f"""
+def mcpVariableFlow(g: {_CPG_TYPE}, varName: String, sinkName: String, maxFlows: Int) = {{
+  val source = g.identifier.name(varName)
+  val sink = g.call.name(sinkName).argument
+  sink.reachableByFlows(source).take(maxFlows).map {{ path =>
+    Map(
+      "variable" -> varName,
+      "source" -> Map(
+          "code" -> path.elements.head.code,
+          "file" -> path.elements.head.file.name.headOption.getOrElse("unknown"),
+          "line" -> path.elements.head.lineNumber.getOrElse(-1)
+      ),
+      "sink" -> Map(
+          "code" -> path.elements.last.code,
+          "method" -> sinkName,
+          "file" -> path.elements.last.file.name.headOption.getOrElse("unknown"),
+          "line" -> path.elements.last.lineNumber.getOrElse(-1)
+      ),
+      "pathLength" -> path.elements.size
+    )
+  }}
+}}
+""",
+}
+
+
+def _render_argument(value) -> str:
+    """将 Python 值渲染为 Scala 字面量"""
+    if isinstance(value, bool):
+        return "true" if value else "false"
+    if isinstance(value, (int, float)):
+        return str(value)
+    if isinstance(value, str):
+        escaped = value.replace("\\", "\\\\").replace('"', '\\"')
+        return f'"{escaped}"'
+    raise TypeError(f"Unsupported prepared query argument type: {type(value)}")
+
+
+class PreparedQueryRegistry:
+    """预编译查询注册表
+
+    跟踪命名 Scala 函数在当前 Joern 会话中的安装状态，
+    并生成对应的调用表达式。
+
+    安装失败时（旧版本 Joern 语法不兼容等）标记为不可用，
+    调用方回退到原有的内联插值查询，功能不受影响。
+    """
+
+    def __init__(self) -> None:
+        self._installed = False
+        self._failed = False
+
+    @property
+    def installed(self) -> bool:
+        """函数定义是否已注入当前会话"""
+        return self._installed
+
+    @property
+    def available(self) -> bool:
+        """预编译路径是否可用（未安装失败）"""
+        return not self._failed
+
+    def definitions_script(self) -> str:
+        """拼接所有函数定义为一段脚本（一次编译全部注入）"""
+        return "\n".join(DEFINITIONS.values())
+
+    def invocation(self, name: str, cpg_expr: str, *args) -> str:
+        """生成预编译函数的调用表达式
+
+        Args:
+            name: 函数名（DEFINITIONS 中的键）
+            cpg_expr: CPG 前缀表达式（原样插入，不做字面量转义）
+            *args: 其余参数，按 Scala 字面量渲染
+
+        Returns:
+            str: 如 mcpGetCallers(cpg, "main")
+        """
+        if name not in DEFINITIONS:
+            raise ValueError(f"Unknown prepared query: {name}")
+
+        rendered = ", ".join([cpg_expr] + [_render_argument(a) for a in args])
+        return f"{name}({rendered})"
+
+    def mark_installed(self) -> None:
+        """标记安装成功"""
+        self._installed = True
+        self._failed = False
+        logger.info(f"Prepared queries installed: {len(DEFINITIONS)} definitions")
+
+    def mark_failed(self) -> None:
+        """标记安装失败，后续调用回退内联查询"""
+        self._failed = True
+        logger.warning(
+            "Prepared query installation failed, falling back to inline queries"
+        )
+
+    def reset(self) -> None:
+        """重置状态（Joern Server 重启后会话内的定义会丢失）"""
+        self._installed = False
+        self._failed = False
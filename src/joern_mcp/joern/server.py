@@ -46,6 +46,13 @@ class JoernServerManager:
         self.client: JoernHTTPClient | None = None
         self.auth_credentials: tuple[str, str] | None = None
 
+        # 后台启动状态：_ready 在服务器可接受查询后置位，
+        # 早到的查询在 _wait_boot 中排队等待而不是直接失败
+        self._ready = asyncio.Event()
+        self._boot_task: asyncio.Task | None = None
+        self._boot_error: str | None = None
+        self.is_warm = False
+
     async def start(
         self,
         username: str | None = None,
@@ -86,6 +93,7 @@ class JoernServerManager:
                     # 尝试连接到已有的服务器
                     if await self._try_connect_existing(timeout):
                         logger.info("Successfully connected to existing Joern server")
+                        self._ready.set()
                         return
 
             if auto_select_port:
@@ -155,6 +163,126 @@ class JoernServerManager:
             timeout=settings.query_timeout,
         )
         logger.info("Joern HTTP client initialized")
+        self._ready.set()
+
+    async def connect(self, timeout: int = 10) -> None:
+        """连接到外部已运行的 Joern Server（不拉起本地进程）
+
+        用于远程部署场景（如分片路由）：对端主机自行运行
+        joern --server，本进程只作为客户端接入。
+
+        Args:
+            timeout: 连接超时时间（秒）
+
+        Raises:
+            JoernServerError: 无法连接或服务器响应异常
+        """
+        if not await self._try_connect_existing(timeout):
+            raise JoernServerError(
+                f"Cannot connect to Joern server at {self.endpoint}"
+            )
+        self._ready.set()
+
+    def start_background(self, **kwargs) -> asyncio.Task:
+        """后台启动服务器（立即返回）
+
+        JVM 启动 + 就绪探测 + 预热在后台任务中完成，
+        MCP 进程可以立即响应协议请求；
+        就绪前到达的查询在 execute_query_async 中排队等待。
+
+        Returns:
+            后台启动任务（调用方可选择 await 或忽略）
+        """
+        if self._boot_task and not self._boot_task.done():
+            logger.warning("Background boot already in progress")
+            return self._boot_task
+
+        self._boot_error = None
+        self._boot_task = asyncio.create_task(self._boot(**kwargs))
+        return self._boot_task
+
+    async def _boot(self, **kwargs) -> None:
+        """后台启动流程：start + 预热"""
+        try:
+            await self.start(**kwargs)
+            if settings.joern_warmup_enabled:
+                await self.warm_up()
+            self.is_warm = True
+        except Exception as e:
+            logger.error(f"Background boot failed: {e}")
+            self._boot_error = str(e)
+            # 置位唤醒排队的查询，让它们拿到启动失败的错误
+            self._ready.set()
+
+    async def warm_up(self) -> None:
+        """执行预热查询，降低首个真实查询的延迟
+
+        两个阶段：
+        1. 打开 workspace 中最近的项目（恢复上次会话的 CPG）
+        2. 执行代表性模板查询，触发 Scala 编译管线和 JVM JIT；
+           无项目时查询失败是预期的，仅作热身用途
+        """
+        if not self.client:
+            return
+
+        from joern_mcp.joern.templates import QueryTemplates
+        from joern_mcp.utils.response_parser import safe_parse_joern_response
+
+        logger.info("Warming up Joern server...")
+
+        # 阶段1: 打开最近的 workspace 项目
+        try:
+            result = await self.client.execute("workspace.projects.map(_.name)")
+            if result.get("success"):
+                names = safe_parse_joern_response(
+                    result.get("stdout", ""), default=[]
+                )
+                if isinstance(names, list) and names:
+                    last_project = names[-1]
+                    logger.info(f"Warm-up: opening project {last_project}")
+                    await self.client.execute(f'open("{last_project}")')
+        except Exception as e:
+            logger.debug(f"Warm-up project open skipped: {e}")
+
+        # 阶段2: 代表性模板查询（覆盖方法遍历/正则匹配/Map 构造路径）
+        warmup_queries = [
+            "1 + 1",
+            QueryTemplates.build("LIST_FUNCTIONS", limit=1),
+            QueryTemplates.build("GET_FUNCTION", name="main"),
+            QueryTemplates.build(
+                "SEARCH_CALLS_BY_PATTERN", pattern="__warmup__", limit=1
+            ),
+        ]
+        for query in warmup_queries:
+            try:
+                await self.client.execute(query)
+            except Exception as e:
+                logger.debug(f"Warm-up query failed (expected without CPG): {e}")
+
+        logger.info("Joern server warm-up complete")
+
+    async def _wait_boot(self) -> None:
+        """等待后台启动完成（早到的查询排队而不是失败）"""
+        if self._boot_task is None:
+            raise JoernServerError("Server not started") from None
+
+        logger.debug("Query arrived before boot completed, waiting for server...")
+        try:
+            await asyncio.wait_for(
+                self._ready.wait(), timeout=settings.joern_boot_wait_timeout
+            )
+        except asyncio.TimeoutError:
+            raise JoernServerError(
+                f"Server boot did not complete within "
+                f"{settings.joern_boot_wait_timeout}s"
+            ) from None
+
+        if self._boot_error:
+            raise JoernServerError(
+                f"Server boot failed: {self._boot_error}"
+            ) from None
+        if not self.client:
+            raise JoernServerError("Server not started") from None
 
     async def _try_connect_existing(self, timeout: int = 10) -> bool:
         """尝试连接到已有的 Joern 服务器
@@ -323,6 +451,14 @@ class JoernServerManager:
 
     async def stop(self) -> None:
         """停止Joern Server"""
+        # 取消未完成的后台启动任务（启动失败自清理时除外，避免自我取消）
+        if self._boot_task and self._boot_task is not asyncio.current_task():
+            if not self._boot_task.done():
+                self._boot_task.cancel()
+            self._boot_task = None
+        self._ready.clear()
+        self.is_warm = False
+
         # 如果是连接到外部服务器，只清理客户端，不尝试停止进程
         if getattr(self, "_external_server", False):
             logger.info("Disconnecting from external Joern server (not stopping it)")
@@ -396,7 +532,8 @@ class JoernServerManager:
         完全异步，不会阻塞event loop。
         """
         if not self.client:
-            raise JoernServerError("Server not started") from None
+            # 后台启动尚未完成时排队等待，而不是直接失败
+            await self._wait_boot()
 
         logger.debug(f"Executing query (async): {query[:100]}...")
 
@@ -422,3 +559,22 @@ class JoernServerManager:
             logger.error(f"Code import failed: {result.get('stderr')}")
 
         return result
+
+    async def import_cpg(self, cpg_path: str, project_name: str) -> dict:
+        """加载预构建的 CPG 二进制文件
+
+        跳过语言前端，直接 importCpg 已导出的 cpg.bin，
+        秒级完成导入（相对于重新解析的分钟级）。
+        """
+        logger.info(f"Importing prebuilt CPG from {cpg_path} as {project_name}")
+
+        query = f'importCpg(inputPath="{cpg_path}", projectName="{project_name}")'
+
+        result = await self.execute_query_async(query)
+
+        if result.get("success"):
+            logger.info(f"CPG imported successfully: {project_name}")
+        else:
+            logger.error(f"CPG import failed: {result.get('stderr')}")
+
+        return result
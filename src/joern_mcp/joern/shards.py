@@ -0,0 +1,415 @@
+"""Joern Server 按项目分片路由
+
+单机部署时整个 workspace 必须装进一台主机的内存，
+最大的几个 CPG 已经无法共存。分片模式把项目分散到多台
+Joern 主机（每台独立 JVM 和 workspace）：路由表记录
+project_name -> 分片，导入只落到一个分片，查询按其中的
+项目引用透明路由过去。内存上限从"最大的单机"变成"全体之和"，
+吵闹的项目也互相隔离。
+
+与 JoernServerPool 的区别：池在一台主机上复制同一 workspace
+换取并发，分片在多台主机间划分 workspace 换取容量，二者路由
+键不同（池按负载，分片按项目）。
+
+对外接口与 JoernServerManager 保持一致
+（start/stop/restart/health_check/execute_query_async/import_code），
+QueryExecutor 无需感知分片的存在。
+
+路由规则：
+- 查询中引用的项目（workspace.project("x") 或 open/close/delete("x")）
+  在路由表中 -> 路由到其分片；
+- 无项目引用或项目未知 -> 路由到活动分片（最近导入/引用的项目所在
+  分片，初始为第一个分片）。
+
+路由表持久化到磁盘（与 CPG 代数文件同目录），
+重启后项目仍能找到自己所在的主机。
+
+分片端点由 joern_shard_endpoints 配置（逗号分隔 host:port）。
+本机端点由路由器拉起进程；远程端点须已各自运行
+joern --server，路由器只负责连接。
+"""
+
+import asyncio
+import json
+import re
+from pathlib import Path
+
+from loguru import logger
+
+from joern_mcp.config import settings
+from joern_mcp.joern.server import JoernServerError, JoernServerManager
+
+# 查询中的项目引用：CPG 前缀或项目管理命令
+_PROJECT_REF_PATTERN = re.compile(
+    r'workspace\.project\("([^"]+)"\)|\b(?:open|close|delete)\("([^"]+)"\)'
+)
+
+# 由路由器本地拉起进程的主机名，其余视为外部运行的远程分片
+_LOCAL_HOSTS = {"localhost", "127.0.0.1", "0.0.0.0"}
+
+
+def _extract_project_ref(query: str) -> str | None:
+    """提取查询引用的项目名（无引用返回 None）"""
+    match = _PROJECT_REF_PATTERN.search(query)
+    if match:
+        return match.group(1) or match.group(2)
+    return None
+
+
+class JoernShardRouter:
+    """Joern Server 按项目分片路由器
+
+    - 每个分片一个 JoernServerManager（本地拉起或连接远程）
+    - import_code/import_cpg 只落到按项目数最少选出的分片
+    - execute_query_async 按查询中的项目引用路由
+    - 路由表持久化，重启后分片归属不变
+    """
+
+    def __init__(self, endpoints: list[str] | None = None) -> None:
+        raw = endpoints or [
+            e.strip()
+            for e in settings.joern_shard_endpoints.split(",")
+            if e.strip()
+        ]
+        if not raw:
+            raise ValueError("At least one shard endpoint is required")
+
+        self.members: list[JoernServerManager] = []
+        for endpoint in raw:
+            host, sep, port = endpoint.rpartition(":")
+            if not sep or not port.isdigit():
+                raise ValueError(
+                    f"Invalid shard endpoint '{endpoint}' (expected host:port)"
+                )
+            self.members.append(JoernServerManager(host=host, port=int(port)))
+
+        # project_name -> 分片下标（磁盘加载，越界条目丢弃）
+        self._routing: dict[str, int] = self._load_routing()
+        # 无项目引用的查询路由到的分片（最近导入/引用的项目所在分片）
+        self._active_project: str | None = None
+
+        # 后台启动状态（语义同 JoernServerPool）
+        self._ready = asyncio.Event()
+        self._boot_task: asyncio.Task | None = None
+        self._boot_error: str | None = None
+        self.is_warm = False
+
+    @property
+    def endpoint(self) -> str:
+        """主端点（第一个分片，用于日志和诊断）"""
+        return self.members[0].endpoint
+
+    @property
+    def endpoints(self) -> list[str]:
+        """所有分片端点"""
+        return [m.endpoint for m in self.members]
+
+    # ==========================================
+    # 路由表持久化
+    # ==========================================
+
+    @staticmethod
+    def _routing_file() -> Path:
+        """路由表文件路径（与 CPG 代数文件同目录）"""
+        return settings.joern_cpg_cache / "shard_routing.json"
+
+    def _load_routing(self) -> dict[str, int]:
+        """加载路由表（分片数变化后越界的条目丢弃）"""
+        routing_file = self._routing_file()
+        if not routing_file.exists():
+            return {}
+        try:
+            raw = json.loads(routing_file.read_text(encoding="utf-8"))
+        except (json.JSONDecodeError, OSError) as e:
+            logger.warning(f"Failed to load shard routing table: {e}")
+            return {}
+        return {
+            name: index
+            for name, index in raw.items()
+            if isinstance(index, int) and 0 <= index < len(self.members)
+        }
+
+    def _save_routing(self) -> None:
+        """保存路由表到磁盘"""
+        routing_file = self._routing_file()
+        try:
+            routing_file.parent.mkdir(parents=True, exist_ok=True)
+            routing_file.write_text(json.dumps(self._routing), encoding="utf-8")
+        except OSError as e:
+            logger.warning(f"Failed to save shard routing table: {e}")
+
+    # ==========================================
+    # 生命周期（语义同 JoernServerPool）
+    # ==========================================
+
+    async def _start_member(self, member: JoernServerManager) -> None:
+        """启动或连接单个分片
+
+        本机端点由 start() 拉起进程（已有进程时自动连接）；
+        远程端点只连接，进程由对端主机自行管理。
+        """
+        if member.host in _LOCAL_HOSTS:
+            await member.start()
+        else:
+            await member.connect()
+
+    async def start(self, **kwargs) -> None:
+        """启动/连接所有分片
+
+        任何一个分片失败则整体报错：缺分片意味着
+        路由到它的项目全部不可用，静默降级只会更难排查。
+        """
+        logger.info(f"Starting Joern shard router ({len(self.members)} shard(s))")
+
+        results = await asyncio.gather(
+            *(self._start_member(m) for m in self.members), return_exceptions=True
+        )
+
+        failures = [r for r in results if isinstance(r, Exception)]
+        if failures:
+            logger.error(f"Failed to start {len(failures)} shard(s)")
+            await self.stop()
+            raise JoernServerError(
+                f"Failed to start shard router: {failures[0]}"
+            ) from None
+
+        logger.info(f"Joern shards ready: {', '.join(self.endpoints)}")
+        self._ready.set()
+
+    def start_background(self, **kwargs) -> asyncio.Task:
+        """后台启动所有分片（立即返回，就绪前的查询排队等待）"""
+        if self._boot_task and not self._boot_task.done():
+            logger.warning("Shard background boot already in progress")
+            return self._boot_task
+
+        self._boot_error = None
+        self._boot_task = asyncio.create_task(self._boot(**kwargs))
+        return self._boot_task
+
+    async def _boot(self, **kwargs) -> None:
+        """后台启动流程：启动/连接所有分片 + 并发预热"""
+        try:
+            await self.start(**kwargs)
+            if settings.joern_warmup_enabled:
+                await asyncio.gather(
+                    *(m.warm_up() for m in self.members), return_exceptions=True
+                )
+            self.is_warm = True
+        except Exception as e:
+            logger.error(f"Shard background boot failed: {e}")
+            self._boot_error = str(e)
+            self._ready.set()
+
+    async def _wait_boot(self) -> None:
+        """等待后台启动完成（语义同 JoernServerManager._wait_boot）"""
+        if self._boot_task is None:
+            raise JoernServerError("Shard router not started") from None
+
+        logger.debug("Query arrived before shard boot completed, waiting...")
+        try:
+            await asyncio.wait_for(
+                self._ready.wait(), timeout=settings.joern_boot_wait_timeout
+            )
+        except asyncio.TimeoutError:
+            raise JoernServerError(
+                f"Shard boot did not complete within "
+                f"{settings.joern_boot_wait_timeout}s"
+            ) from None
+
+        if self._boot_error:
+            raise JoernServerError(
+                f"Shard boot failed: {self._boot_error}"
+            ) from None
+
+    async def stop(self) -> None:
+        """停止所有本地分片、断开远程分片"""
+        logger.info("Stopping Joern shard router")
+        if self._boot_task and self._boot_task is not asyncio.current_task():
+            if not self._boot_task.done():
+                self._boot_task.cancel()
+            self._boot_task = None
+        self._ready.clear()
+        self.is_warm = False
+        await asyncio.gather(
+            *(m.stop() for m in self.members), return_exceptions=True
+        )
+
+    async def restart(self) -> None:
+        """重启所有分片"""
+        logger.info("Restarting Joern shard router")
+        await self.stop()
+        await self.start()
+
+    def is_running(self) -> bool:
+        """至少有一个分片在运行即认为可用"""
+        return any(m.is_running() for m in self.members)
+
+    async def health_check(self) -> bool:
+        """健康检查：所有分片都健康才算健康"""
+        checks = await asyncio.gather(
+            *(m.health_check() for m in self.members), return_exceptions=True
+        )
+        healthy = [c for c in checks if c is True]
+        if len(healthy) < len(self.members):
+            logger.warning(
+                f"Shard health: {len(healthy)}/{len(self.members)} shards healthy"
+            )
+        return len(healthy) == len(self.members)
+
+    # ==========================================
+    # 路由
+    # ==========================================
+
+    def _active_shard(self) -> int:
+        """活动分片下标（活动项目所在分片，缺省第一个分片）"""
+        if self._active_project is not None:
+            index = self._routing.get(self._active_project)
+            if index is not None:
+                return index
+        return 0
+
+    def _resolve_shard(self, project_name: str | None) -> int:
+        """查询应路由到的分片
+
+        路由表之外的项目（如对端主机上手工导入的）路由到
+        活动分片，由那里的 workspace 验证给出项目不存在的提示。
+        """
+        if project_name is not None:
+            index = self._routing.get(project_name)
+            if index is not None:
+                return index
+        return self._active_shard()
+
+    def _assign_shard(self, project_name: str) -> int:
+        """为项目分配分片（已有归属保持不变，新项目落到项目最少的分片）"""
+        index = self._routing.get(project_name)
+        if index is not None:
+            return index
+
+        counts = [0] * len(self.members)
+        for assigned in self._routing.values():
+            counts[assigned] += 1
+
+        best_index = -1
+        best_count = None
+        for i, member in enumerate(self.members):
+            if not member.is_running():
+                continue
+            if best_count is None or counts[i] < best_count:
+                best_index = i
+                best_count = counts[i]
+
+        if best_index < 0:
+            raise JoernServerError("No running shard available") from None
+
+        self._routing[project_name] = best_index
+        self._save_routing()
+        logger.info(
+            f"Project '{project_name}' assigned to shard "
+            f"{self.members[best_index].endpoint}"
+        )
+        return best_index
+
+    async def execute_query_async(self, query: str) -> dict:
+        """执行查询（按查询中的项目引用路由到对应分片）"""
+        if not self._ready.is_set() and self._boot_task is not None:
+            # 后台启动尚未完成时排队等待，而不是直接失败
+            await self._wait_boot()
+
+        project = _extract_project_ref(query)
+        index = self._resolve_shard(project)
+        member = self.members[index]
+        if not member.is_running():
+            raise JoernServerError(
+                f"Shard {member.endpoint} is not running"
+                + (f" (project '{project}')" if project else "")
+            ) from None
+
+        logger.debug(
+            f"Routing query to shard {member.endpoint}"
+            + (f" (project: {project})" if project else "")
+        )
+        result = await member.execute_query_async(query)
+
+        if project is not None and self._routing.get(project) == index:
+            # Joern 的 open/查询会切换该分片的活动项目，跟着记录
+            self._active_project = project
+            if f'delete("{project}")' in query and result.get("success"):
+                # 项目已删除，释放路由表条目
+                self._routing.pop(project, None)
+                self._save_routing()
+
+        return result
+
+    async def broadcast_query(self, query: str) -> list[tuple[str, dict]]:
+        """在所有运行中的分片上执行同一查询
+
+        用于 list_projects 等需要联合各分片 workspace 的场景。
+        返回 (端点, 结果) 列表；执行异常的分片记录警告后跳过。
+        """
+        if not self._ready.is_set() and self._boot_task is not None:
+            await self._wait_boot()
+
+        running = [m for m in self.members if m.is_running()]
+        results = await asyncio.gather(
+            *(m.execute_query_async(query) for m in running),
+            return_exceptions=True,
+        )
+
+        merged: list[tuple[str, dict]] = []
+        for member, result in zip(running, results):
+            if isinstance(result, Exception):
+                logger.warning(
+                    f"Broadcast query failed on shard {member.endpoint}: {result}"
+                )
+                continue
+            merged.append((member.endpoint, result))
+        return merged
+
+    # ==========================================
+    # 导入（只落到项目所属分片）
+    # ==========================================
+
+    async def import_code(self, source_path: str, project_name: str) -> dict:
+        """导入代码到项目所属的分片
+
+        与进程池的广播相反：分片的意义就是每个项目
+        只占用一台主机的内存。
+        """
+        index = self._assign_shard(project_name)
+        member = self.members[index]
+        logger.info(f"Importing {project_name} into shard {member.endpoint}")
+
+        result = await member.import_code(source_path, project_name)
+        if result.get("success"):
+            self._active_project = project_name
+        return result
+
+    async def import_cpg(self, cpg_path: str, project_name: str) -> dict:
+        """加载预构建 CPG 到项目所属的分片（语义同 import_code）"""
+        index = self._assign_shard(project_name)
+        member = self.members[index]
+        logger.info(
+            f"Importing prebuilt CPG {project_name} into shard {member.endpoint}"
+        )
+
+        result = await member.import_cpg(cpg_path, project_name)
+        if result.get("success"):
+            self._active_project = project_name
+        return result
+
+    def get_shard_stats(self) -> dict:
+        """获取分片状态（用于诊断和性能监控）"""
+        projects: dict[str, list[str]] = {m.endpoint: [] for m in self.members}
+        for name, index in self._routing.items():
+            projects[self.members[index].endpoint].append(name)
+        return {
+            "shards": len(self.members),
+            "running": sum(1 for m in self.members if m.is_running()),
+            "endpoints": self.endpoints,
+            "projects": projects,
+            "active_project": self._active_project,
+        }
+
+    def __repr__(self) -> str:
+        return f"JoernShardRouter(shards={len(self.members)})"
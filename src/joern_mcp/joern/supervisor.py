@@ -0,0 +1,169 @@
+"""后台健康监督器
+
+health_check 工具每次都发一条真实查询（占用执行槽），
+而 JVM 被失控查询卡死时它只会超时，没有任何补救——
+一条病态查询就能让整个服务瘫痪到有人手动介入。
+
+本监督器在后台周期巡检，优先使用零开销的被动信号：
+
+1. 进程存活（is_running，不发查询）
+2. 吞吐进度（PerformanceMetrics 的完成计数在前进 = 服务活着）
+
+只有被动信号可疑时（有在途查询但完成计数长时间停滞）
+才发一次带超时的主动探测确认；确认挂死后自动
+JoernServerManager.restart。重启后使 workspace 目录缓存和
+预编译函数注册失效（会话状态已丢失，首次访问时自动重建）；
+还在调度器里排队、尚未发出的查询在服务器恢复后自动继续执行，
+无需重放——只有重启瞬间在途的查询会收到错误。
+"""
+
+import asyncio
+import time
+from collections import deque
+from contextlib import suppress
+
+from loguru import logger
+
+from joern_mcp.config import settings
+from joern_mcp.utils.performance import get_metrics
+from joern_mcp.utils.project_utils import invalidate_catalog
+
+
+class HealthSupervisor:
+    """被动健康监督 + 挂死自动重启"""
+
+    # 主动探测的超时（挂死的 JVM 连 1+1 都答不上来）
+    PROBE_TIMEOUT = 20.0
+
+    def __init__(
+        self,
+        server_manager,
+        query_executor=None,
+        check_interval: int | None = None,
+        hang_threshold: int | None = None,
+    ):
+        self.server_manager = server_manager
+        self.query_executor = query_executor
+        self.check_interval = check_interval or settings.supervisor_check_interval
+        self.hang_threshold = hang_threshold or settings.supervisor_hang_threshold
+
+        self._task: asyncio.Task | None = None
+        self._last_completed = -1
+        self._last_progress = time.time()
+        # 重启冷却：防止启动持续失败时陷入重启风暴
+        self._cooldown_until = 0.0
+
+        self.restarts = 0
+        self.last_restart_at: float | None = None
+        self.last_restart_reason: str | None = None
+        self.events: deque = deque(maxlen=20)
+
+    def start(self) -> None:
+        """启动后台巡检任务"""
+        if self._task is None:
+            self._task = asyncio.create_task(self._loop())
+            logger.info(
+                f"Health supervisor started "
+                f"(interval: {self.check_interval}s, "
+                f"hang threshold: {self.hang_threshold}s)"
+            )
+
+    async def stop(self) -> None:
+        """停止巡检任务"""
+        if self._task is not None:
+            self._task.cancel()
+            with suppress(asyncio.CancelledError):
+                await self._task
+            self._task = None
+
+    async def _loop(self) -> None:
+        """巡检主循环"""
+        while True:
+            await asyncio.sleep(self.check_interval)
+            try:
+                await self._tick()
+            except asyncio.CancelledError:
+                raise
+            except Exception as e:
+                # 巡检本身绝不能把服务搞挂
+                logger.warning(f"Supervisor tick failed: {e}")
+
+    async def _tick(self) -> None:
+        """单次巡检：被动信号优先，可疑时才主动探测"""
+        # 被动信号1：进程存活
+        if not self.server_manager.is_running():
+            await self._restart("process not running")
+            return
+
+        # 被动信号2：吞吐进度（完成计数前进说明服务在干活）
+        metrics = get_metrics()
+        completed = metrics.total_queries
+        if completed != self._last_completed:
+            self._last_completed = completed
+            self._last_progress = time.time()
+            return
+
+        in_flight = metrics.current_concurrent
+        stalled_for = time.time() - self._last_progress
+        if in_flight > 0 and stalled_for > self.hang_threshold:
+            # 被动信号可疑：有在途查询但长时间无任何完成。
+            # 发一次带超时的主动探测确认（平时零探测开销）
+            healthy = False
+            try:
+                healthy = await asyncio.wait_for(
+                    self.server_manager.health_check(), self.PROBE_TIMEOUT
+                )
+            except (TimeoutError, asyncio.TimeoutError):
+                logger.warning("Supervisor probe timed out")
+            except Exception as e:
+                logger.warning(f"Supervisor probe failed: {e}")
+
+            if not healthy:
+                await self._restart(
+                    f"hang detected: {in_flight} query(ies) in flight, "
+                    f"no completion for {int(stalled_for)}s"
+                )
+
+    async def _restart(self, reason: str) -> None:
+        """重启 Joern 进程并重置依赖会话状态的缓存"""
+        now = time.time()
+        if now < self._cooldown_until:
+            logger.debug(f"Supervisor restart suppressed (cooldown): {reason}")
+            return
+        self._cooldown_until = now + self.check_interval * 4
+
+        logger.warning(f"Supervisor restarting Joern server: {reason}")
+        self.events.append({"time": now, "reason": reason})
+
+        try:
+            await self.server_manager.restart()
+        except Exception as e:
+            logger.error(f"Supervisor restart failed: {e}")
+            return
+
+        # 重启后 REPL 会话状态丢失：workspace 目录缓存与
+        # 预编译函数注册失效，首次访问时自动重建/重装
+        invalidate_catalog()
+        if self.query_executor is not None:
+            self.query_executor.prepared.reset()
+
+        self._last_progress = time.time()
+        self._last_completed = -1
+        self.restarts += 1
+        self.last_restart_at = time.time()
+        self.last_restart_reason = reason
+        logger.info(
+            "Supervisor restart complete; queued queries resume automatically"
+        )
+
+    def get_status(self) -> dict:
+        """监督器状态（health_check 工具附带返回）"""
+        return {
+            "enabled": self._task is not None,
+            "check_interval": self.check_interval,
+            "hang_threshold": self.hang_threshold,
+            "restarts": self.restarts,
+            "last_restart_at": self.last_restart_at,
+            "last_restart_reason": self.last_restart_reason,
+            "recent_events": list(self.events),
+        }
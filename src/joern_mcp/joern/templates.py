@@ -53,7 +53,7 @@ class QueryTemplates:
     GET_CALLEES = Template("""
         cpg.method.name("$name")
            .call
-           .filterNot(_.name == "<operator>.*")
+           .filterNot(_.name.startsWith("<operator>"))
            .map(c => Map(
                "name" -> c.name,
                "methodFullName" -> c.methodFullName,
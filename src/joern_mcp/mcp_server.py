@@ -1,11 +1,15 @@
 """MCP应用和全局状态"""
 
+import functools
+import inspect
 from collections.abc import AsyncIterator
 from contextlib import asynccontextmanager
 
 from fastmcp import FastMCP
 from loguru import logger
 
+from joern_mcp.utils.performance import track_tool
+
 
 # 全局状态类
 class _ServerState:
@@ -14,6 +18,7 @@ class _ServerState:
     def __init__(self):
         self.joern_server = None
         self.query_executor = None
+        self.supervisor = None
 
 
 # 创建全局状态实例
@@ -24,18 +29,43 @@ server_state = _ServerState()
 async def lifespan(_app) -> AsyncIterator[None]:
     """应用生命周期管理"""
     # 延迟导入避免循环依赖
+    from joern_mcp.config import settings
     from joern_mcp.joern.executor_optimized import OptimizedQueryExecutor
+    from joern_mcp.joern.pool import JoernServerPool
     from joern_mcp.joern.server import JoernServerManager
+    from joern_mcp.joern.shards import JoernShardRouter
+    from joern_mcp.joern.supervisor import HealthSupervisor
 
     logger.info("Starting Joern MCP Server...")
 
-    # 启动 Joern Server
-    server_state.joern_server = JoernServerManager()
-    await server_state.joern_server.start()
-
-    # 初始化优化的查询执行器
+    # 启动 Joern Server：
+    # 配置了分片端点时按项目分片路由到多台主机；
+    # 否则 pool_size > 1 时启用单机进程池负载均衡
+    if settings.joern_shard_endpoints:
+        server_state.joern_server = JoernShardRouter()
+    elif settings.joern_server_pool_size > 1:
+        server_state.joern_server = JoernServerPool()
+    else:
+        server_state.joern_server = JoernServerManager()
+
+    # 初始化优化的查询执行器（不依赖服务器就绪，可先行创建）
     server_state.query_executor = OptimizedQueryExecutor(server_state.joern_server)
 
+    if settings.joern_background_boot:
+        # 后台启动：MCP 立即可响应，JVM 启动 + 预热在后台完成，
+        # 就绪前到达的查询在服务器层排队等待
+        server_state.joern_server.start_background()
+        logger.info("Joern server booting in background (early queries will queue)")
+    else:
+        await server_state.joern_server.start()
+
+    # 后台健康监督：被动巡检 + 挂死自动重启
+    if settings.supervisor_enabled:
+        server_state.supervisor = HealthSupervisor(
+            server_state.joern_server, server_state.query_executor
+        )
+        server_state.supervisor.start()
+
     logger.info("Joern MCP Server started successfully")
     logger.info(f"Joern endpoint: {server_state.joern_server.endpoint}")
 
@@ -43,6 +73,8 @@ async def lifespan(_app) -> AsyncIterator[None]:
 
     # 清理
     logger.info("Stopping Joern MCP Server...")
+    if server_state.supervisor:
+        await server_state.supervisor.stop()
     if server_state.joern_server:
         await server_state.joern_server.stop()
     logger.info("Joern MCP Server stopped")
@@ -50,3 +82,29 @@ async def lifespan(_app) -> AsyncIterator[None]:
 
 # 创建 MCP 应用（带生命周期管理）
 mcp = FastMCP("Joern Code Analysis", lifespan=lifespan)
+
+# 工具注册包装：每个 @mcp.tool() 函数执行期间设置 track_tool
+# 上下文，查询指标自动按工具名分维度统计（见 utils/performance.py
+# 的 by_tool），不必在几十个工具函数里逐一埋点。
+# functools.wraps 保留 __wrapped__，fastmcp 的签名内省不受影响。
+_original_tool = mcp.tool
+
+
+def _tracking_tool(*args, **kwargs):
+    def _decorate(fn, deco_args):
+        if not inspect.iscoroutinefunction(fn):
+            return _original_tool(*deco_args, **kwargs)(fn)
+
+        @functools.wraps(fn)
+        async def _traced(*f_args, **f_kwargs):
+            with track_tool(fn.__name__):
+                return await fn(*f_args, **f_kwargs)
+
+        return _original_tool(*deco_args, **kwargs)(_traced)
+
+    if args and callable(args[0]):  # @mcp.tool 不带括号的用法
+        return _decorate(args[0], args[1:])
+    return lambda fn: _decorate(fn, args)
+
+
+mcp.tool = _tracking_tool
@@ -4,6 +4,12 @@ from loguru import logger
 
 from joern_mcp.config import settings
 from joern_mcp.mcp_server import mcp, server_state
+from joern_mcp.utils.pagination import (
+    apply_page_window,
+    decode_cursor,
+    encode_cursor,
+)
+from joern_mcp.utils.response_parser import safe_parse_joern_response
 
 # ===== MCP Tools =====
 
@@ -35,6 +41,10 @@ async def health_check() -> dict:
         "process_running": process_running,
     }
 
+    # 后台监督器状态（巡检配置、重启次数与最近事件）
+    if server_state.supervisor:
+        result["supervisor"] = server_state.supervisor.get_status()
+
     if not is_healthy:
         # 添加更多诊断信息
         if not process_running:
@@ -52,7 +62,11 @@ async def health_check() -> dict:
 
 @mcp.tool()
 async def execute_query(
-    query: str, format: str = "json", timeout: int | None = None
+    query: str,
+    format: str = "json",
+    timeout: int | None = None,
+    page_size: int | None = None,
+    cursor: str | None = None,
 ) -> dict:
     """
     执行自定义Joern查询
@@ -61,9 +75,12 @@ async def execute_query(
         query: Scala查询语句
         format: 输出格式 (json, dot)
         timeout: 超时时间（秒）
+        page_size: 每页条目数（可选；指定后启用分页，
+                   分页窗口下推到 CPGQL 遍历，避免大结果集撑爆内存）
+        cursor: 上一页返回的 next_cursor（配合 page_size 使用）
 
     Returns:
-        dict: 查询结果
+        dict: 查询结果；分页模式下附带 has_more / next_cursor
 
     Example:
         >>> await execute_query("cpg.method.name")
@@ -76,6 +93,46 @@ async def execute_query(
         return {"success": False, "error": "Custom queries are disabled"}
 
     try:
+        if page_size is not None:
+            page_size = max(1, min(page_size, 1000))
+            if cursor:
+                try:
+                    offset = decode_cursor(cursor, query)
+                except ValueError as e:
+                    return {"success": False, "error": str(e)}
+            else:
+                offset = 0
+
+            # 多取 1 条用于判断是否还有下一页
+            paged_query = apply_page_window(query, offset, page_size + 1)
+            result = await server_state.query_executor.execute(
+                paged_query, format=format, timeout=timeout
+            )
+
+            if not result.get("success"):
+                stderr = result.get("stderr", "Query failed")
+                logger.error(f"Paged query execution failed: {stderr}")
+                return {"success": False, "error": stderr, "raw": result}
+
+            items = safe_parse_joern_response(result.get("stdout", ""), default=[])
+            if not isinstance(items, list):
+                items = [items] if items else []
+
+            has_more = len(items) > page_size
+            items = items[:page_size]
+
+            return {
+                "success": True,
+                "result": items,
+                "count": len(items),
+                "offset": offset,
+                "page_size": page_size,
+                "has_more": has_more,
+                "next_cursor": (
+                    encode_cursor(offset + page_size, query) if has_more else None
+                ),
+            }
+
         result = await server_state.query_executor.execute(
             query, format=format, timeout=timeout
         )
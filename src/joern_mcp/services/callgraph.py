@@ -7,6 +7,7 @@
 from loguru import logger
 
 from joern_mcp.joern.executor import QueryExecutor
+from joern_mcp.services.callgraph_index import get_index_cache
 from joern_mcp.utils.project_utils import get_safe_cpg_prefix
 from joern_mcp.utils.response_parser import safe_parse_joern_response
 
@@ -19,12 +20,17 @@ class CallGraphService:
     - 获取被调用者 (callees)
     - 调用链追踪
     - 完整调用图构建
+    - 进程内调用图索引（一次批量抽取，微秒级回答后续查询）
+
+    build_index 之后，callers/callees/调用链查询直接由本地邻接
+    索引回答，不再走 Joern 往返；未建索引时行为与之前完全一致。
 
     所有方法支持 project_name 参数指定项目范围。
     """
 
     def __init__(self, query_executor: QueryExecutor):
         self.executor = query_executor
+        self.index_cache = get_index_cache()
 
     async def get_callers(
         self, function_name: str, depth: int = 1, project_name: str | None = None
@@ -45,6 +51,22 @@ class CallGraphService:
         )
 
         try:
+            # 索引快路径：已建索引时本地回答，零 Joern 往返
+            index = self.index_cache.peek(project_name)
+            if index is not None:
+                callers = index.callers_of(function_name)
+                response = {
+                    "success": True,
+                    "function": function_name,
+                    "depth": min(depth, 5),
+                    "callers": callers,
+                    "count": len(callers),
+                    "source": "index",
+                }
+                if project_name:
+                    response["project"] = project_name
+                return response
+
             # 安全获取 CPG 前缀，验证项目存在性
             cpg_prefix, error = await get_safe_cpg_prefix(self.executor, project_name)
             if error:
@@ -70,7 +92,10 @@ class CallGraphService:
                .dedup
             '''
 
-            result = await self.executor.execute(query)
+            # 预编译路径：命中时只发送函数调用，避免模板重复编译
+            result = await self.executor.execute(
+                query, prepared=("mcpGetCallers", cpg_prefix, function_name)
+            )
 
             if result.get("success"):
                 stdout = result.get("stdout", "")
@@ -115,6 +140,22 @@ class CallGraphService:
         )
 
         try:
+            # 索引快路径：已建索引时本地回答，零 Joern 往返
+            index = self.index_cache.peek(project_name)
+            if index is not None:
+                callees = index.callees_of(function_name)
+                response = {
+                    "success": True,
+                    "function": function_name,
+                    "depth": min(depth, 5),
+                    "callees": callees,
+                    "count": len(callees),
+                    "source": "index",
+                }
+                if project_name:
+                    response["project"] = project_name
+                return response
+
             # 安全获取 CPG 前缀，验证项目存在性
             cpg_prefix, error = await get_safe_cpg_prefix(self.executor, project_name)
             if error:
@@ -129,7 +170,7 @@ class CallGraphService:
             query = f'''
             {cpg_prefix}.method.name("{function_name}")
                .call
-               .filterNot(_.name == "<operator>.*")
+               .filterNot(_.name.startsWith("<operator>"))
                .map(c => Map(
                    "name" -> c.name,
                    "methodFullName" -> c.methodFullName,
@@ -141,7 +182,10 @@ class CallGraphService:
                .dedup
             '''
 
-            result = await self.executor.execute(query)
+            # 预编译路径：命中时只发送函数调用，避免模板重复编译
+            result = await self.executor.execute(
+                query, prepared=("mcpGetCallees", cpg_prefix, function_name)
+            )
 
             if result.get("success"):
                 stdout = result.get("stdout", "")
@@ -192,6 +236,25 @@ class CallGraphService:
         )
 
         try:
+            # 索引快路径：BFS 展开到完整深度，且零 Joern 往返
+            # （直接查询路径受 REPL 限制只能展开一层）
+            index = self.index_cache.peek(project_name)
+            if index is not None:
+                max_depth = min(max_depth, 5)
+                chain = index.chain(function_name, direction, max_depth)
+                response = {
+                    "success": True,
+                    "function": function_name,
+                    "direction": direction,
+                    "max_depth": max_depth,
+                    "chain": chain,
+                    "count": len(chain),
+                    "source": "index",
+                }
+                if project_name:
+                    response["project"] = project_name
+                return response
+
             # 安全获取 CPG 前缀，验证项目存在性
             cpg_prefix, error = await get_safe_cpg_prefix(self.executor, project_name)
             if error:
@@ -218,7 +281,7 @@ class CallGraphService:
                 query = f'''
                 {cpg_prefix}.method.name("{function_name}")
                    .call
-                   .filterNot(_.name == "<operator>.*")
+                   .filterNot(_.name.startsWith("<operator>"))
                    .map(c => Map(
                        "name" -> c.name,
                        "filename" -> c.file.name.headOption.getOrElse("<unknown>"),
@@ -329,6 +392,54 @@ class CallGraphService:
             logger.exception(f"Error building call graph: {e}")
             return {"success": False, "error": str(e)}
 
+    async def build_index(
+        self,
+        project_name: str | None = None,
+        max_edges: int | None = None,
+        force: bool = False,
+    ) -> dict:
+        """
+        构建进程内调用图索引
+
+        一次批量抽取完整的调用边列表，之后 get_callers / get_callees /
+        get_call_chain / get_call_graph 全部由本地索引回答。
+        索引按 CPG 代数缓存，项目重新导入后自动失效。
+
+        Args:
+            project_name: 项目名称（可选）
+            max_edges: 批量抽取的边数上限（可选）
+            force: 强制重建（忽略已有索引）
+
+        Returns:
+            dict: 索引统计（边数、函数数、构建时间）
+        """
+        logger.info(
+            f"Building call graph index (project: {project_name or 'current'})"
+        )
+
+        try:
+            # 安全获取 CPG 前缀，验证项目存在性
+            cpg_prefix, error = await get_safe_cpg_prefix(self.executor, project_name)
+            if error:
+                return {"success": False, "error": error}
+
+            index = await self.index_cache.get_or_build(
+                self.executor,
+                cpg_prefix,
+                project_name,
+                max_edges=max_edges or self.index_cache.DEFAULT_MAX_EDGES,
+                force=force,
+            )
+
+            response = {"success": True, **index.get_stats()}
+            if project_name:
+                response["project"] = project_name
+            return response
+
+        except Exception as e:
+            logger.exception(f"Error building call graph index: {e}")
+            return {"success": False, "error": str(e)}
+
     async def _collect_callers_recursive(
         self,
         function_name: str,
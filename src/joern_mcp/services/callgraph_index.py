@@ -0,0 +1,255 @@
+"""进程内调用图索引
+
+交互式调用链探索是最热的分析路径，而 get_call_chain /
+get_call_graph 每展开一层就要一次 Joern 查询（网络往返 + REPL 编译）。
+
+本模块用一次批量抽取把整个调用边列表拉到本地，构建
+调用者/被调用者邻接索引，后续的 callers / callees / 调用链
+查询全部在内存中以微秒级回答。
+
+索引按 (项目, CPG 代数) 缓存，parse_project 重新导入会递增代数，
+旧索引自动失效，无需显式清理。
+"""
+
+import asyncio
+import time
+
+from loguru import logger
+
+from joern_mcp.utils.cpg_generation import CURRENT_PROJECT_KEY, get_generation
+from joern_mcp.utils.response_parser import safe_parse_joern_response
+
+
+class CallGraphIndex:
+    """单个项目的调用图邻接索引
+
+    边的数据形状与 get_callers / get_callees 的查询结果一致，
+    索引回答可以无缝替换直接查询的响应。
+    """
+
+    def __init__(self, edges: list[dict]) -> None:
+        # 被调用者名 -> 调用边列表（回答 callers_of）
+        self._by_callee: dict[str, list[dict]] = {}
+        # 调用者名 -> 调用边列表（回答 callees_of）
+        self._by_caller: dict[str, list[dict]] = {}
+
+        for edge in edges:
+            if not isinstance(edge, dict):
+                continue
+            caller = edge.get("caller", "")
+            callee = edge.get("callee", "")
+            if caller:
+                self._by_caller.setdefault(caller, []).append(edge)
+            if callee:
+                self._by_callee.setdefault(callee, []).append(edge)
+
+        self.edge_count = len(edges)
+        self.built_at = time.time()
+
+    def callers_of(self, function_name: str) -> list[dict]:
+        """获取调用者列表（形状与 get_callers 的直接查询一致）"""
+        results = []
+        seen = set()
+        for edge in self._by_callee.get(function_name, []):
+            entry = {
+                "name": edge.get("caller", ""),
+                "methodFullName": edge.get("callerFullName", ""),
+                "signature": edge.get("signature", ""),
+                "filename": edge.get("filename", "<unknown>"),
+                "lineNumber": edge.get("lineNumber", -1),
+                "code": edge.get("code", ""),
+            }
+            key = (entry["name"], entry["lineNumber"], entry["code"])
+            if key not in seen:
+                seen.add(key)
+                results.append(entry)
+        return results
+
+    def callees_of(self, function_name: str) -> list[dict]:
+        """获取被调用者列表（形状与 get_callees 的直接查询一致）"""
+        results = []
+        seen = set()
+        for edge in self._by_caller.get(function_name, []):
+            entry = {
+                "name": edge.get("callee", ""),
+                "methodFullName": edge.get("calleeFullName", ""),
+                "signature": edge.get("signature", ""),
+                "filename": edge.get("filename", "<unknown>"),
+                "lineNumber": edge.get("lineNumber", -1),
+                "code": edge.get("code", ""),
+            }
+            key = (entry["name"], entry["lineNumber"], entry["code"])
+            if key not in seen:
+                seen.add(key)
+                results.append(entry)
+        return results
+
+    def chain(
+        self, function_name: str, direction: str = "up", max_depth: int = 5
+    ) -> list[dict]:
+        """BFS 展开调用链到指定深度
+
+        Args:
+            function_name: 起点函数
+            direction: up=调用者链, down=被调用者链
+            max_depth: 最大深度
+
+        Returns:
+            list[dict]: 链上节点，附带 depth 字段（1 = 直接邻居）
+        """
+        expand = self.callers_of if direction == "up" else self.callees_of
+
+        chain = []
+        visited = {function_name}
+        frontier = [function_name]
+
+        for depth in range(1, max_depth + 1):
+            next_frontier = []
+            for name in frontier:
+                for entry in expand(name):
+                    node = dict(entry)
+                    node["depth"] = depth
+                    chain.append(node)
+                    neighbor = entry.get("name", "")
+                    if neighbor and neighbor not in visited:
+                        visited.add(neighbor)
+                        next_frontier.append(neighbor)
+            if not next_frontier:
+                break
+            frontier = next_frontier
+
+        return chain
+
+    def get_stats(self) -> dict:
+        """索引统计"""
+        return {
+            "edge_count": self.edge_count,
+            "caller_count": len(self._by_caller),
+            "callee_count": len(self._by_callee),
+            "built_at": self.built_at,
+        }
+
+
+class CallGraphIndexCache:
+    """按 (项目, CPG 代数) 缓存调用图索引
+
+    并发构建同一项目的索引时由每项目锁串行化，
+    批量抽取只执行一次。
+    """
+
+    # 批量抽取的默认边数上限（防止超大项目拖垮 JVM 序列化）
+    DEFAULT_MAX_EDGES = 200000
+
+    def __init__(self) -> None:
+        self._indexes: dict[tuple[str, int], CallGraphIndex] = {}
+        self._locks: dict[str, asyncio.Lock] = {}
+
+    @staticmethod
+    def _key(project_name: str | None) -> tuple[str, int]:
+        project = project_name or CURRENT_PROJECT_KEY
+        return project, get_generation(project)
+
+    def peek(self, project_name: str | None) -> CallGraphIndex | None:
+        """获取当前代数的已建索引（无则返回 None，不触发构建）"""
+        return self._indexes.get(self._key(project_name))
+
+    async def get_or_build(
+        self,
+        executor,
+        cpg_prefix: str,
+        project_name: str | None,
+        max_edges: int = DEFAULT_MAX_EDGES,
+        force: bool = False,
+    ) -> CallGraphIndex:
+        """获取索引，必要时通过一次批量抽取构建
+
+        Raises:
+            RuntimeError: 批量抽取查询失败
+        """
+        key = self._key(project_name)
+        if not force:
+            existing = self._indexes.get(key)
+            if existing is not None:
+                return existing
+
+        lock = self._locks.setdefault(key[0], asyncio.Lock())
+        async with lock:
+            # 双重检查：等锁期间可能已被并发请求构建
+            if not force:
+                existing = self._indexes.get(key)
+                if existing is not None:
+                    return existing
+
+            edges = await self._extract_edges(executor, cpg_prefix, max_edges)
+            index = CallGraphIndex(edges)
+
+            # 丢弃该项目旧代数的索引
+            self._indexes = {
+                k: v for k, v in self._indexes.items() if k[0] != key[0]
+            }
+            self._indexes[key] = index
+
+            logger.info(
+                f"Call graph index built for {key[0]}: "
+                f"{index.edge_count} edges (generation {key[1]})"
+            )
+            return index
+
+    async def _extract_edges(
+        self, executor, cpg_prefix: str, max_edges: int
+    ) -> list[dict]:
+        """一次批量抽取完整的调用边列表"""
+        query = f'''
+        {cpg_prefix}.call
+           .filterNot(_.name.startsWith("<operator>"))
+           .take({max_edges})
+           .map(c => Map(
+               "caller" -> c.method.name,
+               "callerFullName" -> c.method.fullName,
+               "callee" -> c.name,
+               "calleeFullName" -> c.methodFullName,
+               "signature" -> c.signature,
+               "filename" -> c.file.name.headOption.getOrElse("<unknown>"),
+               "lineNumber" -> c.lineNumber.getOrElse(-1),
+               "code" -> c.code
+           ))
+        '''
+
+        result = await executor.execute(query, use_cache=False)
+        if not result.get("success"):
+            raise RuntimeError(
+                result.get("stderr", "Call graph bulk extraction failed")
+            )
+
+        edges = safe_parse_joern_response(result.get("stdout", ""), default=[])
+        if not isinstance(edges, list):
+            edges = [edges] if edges else []
+        return edges
+
+    def invalidate(self, project_name: str | None = None) -> None:
+        """失效索引（不指定项目时全部清空）"""
+        if project_name is None:
+            self._indexes.clear()
+        else:
+            self._indexes = {
+                k: v for k, v in self._indexes.items() if k[0] != project_name
+            }
+
+    def get_stats(self) -> dict:
+        """缓存统计"""
+        return {
+            "indexed_projects": [
+                {"project": k[0], "generation": k[1], **v.get_stats()}
+                for k, v in self._indexes.items()
+            ],
+            "count": len(self._indexes),
+        }
+
+
+# 全局索引缓存（与查询执行器同生命周期）
+_index_cache = CallGraphIndexCache()
+
+
+def get_index_cache() -> CallGraphIndexCache:
+    """获取全局调用图索引缓存"""
+    return _index_cache
@@ -1,16 +1,21 @@
 """数据流分析服务
 
 追踪程序中的数据流向：
-- track_dataflow: 从源到汇的数据流追踪
+- track_dataflow: 从源到汇的数据流追踪（带汇摘要缓存，
+  同汇多源的交互式探查首查后即答）
 - analyze_variable_flow: 分析变量的数据流
 - find_data_dependencies: 查找数据依赖关系
 
 支持多项目查询：所有方法接受可选的 project_name 参数。
 """
 
+import re
+
 from loguru import logger
 
+from joern_mcp.config import settings
 from joern_mcp.joern.executor import QueryExecutor
+from joern_mcp.utils.flow_summary import get_flow_summary_cache
 from joern_mcp.utils.project_utils import get_safe_cpg_prefix
 from joern_mcp.utils.response_parser import safe_parse_joern_response
 
@@ -69,6 +74,15 @@ class DataFlowService:
             if error:
                 return {"success": False, "error": error}
 
+            # 汇摘要缓存：同一个汇的首次探查算出完整摘要，
+            # 后续配对在 Python 端按源过滤即答（不再跑 reachableBy）
+            if settings.flow_summary_enabled:
+                summarized = await self._probe_sink_summary(
+                    cpg_prefix, source_method, sink_method, max_flows, project_name
+                )
+                if summarized is not None:
+                    return summarized
+
             query = f'''
             {{
               val source = {cpg_prefix}.method.name("{source_method}").parameter
@@ -99,7 +113,17 @@ class DataFlowService:
             }}
             '''
 
-            result = await self.executor.execute(query)
+            # 预编译路径：命中时只发送函数调用，避免模板重复编译
+            result = await self.executor.execute(
+                query,
+                prepared=(
+                    "mcpTrackDataflow",
+                    cpg_prefix,
+                    source_method,
+                    sink_method,
+                    max_flows,
+                ),
+            )
 
             if result.get("success"):
                 stdout = result.get("stdout", "")
@@ -125,6 +149,127 @@ class DataFlowService:
             logger.exception(f"Error tracking dataflow: {e}")
             return {"success": False, "error": str(e)}
 
+    async def _probe_sink_summary(
+        self,
+        cpg_prefix: str,
+        source_method: str,
+        sink_method: str,
+        max_flows: int,
+        project_name: "str | None",
+    ) -> "dict | None":
+        """用汇摘要回答配对探查
+
+        摘要缺失时现算并缓存（一次重查询）。返回 None 表示
+        本次应退回直查：摘要计算失败、源模式不是合法正则、
+        或摘要被截断且未命中该源（可能漏报）。
+        """
+        cache = get_flow_summary_cache()
+        summary = cache.get(project_name, sink_method)
+        if summary is None:
+            summary = await self._compute_sink_summary(cpg_prefix, sink_method)
+            if summary is None:
+                return None
+            cache.set(project_name, sink_method, summary)
+
+        try:
+            source_pattern = re.compile(source_method)
+        except re.error:
+            return None
+
+        flows = [
+            flow
+            for flow in summary["flows"]
+            if source_pattern.fullmatch(flow.get("sourceMethod") or "")
+        ]
+        if not flows and summary["truncated"]:
+            # 截断的摘要未命中该源不等于无流，退回直查
+            return None
+
+        flows = [
+            {k: v for k, v in flow.items() if k != "sourceMethod"}
+            for flow in flows[:max_flows]
+        ]
+        response = {
+            "success": True,
+            "source_method": source_method,
+            "sink_method": sink_method,
+            "flows": flows,
+            "count": len(flows),
+            "from_summary": True,
+        }
+        if project_name:
+            response["project"] = project_name
+        return response
+
+    async def _compute_sink_summary(
+        self, cpg_prefix: str, sink_method: str
+    ) -> "dict | None":
+        """计算一个汇函数的数据流摘要
+
+        源取全部方法参数（track_dataflow 的源集合的超集），
+        每条流带上源参数所属方法名（sourceMethod）供配对过滤。
+        查询失败返回 None（调用方退回直查）。
+        """
+        limit = settings.flow_summary_max_flows
+        query = f'''
+        {{
+          val source = {cpg_prefix}.method.parameter
+          val sink = {cpg_prefix}.call.name("{sink_method}").argument
+
+          sink.reachableByFlows(source).take({limit}).map {{ path =>
+            val sourceNode = path.elements.head
+            val sinkNode = path.elements.last
+            Map(
+              "sourceMethod" -> sourceNode.method.name,
+              "source" -> Map(
+                  "code" -> sourceNode.code,
+                  "file" -> sourceNode.file.name.headOption.getOrElse("unknown"),
+                  "line" -> sourceNode.lineNumber.getOrElse(-1)
+              ),
+              "sink" -> Map(
+                  "code" -> sinkNode.code,
+                  "file" -> sinkNode.file.name.headOption.getOrElse("unknown"),
+                  "line" -> sinkNode.lineNumber.getOrElse(-1)
+              ),
+              "pathLength" -> path.elements.size,
+              "path" -> path.elements.take(20).map(e => Map(
+                  "type" -> e.label,
+                  "code" -> e.code,
+                  "line" -> e.lineNumber.getOrElse(-1)
+              ))
+            )
+          }}
+        }}
+        '''
+
+        result = await self.executor.execute(query)
+        if not result.get("success"):
+            logger.warning(
+                f"Sink summary computation failed for {sink_method}: "
+                f"{result.get('stderr', 'unknown')}"
+            )
+            return None
+
+        flows = safe_parse_joern_response(result.get("stdout", ""), default=[])
+        if not isinstance(flows, list):
+            flows = [flows] if flows else []
+
+        # 缺少 sourceMethod 标记的流无法按源归属，摘要不可用
+        if flows and not all(
+            isinstance(f, dict) and "sourceMethod" in f for f in flows
+        ):
+            logger.warning(
+                f"Sink summary for {sink_method} missing sourceMethod tags, "
+                "falling back to direct query"
+            )
+            return None
+
+        logger.info(
+            f"Sink summary cached: {sink_method} "
+            f"({len(flows)} flows{', truncated' if len(flows) >= limit else ''})"
+        )
+        return {"flows": flows, "truncated": len(flows) >= limit}
+
     async def analyze_variable_flow(
         self,
         variable_name: str,
@@ -209,7 +354,20 @@ class DataFlowService:
                    ))
                 '''
 
-            result = await self.executor.execute(query)
+            if sink_method:
+                # 预编译路径：命中时只发送函数调用，避免模板重复编译
+                result = await self.executor.execute(
+                    query,
+                    prepared=(
+                        "mcpVariableFlow",
+                        cpg_prefix,
+                        variable_name,
+                        sink_method,
+                        max_flows,
+                    ),
+                )
+            else:
+                result = await self.executor.execute(query)
 
             if result.get("success"):
                 stdout = result.get("stdout", "")
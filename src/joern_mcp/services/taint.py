@@ -3,11 +3,18 @@
 识别和追踪安全漏洞：
 - analyze_with_rule: 使用特定规则进行污点分析
 - find_vulnerabilities: 查找代码中的漏洞
+- scan_all_rules: 全规则融合扫描（共享源/汇遍历，少量查询覆盖全部规则）
+- scan_severity_tier: 单查询严重级别扫描（启动时预编译，每级别一次往返）
 - check_specific_flow: 检查自定义的污点流
 
 支持多项目查询：所有分析方法接受可选的 project_name 参数。
 """
 
+import asyncio
+import re
+from dataclasses import dataclass
+from string import Template
+
 from loguru import logger
 
 from joern_mcp.joern.executor import QueryExecutor
@@ -21,6 +28,23 @@ from joern_mcp.models.taint_rules import (
 from joern_mcp.utils.project_utils import get_safe_cpg_prefix
 from joern_mcp.utils.response_parser import safe_parse_joern_response
 
+# 严重级别梯度（CI 门禁按级别逐层收紧）
+SEVERITY_TIERS = ("CRITICAL", "HIGH", "MEDIUM", "LOW")
+
+
+@dataclass
+class TierSweep:
+    """单个严重级别的预编译扫描块
+
+    该级别全部规则的源/汇集合在一条 Scala 查询内求值，
+    模板仅剩 $cpg / $max_flows 两个占位符留到调用时替换。
+    groups 与 Scala 块中的 group 下标一一对应，供结果归属。
+    """
+
+    severity: str
+    groups: list[list[TaintRule]]
+    template: Template
+
 
 class TaintAnalysisService:
     """污点分析服务
@@ -196,6 +220,285 @@ class TaintAnalysisService:
             logger.exception(f"Error finding vulnerabilities: {e}")
             return {"success": False, "error": str(e)}
 
+    async def scan_all_rules(
+        self,
+        severity: str | None = None,
+        max_flows_per_group: int = 50,
+        project_name: str | None = None,
+    ) -> dict:
+        """
+        全规则融合扫描
+
+        与逐规则调用 analyze_with_rule 不同，这里把源模式相同的规则
+        合并为一组（预定义规则大多共享 user_input 源集合），每组只做
+        一次 reachableByFlows：源遍历计算一次，汇取组内所有规则的
+        并集，流结果按汇调用名在 Python 端归属回各条规则。
+        各组的融合查询并发下发，由执行器的调度槽位分配。
+
+        Args:
+            severity: 严重程度过滤（可选：CRITICAL, HIGH, MEDIUM, LOW）
+            max_flows_per_group: 每组融合查询的最大流数量
+            project_name: 项目名称（可选）
+
+        Returns:
+            dict: 漏洞列表和统计信息，附带融合查询数量
+
+        Example:
+            >>> result = await service.scan_all_rules(project_name="webapp")
+            {
+                "success": True,
+                "vulnerabilities": [...],
+                "total_count": 5,
+                "summary": {"CRITICAL": 3, "HIGH": 2, "MEDIUM": 0, "LOW": 0},
+                "rules_checked": 6,
+                "fused_queries": 3
+            }
+        """
+        logger.info(
+            f"Running fused all-rule taint scan (severity: {severity}, project: {project_name or 'current'})"
+        )
+
+        try:
+            # 安全获取 CPG 前缀，验证项目存在性
+            cpg_prefix, error = await get_safe_cpg_prefix(self.executor, project_name)
+            if error:
+                return {"success": False, "error": error}
+
+            rules = (
+                get_rules_by_severity(severity) if severity else VULNERABILITY_RULES
+            )
+            if not rules:
+                return {
+                    "success": True,
+                    "vulnerabilities": [],
+                    "total_count": 0,
+                    "summary": {"CRITICAL": 0, "HIGH": 0, "MEDIUM": 0, "LOW": 0},
+                    "rules_checked": 0,
+                    "fused_queries": 0,
+                }
+
+            groups = self._group_rules_by_sources(rules)
+
+            # 各组融合查询并发下发（独立的源集合之间没有共享可言）
+            results = await asyncio.gather(
+                *(
+                    self._run_fused_group(
+                        cpg_prefix, group_rules, max_flows_per_group
+                    )
+                    for group_rules in groups
+                ),
+                return_exceptions=True,
+            )
+
+            all_vulnerabilities = []
+            summary = {"CRITICAL": 0, "HIGH": 0, "MEDIUM": 0, "LOW": 0}
+            errors = []
+
+            for group_rules, group_result in zip(groups, results):
+                if isinstance(group_result, Exception):
+                    logger.error(f"Fused group query failed: {group_result}")
+                    errors.append(str(group_result))
+                    continue
+
+                vulns = self._attribute_flows(group_result, group_rules)
+                all_vulnerabilities.extend(vulns)
+                for vuln in vulns:
+                    severity_key = vuln.get("severity", "LOW")
+                    if severity_key in summary:
+                        summary[severity_key] += 1
+
+            response = {
+                "success": True,
+                "vulnerabilities": all_vulnerabilities,
+                "total_count": len(all_vulnerabilities),
+                "summary": summary,
+                "rules_checked": len(rules),
+                "fused_queries": len(groups),
+            }
+            if errors:
+                response["partial_errors"] = errors
+            if project_name:
+                response["project"] = project_name
+            return response
+
+        except Exception as e:
+            logger.exception(f"Error in fused taint scan: {e}")
+            return {"success": False, "error": str(e)}
+
+    @staticmethod
+    def _group_rules_by_sources(rules: list[TaintRule]) -> list[list[TaintRule]]:
+        """把源模式相同的规则合并为一组（组内共享一次源遍历）"""
+        grouped: dict[tuple, list[TaintRule]] = {}
+        for rule in rules:
+            key = tuple(sorted(set(rule.sources)))
+            grouped.setdefault(key, []).append(rule)
+        return list(grouped.values())
+
+    async def _run_fused_group(
+        self, cpg_prefix: str, group_rules: list[TaintRule], max_flows: int
+    ) -> list[dict]:
+        """执行一组规则的融合查询
+
+        源取组内共同的源集合，汇取组内所有规则汇的并集，
+        结果中带上汇调用名（sinkCallName）供 Python 端归属。
+        """
+        source_pattern = "|".join(sorted(set(group_rules[0].sources)))
+        sink_pattern = "|".join(
+            sorted({sink for rule in group_rules for sink in rule.sinks})
+        )
+
+        query = f'''
+        {{
+          val sources = {cpg_prefix}.method.name("({source_pattern})").parameter
+          val sinks = {cpg_prefix}.call.name("({sink_pattern})").argument
+
+          sinks.reachableByFlows(sources).take({max_flows}).map {{ path =>
+            val sourceNode = path.elements.head
+            val sinkNode = path.elements.last
+            Map(
+              "sinkCallName" -> sinkNode.inCall.name.headOption.getOrElse(""),
+              "source" -> Map(
+                  "code" -> sourceNode.code,
+                  "file" -> sourceNode.file.name.headOption.getOrElse("unknown"),
+                  "line" -> sourceNode.lineNumber.getOrElse(-1)
+              ),
+              "sink" -> Map(
+                  "code" -> sinkNode.code,
+                  "file" -> sinkNode.file.name.headOption.getOrElse("unknown"),
+                  "line" -> sinkNode.lineNumber.getOrElse(-1)
+              ),
+              "pathLength" -> path.elements.size
+            )
+          }}
+        }}
+        '''
+
+        result = await self.executor.execute(query)
+
+        if not result.get("success"):
+            raise RuntimeError(result.get("stderr", "Fused query failed"))
+
+        flows = safe_parse_joern_response(result.get("stdout", ""), default=[])
+        if not isinstance(flows, list):
+            flows = [flows] if flows else []
+        return flows
+
+    @staticmethod
+    def _attribute_flows(
+        flows: list[dict], group_rules: list[TaintRule]
+    ) -> list[dict]:
+        """按汇调用名把融合查询的流归属回具体规则
+
+        一条流可能同时命中多条规则（如 exec 同时在命令注入和
+        网络数据注入的汇集合中），此时为每条命中的规则各生成一条记录。
+        """
+        attributed = []
+        for flow in flows:
+            sink_name = flow.get("sinkCallName", "") or ""
+            for rule in group_rules:
+                if any(
+                    re.fullmatch(sink_pattern, sink_name)
+                    for sink_pattern in rule.sinks
+                ):
+                    vuln = {k: v for k, v in flow.items() if k != "sinkCallName"}
+                    vuln.update(
+                        {
+                            "vulnerability": rule.name,
+                            "severity": rule.severity,
+                            "cwe_id": rule.cwe_id,
+                            "description": rule.description,
+                        }
+                    )
+                    attributed.append(vuln)
+        return attributed
+
+    async def scan_severity_tier(
+        self,
+        severity: str,
+        max_flows: int = 50,
+        project_name: str | None = None,
+    ) -> dict:
+        """
+        单查询严重级别扫描
+
+        使用启动时预编译的级别扫描块（见模块底部的 TIER_SWEEPS）：
+        该级别全部规则的源/汇集合在一条查询内对 CPG 求值，
+        CI 的"仅 CRITICAL 门禁"只需一次 REPL 往返，而不是逐规则
+        多次查询。流按 group 下标和汇调用名在 Python 端归属回规则。
+
+        Args:
+            severity: 严重程度（CRITICAL, HIGH, MEDIUM, LOW）
+            max_flows: 每个源分组的最大流数量
+            project_name: 项目名称（可选）
+
+        Returns:
+            dict: 漏洞列表和统计信息
+
+        Example:
+            >>> result = await service.scan_severity_tier("CRITICAL")
+            {
+                "success": True,
+                "severity": "CRITICAL",
+                "vulnerabilities": [...],
+                "total_count": 2,
+                "rules_checked": 3,
+                "queries": 1
+            }
+        """
+        logger.info(
+            f"Running single-query severity sweep (severity: {severity}, project: {project_name or 'current'})"
+        )
+
+        try:
+            sweep = TIER_SWEEPS.get(severity.upper())
+            if sweep is None:
+                return {
+                    "success": False,
+                    "error": f"No rules for severity: {severity}",
+                }
+
+            # 安全获取 CPG 前缀，验证项目存在性
+            cpg_prefix, error = await get_safe_cpg_prefix(self.executor, project_name)
+            if error:
+                return {"success": False, "error": error}
+
+            query = sweep.template.substitute(cpg=cpg_prefix, max_flows=max_flows)
+            result = await self.executor.execute(query)
+
+            if not result.get("success"):
+                return {"success": False, "error": result.get("stderr", "Query failed")}
+
+            flows = safe_parse_joern_response(result.get("stdout", ""), default=[])
+            if not isinstance(flows, list):
+                flows = [flows] if flows else []
+
+            all_vulnerabilities = []
+            for idx, group_rules in enumerate(sweep.groups):
+                group_flows = [
+                    {k: v for k, v in flow.items() if k != "group"}
+                    for flow in flows
+                    if flow.get("group") == idx
+                ]
+                all_vulnerabilities.extend(
+                    self._attribute_flows(group_flows, group_rules)
+                )
+
+            response = {
+                "success": True,
+                "severity": sweep.severity,
+                "vulnerabilities": all_vulnerabilities,
+                "total_count": len(all_vulnerabilities),
+                "rules_checked": sum(len(g) for g in sweep.groups),
+                "queries": 1,
+            }
+            if project_name:
+                response["project"] = project_name
+            return response
+
+        except Exception as e:
+            logger.exception(f"Error in severity tier sweep: {e}")
+            return {"success": False, "error": str(e)}
+
     async def check_specific_flow(
         self,
         source_pattern: str,
@@ -365,3 +668,64 @@ class TaintAnalysisService:
             }
         except ValueError as e:
             return {"success": False, "error": str(e)}
+
+
+def _build_tier_sweeps() -> dict[str, TierSweep]:
+    """启动时为每个严重级别预编译单查询扫描块
+
+    级别内先按源集合分组（同 scan_all_rules），每组生成一段
+    reachableByFlows 子查询，流带 group 下标和 sinkCallName 标记，
+    各组结果在 Scala 端用 ++ 拼接——整个级别只需一次 REPL 往返。
+    规则集是静态的，除 $cpg / $max_flows 外全部在导入时定型。
+    """
+    sweeps: dict[str, TierSweep] = {}
+    for severity in SEVERITY_TIERS:
+        rules = get_rules_by_severity(severity)
+        if not rules:
+            continue
+
+        groups = TaintAnalysisService._group_rules_by_sources(rules)
+        blocks = []
+        for idx, group_rules in enumerate(groups):
+            source_pattern = "|".join(sorted(set(group_rules[0].sources)))
+            sink_pattern = "|".join(
+                sorted({sink for rule in group_rules for sink in rule.sinks})
+            )
+            blocks.append(
+                f'''  val flows_{idx} = {{
+    val sources = $cpg.method.name("({source_pattern})").parameter
+    $cpg.call.name("({sink_pattern})").argument
+      .reachableByFlows(sources).take($max_flows).map {{ path =>
+      val sourceNode = path.elements.head
+      val sinkNode = path.elements.last
+      Map(
+        "group" -> {idx},
+        "sinkCallName" -> sinkNode.inCall.name.headOption.getOrElse(""),
+        "source" -> Map(
+            "code" -> sourceNode.code,
+            "file" -> sourceNode.file.name.headOption.getOrElse("unknown"),
+            "line" -> sourceNode.lineNumber.getOrElse(-1)
+        ),
+        "sink" -> Map(
+            "code" -> sinkNode.code,
+            "file" -> sinkNode.file.name.headOption.getOrElse("unknown"),
+            "line" -> sinkNode.lineNumber.getOrElse(-1)
+        ),
+        "pathLength" -> path.elements.size
+      )
+    }}
+  }}'''
+            )
+
+        concat = " ++ ".join(f"flows_{idx}" for idx in range(len(groups)))
+        body = "\n".join(blocks)
+        sweeps[severity] = TierSweep(
+            severity=severity,
+            groups=groups,
+            template=Template(f"{{\n{body}\n  {concat}\n}}"),
+        )
+    return sweeps
+
+
+# 预编译的级别扫描块（导入时生成一次）
+TIER_SWEEPS = _build_tier_sweeps()
@@ -1,7 +1,7 @@
 """批量操作MCP工具
 
 提供批量分析功能：
-- batch_query: 批量执行查询
+- batch_query: 批量执行查询（默认融合兼容查询为单次往返）
 - batch_function_analysis: 批量分析函数
 
 多项目支持：batch_function_analysis 要求指定 project_name 参数。
@@ -9,24 +9,121 @@ batch_query 执行原始查询，用户需在查询中自行指定项目前缀
 """
 
 import asyncio
+import json
 
 from loguru import logger
 
 from joern_mcp.mcp_server import mcp, server_state
 from joern_mcp.utils.project_utils import get_safe_cpg_prefix
+from joern_mcp.utils.response_parser import safe_parse_joern_response
+
+# 单个融合块的查询文本总长上限（留出余量给执行器的长度校验）
+_FUSE_CHUNK_CHARS = 6000
+
+
+def _is_fusable(query: str) -> bool:
+    """判断查询能否参与融合
+
+    融合块把每个查询作为 Map 的一个表达式条目，因此只接受
+    单表达式遍历；带语句（val/def/import）、多语句（;）或
+    自带代码块的查询走单独执行路径。
+    """
+    stripped = query.strip()
+    if not stripped or stripped.startswith("{"):
+        return False
+    if ";" in stripped:
+        return False
+    return all(kw not in stripped for kw in ("val ", "def ", "import "))
+
+
+def _build_fused_block(indexed_queries: list[tuple[int, str]]) -> str:
+    """把多个查询组合成一个返回标记 Map 的 Scala 块
+
+    每个查询在 JVM 端各自序列化为 JSON 字符串，外层 Map 一次
+    返回，Python 端按标记拆分归位。
+    """
+    entries = []
+    for index, query in indexed_queries:
+        expr = query.strip()
+        if expr.endswith(".toJson"):
+            expr = expr[: -len(".toJson")]
+        entries.append(f'"q{index}" -> ({expr}).toJson')
+
+    body = ",\n  ".join(entries)
+    return f"Map(\n  {body}\n)"
+
+
+def _chunk_for_fusion(
+    indexed_queries: list[tuple[int, str]],
+) -> list[list[tuple[int, str]]]:
+    """按总长度切分融合块，避免超出执行器的查询长度限制"""
+    chunks: list[list[tuple[int, str]]] = []
+    current: list[tuple[int, str]] = []
+    current_chars = 0
+
+    for item in indexed_queries:
+        query_chars = len(item[1])
+        if current and current_chars + query_chars > _FUSE_CHUNK_CHARS:
+            chunks.append(current)
+            current = []
+            current_chars = 0
+        current.append(item)
+        current_chars += query_chars
+
+    if current:
+        chunks.append(current)
+    return chunks
+
+
+async def _execute_fused_chunk(
+    chunk: list[tuple[int, str]], timeout: int
+) -> dict[int, str]:
+    """执行一个融合块，返回 {原始索引: 结果JSON字符串}
+
+    Raises:
+        RuntimeError: 融合块执行失败或结果无法按标记拆分
+    """
+    fused_query = _build_fused_block(chunk)
+    result = await server_state.query_executor.execute(
+        fused_query, timeout=timeout, use_cache=False
+    )
+
+    if not result.get("success"):
+        raise RuntimeError(result.get("stderr", "Fused block failed"))
+
+    parsed = safe_parse_joern_response(result.get("stdout", ""), default=None)
+    if not isinstance(parsed, dict):
+        raise RuntimeError("Fused block result is not a tagged map")
+
+    outputs: dict[int, str] = {}
+    for index, _ in chunk:
+        tag = f"q{index}"
+        if tag not in parsed:
+            raise RuntimeError(f"Fused block result missing tag: {tag}")
+        value = parsed[tag]
+        # 与单独执行保持一致：result 始终是 JSON 字符串
+        outputs[index] = (
+            value if isinstance(value, str) else json.dumps(value, ensure_ascii=False)
+        )
+    return outputs
 
 
 @mcp.tool()
-async def batch_query(queries: list[str], timeout: int = 300) -> dict:
+async def batch_query(queries: list[str], timeout: int = 300, fuse: bool = True) -> dict:
     """
     批量执行多个查询
 
+    默认把兼容的单表达式查询融合为一个 Scala 块（一次往返、
+    一次 REPL 编译），失败时自动回退为逐条执行；带语句的
+    复杂查询始终并发逐条执行。
+
     Args:
         queries: 查询列表（Scala查询语句）
         timeout: 每个查询的超时时间（秒）
+        fuse: 是否启用融合执行（默认True）
 
     Returns:
-        dict: 批量查询结果
+        dict: 批量查询结果，fused 为融合执行的查询数
 
     Example:
         >>> await batch_query([
@@ -38,7 +135,8 @@ async def batch_query(queries: list[str], timeout: int = 300) -> dict:
             "results": [...],
             "total": 2,
             "succeeded": 2,
-            "failed": 0
+            "failed": 0,
+            "fused": 2
         }
 
     Note:
@@ -52,52 +150,75 @@ async def batch_query(queries: list[str], timeout: int = 300) -> dict:
     if len(queries) > 20:
         return {"success": False, "error": "Maximum 20 queries allowed in batch"}
 
-    logger.info(f"Executing batch query with {len(queries)} queries")
+    logger.info(f"Executing batch query with {len(queries)} queries (fuse: {fuse})")
 
-    results = []
-    succeeded = 0
-    failed = 0
+    results_by_index: dict[int, dict] = {}
+    fused_count = 0
 
     try:
-        # 并发执行所有查询
+        fusable = [
+            (i, q) for i, q in enumerate(queries) if fuse and _is_fusable(q)
+        ]
+        singles = [(i, q) for i, q in enumerate(queries) if (i, q) not in fusable]
+
+        # 单条融合没有收益，并入逐条执行
+        if len(fusable) < 2:
+            singles.extend(fusable)
+            fusable = []
+
+        for chunk in _chunk_for_fusion(fusable):
+            try:
+                outputs = await _execute_fused_chunk(chunk, timeout)
+                for index, output in outputs.items():
+                    results_by_index[index] = {
+                        "query_index": index,
+                        "success": True,
+                        "result": output,
+                        "fused": True,
+                    }
+                fused_count += len(chunk)
+            except Exception as e:
+                # 融合块失败：回退为逐条执行，不影响结果完整性
+                logger.warning(f"Fused block failed, falling back: {e}")
+                singles.extend(chunk)
+
+        # 并发执行无法融合（或回退）的查询
         tasks = [
             server_state.query_executor.execute(query, timeout=timeout)
-            for query in queries
+            for _, query in singles
         ]
-
         query_results = await asyncio.gather(*tasks, return_exceptions=True)
 
-        for i, result in enumerate(query_results):
+        for (index, _), result in zip(singles, query_results):
             if isinstance(result, Exception):
-                results.append(
-                    {"query_index": i, "success": False, "error": str(result)}
-                )
-                failed += 1
+                results_by_index[index] = {
+                    "query_index": index,
+                    "success": False,
+                    "error": str(result),
+                }
             elif result.get("success"):
-                results.append(
-                    {
-                        "query_index": i,
-                        "success": True,
-                        "result": result.get("stdout", ""),
-                    }
-                )
-                succeeded += 1
+                results_by_index[index] = {
+                    "query_index": index,
+                    "success": True,
+                    "result": result.get("stdout", ""),
+                }
             else:
-                results.append(
-                    {
-                        "query_index": i,
-                        "success": False,
-                        "error": result.get("stderr", "Unknown error"),
-                    }
-                )
-                failed += 1
+                results_by_index[index] = {
+                    "query_index": index,
+                    "success": False,
+                    "error": result.get("stderr", "Unknown error"),
+                }
+
+        results = [results_by_index[i] for i in range(len(queries))]
+        succeeded = sum(1 for r in results if r["success"])
 
         return {
             "success": True,
             "results": results,
             "total": len(queries),
             "succeeded": succeeded,
-            "failed": failed,
+            "failed": len(queries) - succeeded,
+            "fused": fused_count,
         }
 
     except Exception as e:
@@ -5,6 +5,7 @@
 - get_callees: 获取函数调用的其他函数
 - get_call_chain: 获取函数的调用链
 - get_call_graph: 获取完整调用图
+- build_call_graph_index: 构建进程内调用图索引（加速后续查询）
 
 多项目支持：所有工具要求指定 project_name 参数。
 """
@@ -190,3 +191,43 @@ async def get_call_graph(
     return await service.get_call_graph(
         function_name, include_callers, include_callees, depth, project_name
     )
+
+
+@mcp.tool()
+async def build_call_graph_index(
+    project_name: str, max_edges: int = 200000, force: bool = False
+) -> dict:
+    """
+    构建进程内调用图索引
+
+    一次批量抽取项目的完整调用边列表到本地邻接索引。之后
+    get_callers / get_callees / get_call_chain / get_call_graph
+    全部由索引以微秒级回答，不再逐层往返 Joern。
+    索引在项目重新导入（parse_project）后自动失效。
+
+    Args:
+        project_name: 项目名称（必填，使用 list_projects 查看可用项目）
+        max_edges: 批量抽取的边数上限（默认200000）
+        force: 强制重建已有索引（默认False）
+
+    Returns:
+        dict: 索引统计
+
+    Example:
+        >>> await build_call_graph_index("webapp")
+        {
+            "success": true,
+            "project": "webapp",
+            "edge_count": 15230,
+            "caller_count": 842,
+            "callee_count": 1267
+        }
+    """
+    if not server_state.query_executor:
+        return {"success": False, "error": "Query executor not initialized"}
+
+    if max_edges < 1:
+        return {"success": False, "error": "max_edges must be positive"}
+
+    service = CallGraphService(server_state.query_executor)
+    return await service.build_index(project_name, max_edges=max_edges, force=force)
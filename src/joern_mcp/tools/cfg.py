@@ -8,41 +8,13 @@
 多项目支持：所有工具要求指定 project_name 参数。
 """
 
-import re
-
 from loguru import logger
 
 from joern_mcp.mcp_server import mcp, server_state
+from joern_mcp.utils.dot_transfer import fetch_dot
 from joern_mcp.utils.project_utils import get_safe_cpg_prefix
 
 
-def _clean_dot_string(stdout: str) -> str:
-    """清理 DOT 格式字符串
-
-    处理 Joern 返回的 DOT 字符串，移除多余的引号和转义字符。
-    """
-    result = stdout.strip()
-
-    # 移除 Scala REPL 输出前缀（如 "val res0: String = "）
-    if result.startswith("val "):
-        match = re.search(r"=\s*(.+)", result, re.DOTALL)
-        if match:
-            result = match.group(1).strip()
-
-    # 移除多层首尾双引号 (如 '""digraph...""')
-    while result.startswith('""') and result.endswith('""') and len(result) > 4:
-        result = result[2:-2]
-
-    # 移除单层首尾引号
-    if result.startswith('"') and result.endswith('"') and len(result) > 2:
-        result = result[1:-1]
-
-    # 处理转义字符
-    result = result.replace("\\n", "\n").replace("\\t", "\t").replace('\\"', '"')
-
-    return result
-
-
 @mcp.tool()
 async def get_control_flow_graph(
     project_name: str, function_name: str, format: str = "dot"
@@ -67,6 +39,10 @@ async def get_control_flow_graph(
             "cfg": "digraph CFG { ... }",
             "format": "dot"
         }
+
+    Note:
+        dot 格式经文件通道传输；超过 dot_inline_max_bytes 的大图
+        不内联返回，改为在 cfg_file 字段给出共享文件系统上的路径。
     """
     if not server_state.query_executor:
         return {"success": False, "error": "Query executor not initialized"}
@@ -83,8 +59,26 @@ async def get_control_flow_graph(
 
         # 构建查询
         if format == "dot":
-            # dotCfg 返回 List[String]，使用 headOption.getOrElse("") 安全获取
+            # dotCfg 返回 List[String]，使用 headOption.getOrElse("") 安全获取；
+            # 经文件通道取回（大图零 REPL 序列化，无需清洗）
             query = f'{cpg_prefix}.method.name("{function_name}").dotCfg.headOption.getOrElse("")'
+            transfer = await fetch_dot(server_state.query_executor, query)
+            if not transfer.get("success"):
+                return {"success": False, "error": transfer.get("error", "Query failed")}
+
+            response = {
+                "success": True,
+                "project": project_name,
+                "function": function_name,
+                "cfg": transfer.get("dot"),
+                "format": format,
+                "transfer": transfer["transfer"],
+                "size_bytes": transfer.get("size_bytes"),
+            }
+            if transfer.get("dot_file"):
+                # 超过内联上限：返回共享文件系统上的路径，由调用方自取
+                response["cfg_file"] = transfer["dot_file"]
+            return response
         else:
             # JSON 格式：返回控制结构信息
             query = f'''
@@ -97,18 +91,15 @@ async def get_control_flow_graph(
                ))
             '''
 
-        # 执行查询
+        # 执行查询（JSON 分支）
         result = await server_state.query_executor.execute(query, format="raw")
 
         if result.get("success"):
-            stdout = result.get("stdout", "")
-            cfg = _clean_dot_string(stdout) if format == "dot" else stdout
-
             return {
                 "success": True,
                 "project": project_name,
                 "function": function_name,
-                "cfg": cfg,
+                "cfg": result.get("stdout", ""),
                 "format": format,
             }
         else:
@@ -163,8 +154,31 @@ async def get_dominators(
 
         if format == "dot":
             # 使用 dotCdg（控制依赖图）替代 dotDom（支配树）
-            # dotCdg 在大多数 Joern 版本中都可用
+            # dotCdg 在大多数 Joern 版本中都可用；经文件通道取回
             query = f'{cpg_prefix}.method.name("{function_name}").dotCdg.headOption.getOrElse("")'
+            transfer = await fetch_dot(server_state.query_executor, query)
+            if not transfer.get("success"):
+                stderr = transfer.get("error", "Query failed")
+                if "not a member" in stderr:
+                    return {
+                        "success": False,
+                        "error": "Control dependency graph not available. Try using get_control_flow_graph instead.",
+                    }
+                return {"success": False, "error": stderr}
+
+            response = {
+                "success": True,
+                "project": project_name,
+                "function": function_name,
+                "dominators": transfer.get("dot"),
+                "format": format,
+                "transfer": transfer["transfer"],
+                "size_bytes": transfer.get("size_bytes"),
+                "note": "This returns Control Dependency Graph (CDG) for better compatibility",
+            }
+            if transfer.get("dot_file"):
+                response["dominators_file"] = transfer["dot_file"]
+            return response
         else:
             # JSON 格式：返回控制依赖关系
             query = f'''
@@ -181,14 +195,11 @@ async def get_dominators(
         result = await server_state.query_executor.execute(query, format="raw")
 
         if result.get("success"):
-            stdout = result.get("stdout", "")
-            dominators = _clean_dot_string(stdout) if format == "dot" else stdout
-
             return {
                 "success": True,
                 "project": project_name,
                 "function": function_name,
-                "dominators": dominators,
+                "dominators": result.get("stdout", ""),
                 "format": format,
                 "note": "This returns Control Dependency Graph (CDG) for better compatibility",
             }
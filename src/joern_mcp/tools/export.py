@@ -3,22 +3,34 @@
 提供分析结果导出功能：
 - export_cpg: 导出 CPG 到文件
 - export_analysis_results: 导出分析结果
+- export_query_results: 流式导出查询结果（分页拉取、增量写出）
 
 Note:
     export_cpg 会导出当前活动项目的 CPG。
     如需导出特定项目，请先使用 switch_project 切换到该项目。
 """
 
+import json
 from pathlib import Path
 from typing import Any
 
 from loguru import logger
 
 from joern_mcp.mcp_server import mcp, server_state
+from joern_mcp.utils.pagination import apply_page_window
+from joern_mcp.utils.project_utils import get_safe_cpg_prefix
+from joern_mcp.utils.response_parser import safe_parse_joern_response
+from joern_mcp.utils.source_hash import compute_source_hashes
+from joern_mcp.utils.streaming_export import StreamingExportWriter
 
 
 @mcp.tool()
-async def export_cpg(project_name: str, output_path: str, format: str = "bin") -> dict:
+async def export_cpg(
+    project_name: str,
+    output_path: str,
+    format: str = "bin",
+    source_path: str | None = None,
+) -> dict:
     """
     导出CPG到文件
 
@@ -26,6 +38,9 @@ async def export_cpg(project_name: str, output_path: str, format: str = "bin") -
         project_name: 项目名称（用于记录，实际导出当前活动项目的 CPG）
         output_path: 输出文件路径
         format: 导出格式 ("bin", "json", "dot")
+        source_path: 对应的源码路径（可选，仅 bin 格式有效）。
+                     提供时在 cpg.bin 旁写入哈希 sidecar，
+                     供 parse_project / load_cpg 做精确的新鲜度检查
 
     Returns:
         dict: 导出结果
@@ -66,13 +81,24 @@ async def export_cpg(project_name: str, output_path: str, format: str = "bin") -
         result = await server_state.query_executor.execute(query)
 
         if result.get("success"):
-            return {
+            response = {
                 "success": True,
                 "project": project_name,
                 "output_path": str(output_file),
                 "format": format,
                 "message": "CPG exported successfully",
             }
+            if format == "bin" and source_path and Path(source_path).exists():
+                # 写入哈希 sidecar，使导出的 cpg.bin 可做精确新鲜度检查
+                sidecar = output_file.with_name(output_file.name + ".hashes.json")
+                sidecar.write_text(
+                    json.dumps(
+                        compute_source_hashes(str(Path(source_path).absolute()))
+                    ),
+                    encoding="utf-8",
+                )
+                response["hashes_sidecar"] = str(sidecar)
+            return response
         else:
             return {"success": False, "error": result.get("stderr", "Export failed")}
 
@@ -83,7 +109,10 @@ async def export_cpg(project_name: str, output_path: str, format: str = "bin") -
 
 @mcp.tool()
 async def export_analysis_results(
-    results: dict[str, Any], output_path: str, format: str = "json"
+    results: dict[str, Any],
+    output_path: str,
+    format: str = "json",
+    compress: bool = False,
 ) -> dict:
     """
     导出分析结果到文件
@@ -91,7 +120,10 @@ async def export_analysis_results(
     Args:
         results: 分析结果数据
         output_path: 输出文件路径
-        format: 导出格式 ("json", "markdown", "csv")
+        format: 导出格式 ("json", "markdown", "csv", "ndjson")；
+                ndjson 逐条增量写出 vulnerabilities（每条一行），
+                不构建完整序列化字符串
+        compress: 是否 gzip 压缩输出（仅 ndjson，路径自动加 .gz）
 
     Returns:
         dict: 导出结果
@@ -131,6 +163,20 @@ async def export_analysis_results(
             csv_content = _format_as_csv(results)
             output_file.write_text(csv_content, encoding="utf-8")
 
+        elif format == "ndjson":
+            # NDJSON格式：逐条写出，不构建完整序列化字符串
+            rows = results.get("vulnerabilities")
+            if rows is None:
+                rows = [results]
+            writer = StreamingExportWriter(
+                output_file, format="ndjson", compress=compress
+            )
+            try:
+                writer.write_rows(rows)
+            finally:
+                writer.close()
+            output_file = writer.path
+
         else:
             return {"success": False, "error": f"Unsupported format: {format}"}
 
@@ -146,6 +192,123 @@ async def export_analysis_results(
         return {"success": False, "error": str(e)}
 
 
+@mcp.tool()
+async def export_query_results(
+    project_name: str,
+    query: str,
+    output_path: str,
+    format: str = "ndjson",
+    page_size: int = 1000,
+    compress: bool = False,
+) -> dict:
+    """
+    流式导出查询结果到文件
+
+    与 export_analysis_results 不同，结果不经过客户端：分页窗口
+    下推到 CPGQL 遍历（同 execute_query_paged），每页落盘后即释放，
+    内存占用由 page_size 决定、与结果总量无关——几十万条发现的
+    全工作区污点导出也不会撑爆 MCP 进程。
+
+    Args:
+        project_name: 项目名称（必填，使用 list_projects 查看可用项目）
+        query: Joern 查询字符串（CPGQL 语法，须返回集合）
+        output_path: 输出文件路径
+        format: 输出格式 ("ndjson", "csv")；CSV 列集取自第一条记录
+        page_size: 每页拉取条数（1-1000，同时是内存占用上界）
+        compress: 是否 gzip 在线压缩输出（路径自动加 .gz）
+
+    Returns:
+        dict: 导出结果（行数、页数、输出路径、文件大小）
+
+    Example:
+        >>> await export_query_results(
+        ...     "webapp",
+        ...     "cpg.call.name(\\"system\\").map(c => Map(\\"code\\" -> c.code))",
+        ...     "/tmp/calls.ndjson",
+        ...     compress=True,
+        ... )
+        {
+            "success": True,
+            "output_path": "/tmp/calls.ndjson.gz",
+            "rows": 240000,
+            "pages": 240
+        }
+    """
+    if not server_state.query_executor:
+        return {"success": False, "error": "Query executor not initialized"}
+
+    page_size = max(1, min(page_size, 1000))
+    logger.info(
+        f"Streaming query export to {output_path} "
+        f"(project: {project_name}, format: {format}, page_size: {page_size})"
+    )
+
+    try:
+        # 安全获取 CPG 前缀，验证项目存在性
+        cpg_prefix, error = await get_safe_cpg_prefix(
+            server_state.query_executor, project_name
+        )
+        if error:
+            return {"success": False, "error": error}
+
+        processed_query = query.replace("cpg.", f"{cpg_prefix}.")
+
+        try:
+            writer = StreamingExportWriter(output_path, format=format, compress=compress)
+        except ValueError as e:
+            return {"success": False, "error": str(e)}
+
+        offset = 0
+        pages = 0
+        try:
+            while True:
+                # 多取 1 条用于判断是否还有下一页；
+                # 页结果不进缓存（一次性扫描会冲掉有复用价值的条目）
+                paged_query = apply_page_window(
+                    processed_query, offset, page_size + 1
+                )
+                result = await server_state.query_executor.execute(
+                    paged_query, use_cache=False
+                )
+
+                if not result.get("success"):
+                    stderr = result.get("stderr", "Query failed")
+                    logger.error(f"Streaming export page failed: {stderr}")
+                    writer.discard()
+                    return {"success": False, "error": stderr}
+
+                items = safe_parse_joern_response(result.get("stdout", ""), default=[])
+                if not isinstance(items, list):
+                    items = [items] if items else []
+
+                has_more = len(items) > page_size
+                writer.write_rows(items[:page_size])
+                pages += 1
+
+                if not has_more:
+                    break
+                offset += page_size
+        except Exception:
+            writer.discard()
+            raise
+        writer.close()
+
+        return {
+            "success": True,
+            "project": project_name,
+            "output_path": str(writer.path),
+            "format": format,
+            "compressed": compress,
+            "rows": writer.rows,
+            "pages": pages,
+            "size_bytes": writer.path.stat().st_size,
+        }
+
+    except Exception as e:
+        logger.exception(f"Error in streaming export: {e}")
+        return {"success": False, "error": str(e)}
+
+
 def _format_as_markdown(results: dict[str, Any]) -> str:
     """格式化为Markdown"""
     lines = ["# 代码分析报告\n"]
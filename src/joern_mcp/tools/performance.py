@@ -22,6 +22,8 @@ async def get_performance_stats() -> dict:
             - cache_hit_rate: 缓存命中率
             - success_rate: 成功率
             - current_concurrent: 当前并发数
+            - by_tool / by_project: 按工具名/项目名分维度的
+              计数、错误数与 p50/p95/p99（定位具体哪类工具回归）
     """
     try:
         if not server_state.query_executor:
@@ -36,11 +38,19 @@ async def get_performance_stats() -> dict:
         # 获取并发限制
         concurrent_limit = server_state.query_executor.get_current_concurrent_limit()
 
+        # 并发控制器状态（限制、在途数、队列深度、最近平均响应）
+        scheduler_stats = server_state.query_executor.get_scheduler_stats()
+
+        # 成本模型状态（学习到的查询形态与实测成本）
+        cost_model_stats = server_state.query_executor.get_cost_model_stats()
+
         return {
             "success": True,
             "performance": stats,
             "cache": cache_stats,
             "concurrent_limit": concurrent_limit,
+            "scheduler": scheduler_stats,
+            "cost_model": cost_model_stats,
         }
 
     except Exception as e:
@@ -48,6 +58,42 @@ async def get_performance_stats() -> dict:
         return {"success": False, "error": str(e)}
 
 
+@mcp.tool()
+async def get_stage_latency() -> dict:
+    """
+    获取查询管线各阶段的耗时统计
+
+    把端到端延迟拆解到管线各阶段，P99 尖刺时用于定位时间去向：
+        - scheduler_wait: 优先级调度/并发信号量等待
+        - server_execute: 服务器往返整体（含以下子阶段）
+        - ws_connect: WebSocket 连接建立
+        - query_post: 查询 POST 提交
+        - joern_execute: Joern 侧真实执行（等待完成通知）
+        - result_get: 结果 GET 拉取
+        - response_parse: 响应 JSON 解析
+
+    Returns:
+        dict: 每个阶段的 count/total/avg/p50/p95/p99
+    """
+    try:
+        if not server_state.query_executor:
+            return {"error": "Query executor not initialized"}
+
+        from joern_mcp.utils.performance import get_metrics
+
+        stages = get_metrics().get_stage_stats()
+
+        return {
+            "success": True,
+            "stages": stages,
+            "stage_count": len(stages),
+        }
+
+    except Exception as e:
+        logger.exception(f"Error getting stage latency: {e}")
+        return {"success": False, "error": str(e)}
+
+
 @mcp.tool()
 async def get_cache_stats() -> dict:
     """
@@ -2,6 +2,8 @@
 
 提供 CPG 项目管理功能：
 - parse_project: 解析代码生成 CPG
+- parse_projects: 批量提交解析任务（并行执行）
+- parse_status: 查询解析队列任务状态
 - list_projects: 列出已解析的项目
 - switch_project: 切换当前活动项目
 - get_current_project: 获取当前活动项目
@@ -15,13 +17,42 @@
 所有与 Joern Server 的交互都通过异步 HTTP+WebSocket 方式进行。
 """
 
+import json
 import re
 from pathlib import Path
 
 from loguru import logger
 
 from joern_mcp.mcp_server import mcp, server_state
+from joern_mcp.utils.cpg_generation import bump_generation
+from joern_mcp.utils.parse_queue import get_parse_queue
 from joern_mcp.utils.response_parser import safe_parse_joern_response
+from joern_mcp.utils.source_hash import (
+    compute_source_hashes,
+    delete_snapshot,
+    diff_snapshots,
+    load_snapshot,
+    newest_source_mtime,
+    save_snapshot,
+)
+
+
+async def _project_in_workspace(project_name: str) -> bool:
+    """检查项目是否仍在 workspace 中
+
+    增量导入复用已有 CPG 前的防线：快照只证明源码未变化，
+    不证明 CPG 还存在（项目可能已被删除而快照残留）。
+    """
+    try:
+        result = await server_state.joern_server.execute_query_async(
+            f'workspace.project("{project_name}").isDefined'
+        )
+        if not result.get("success"):
+            return False
+        return "true" in result.get("stdout", "").lower()
+    except Exception as e:
+        logger.debug(f"Workspace check failed for {project_name}: {e}")
+        return False
 
 
 def _parse_int_from_output(stdout: str) -> int:
@@ -62,9 +93,60 @@ def _parse_int_from_output(stdout: str) -> int:
     return 0
 
 
+# 增量模式下变化文件占比超过此阈值时直接走全量导入
+_INCREMENTAL_FALLBACK_RATIO = 0.3
+
+# 预构建 CPG 的哈希 sidecar 文件后缀（export_cpg 导出时写入）
+_CPG_HASHES_SUFFIX = ".hashes.json"
+
+
+def _find_prebuilt_cpg(source_path: Path) -> Path | None:
+    """查找源码树旁的预构建 cpg.bin
+
+    候选位置：源码目录内的 cpg.bin，或同级的 <目录名>.cpg.bin。
+    """
+    candidates = [
+        source_path / "cpg.bin",
+        source_path.parent / f"{source_path.name}.cpg.bin",
+    ]
+    for candidate in candidates:
+        if candidate.is_file():
+            return candidate
+    return None
+
+
+def _cpg_bin_is_fresh(
+    cpg_file: Path, source_path: Path, current_hashes: dict[str, str]
+) -> bool:
+    """检查预构建 CPG 是否仍与源码一致
+
+    优先使用导出时写入的哈希 sidecar（精确到文件内容）；
+    无 sidecar 时退化为 mtime 比较（cpg.bin 晚于所有源码文件）。
+    """
+    sidecar = cpg_file.with_name(cpg_file.name + _CPG_HASHES_SUFFIX)
+    if sidecar.is_file():
+        try:
+            recorded = json.loads(sidecar.read_text(encoding="utf-8"))
+            return recorded == current_hashes
+        except (json.JSONDecodeError, OSError) as e:
+            logger.warning(f"Failed to read CPG hash sidecar {sidecar}: {e}")
+            return False
+
+    try:
+        cpg_mtime = cpg_file.stat().st_mtime
+        newest_source = newest_source_mtime(str(source_path))
+        return cpg_mtime >= newest_source
+    except OSError:
+        return False
+
+
 @mcp.tool()
 async def parse_project(
-    source_path: str, project_name: str | None = None, language: str = "auto"
+    source_path: str,
+    project_name: str | None = None,
+    language: str = "auto",
+    incremental: bool = False,
+    use_cpg_bin: bool = True,
 ) -> dict:
     """
     解析代码项目生成CPG
@@ -73,6 +155,13 @@ async def parse_project(
         source_path: 源代码路径（绝对路径或相对路径）
         project_name: 项目名称（可选，默认使用目录名）
         language: 编程语言 (auto, c, java, javascript, python, kotlin)
+        incremental: 增量模式。对比上次导入的逐文件内容哈希：
+                     无变化时直接复用已有 CPG（秒级返回），
+                     有变化时重新导入并报告变化的文件子集；
+                     变化比例过大或无历史快照时自动回退全量导入
+        use_cpg_bin: 检测源码树旁的预构建 cpg.bin（CI 导出产物），
+                     未过期时直接 importCpg 加载（秒级），
+                     跳过语言前端重新解析；过期或缺失时照常解析
 
     Returns:
         dict: 解析结果，包含项目ID和状态
@@ -85,10 +174,27 @@ async def parse_project(
             "message": "Project parsed successfully"
         }
     """
+    return await _parse_project_impl(
+        source_path, project_name, language, incremental, use_cpg_bin
+    )
+
+
+async def _parse_project_impl(
+    source_path: str,
+    project_name: str | None = None,
+    language: str = "auto",
+    incremental: bool = False,
+    use_cpg_bin: bool = True,
+) -> dict:
+    """parse_project 的实际实现
+
+    独立成普通协程以便 parse_projects 的任务队列复用
+    （MCP 工具装饰器包装后不适合直接相互调用）。
+    """
     if not server_state.joern_server:
         return {"success": False, "error": "Joern server not initialized"}
 
-    logger.info(f"Parsing project: {source_path}")
+    logger.info(f"Parsing project: {source_path} (incremental: {incremental})")
 
     # 验证路径
     path = Path(source_path)
@@ -100,21 +206,119 @@ async def parse_project(
         project_name = path.name
 
     try:
+        # 计算当前源码哈希（增量判断 + 导入成功后保存快照）
+        current_hashes = compute_source_hashes(str(path.absolute()))
+        changes = None
+
+        if incremental:
+            previous_hashes = load_snapshot(project_name)
+
+            if previous_hashes is None:
+                logger.info(
+                    f"No previous snapshot for {project_name}, "
+                    f"falling back to full import"
+                )
+            else:
+                changes = diff_snapshots(previous_hashes, current_hashes)
+                changed_count = (
+                    len(changes["added"])
+                    + len(changes["removed"])
+                    + len(changes["modified"])
+                )
+
+                if changed_count == 0 and await _project_in_workspace(project_name):
+                    # 源码未变化且项目仍在 workspace 中：
+                    # 复用已有 CPG，完全跳过导入。
+                    # workspace 检查防止快照残留（如外部删除了项目）
+                    # 时误报复用一个不存在的 CPG
+                    logger.info(
+                        f"Project {project_name} is up to date, reusing existing CPG"
+                    )
+                    return {
+                        "success": True,
+                        "project_name": project_name,
+                        "source_path": str(path.absolute()),
+                        "language": language,
+                        "incremental": True,
+                        "reused_existing_cpg": True,
+                        "message": "Source unchanged, existing CPG reused",
+                    }
+
+                if changed_count == 0:
+                    logger.info(
+                        f"Snapshot for {project_name} is current but project "
+                        f"is not in workspace, running full import"
+                    )
+                    changes = None
+                else:
+                    ratio = changed_count / max(len(current_hashes), 1)
+                    if ratio > _INCREMENTAL_FALLBACK_RATIO:
+                        logger.info(
+                            f"Change ratio {ratio:.0%} exceeds threshold, "
+                            f"running full import"
+                        )
+                    else:
+                        logger.info(
+                            f"Incremental re-parse: {changed_count} file(s) changed"
+                        )
+
+        # 快路径：加载未过期的预构建 cpg.bin（importCpg 秒级 vs 重新解析分钟级）
+        loaded_from_cpg_bin = False
+        result = None
+        if use_cpg_bin:
+            cpg_file = _find_prebuilt_cpg(path.absolute())
+            if cpg_file is not None and _cpg_bin_is_fresh(
+                cpg_file, path.absolute(), current_hashes
+            ):
+                logger.info(f"Loading prebuilt CPG: {cpg_file}")
+                result = await server_state.joern_server.import_cpg(
+                    str(cpg_file), project_name
+                )
+                if result.get("success"):
+                    loaded_from_cpg_bin = True
+                else:
+                    # 加载失败（损坏/版本不兼容等）回退到重新解析
+                    logger.warning(
+                        f"Prebuilt CPG load failed, falling back to full parse: "
+                        f"{result.get('stderr')}"
+                    )
+                    result = None
+            elif cpg_file is not None:
+                logger.info(f"Prebuilt CPG is stale, re-parsing: {cpg_file}")
+
         # 导入代码（使用异步方法）
-        result = await server_state.joern_server.import_code(
-            str(path.absolute()), project_name
-        )
+        # 注意：Joern 的 importCode 不支持真正的部分导入，
+        # 变化的子集仍需完整重新导入；增量模式的收益来自
+        # "未变化时跳过导入"这一最常见的 CI 场景
+        if result is None:
+            result = await server_state.joern_server.import_code(
+                str(path.absolute()), project_name
+            )
 
         if result.get("success"):
             logger.info(f"Project {project_name} parsed successfully")
-            return {
+            # 递增 CPG 代数，使该项目的旧查询缓存条目失效
+            bump_generation(project_name)
+            # 保存快照供下次增量判断
+            save_snapshot(project_name, current_hashes)
+            response = {
                 "success": True,
                 "project_name": project_name,
                 "source_path": str(path.absolute()),
                 "language": language,
-                "message": "Project parsed successfully",
+                "message": (
+                    "Prebuilt CPG loaded successfully"
+                    if loaded_from_cpg_bin
+                    else "Project parsed successfully"
+                ),
                 "output": result.get("stdout", ""),
             }
+            if loaded_from_cpg_bin:
+                response["loaded_from_cpg_bin"] = True
+            if changes is not None:
+                response["incremental"] = True
+                response["changed_files"] = changes
+            return response
         else:
             logger.error(f"Failed to parse project: {result.get('stderr')}")
             return {"success": False, "error": result.get("stderr", "Unknown error")}
@@ -124,6 +328,197 @@ async def parse_project(
         return {"success": False, "error": str(e)}
 
 
+@mcp.tool()
+async def load_cpg(
+    cpg_path: str,
+    project_name: str | None = None,
+    source_path: str | None = None,
+) -> dict:
+    """
+    直接加载预构建的 CPG 文件（跳过源码解析）
+
+    适用于 CI 流水线提前用 export_cpg / joern-parse 导出 cpg.bin、
+    分析端只需加载的场景：importCpg 通常是秒级，
+    而重新解析大项目可能需要数分钟。
+
+    Args:
+        cpg_path: CPG 文件路径（通常是 cpg.bin）
+        project_name: 项目名称（可选，默认使用文件名去掉扩展名）
+        source_path: 对应的源码路径（可选）。提供时会记录源码哈希快照，
+                     使后续 parse_project 的增量模式和新鲜度检查可用
+
+    Returns:
+        dict: 加载结果
+
+    Example:
+        >>> await load_cpg("/ci/artifacts/cpg.bin", "my-app")
+        {"success": True, "project_name": "my-app", "message": "CPG loaded successfully"}
+    """
+    if not server_state.joern_server:
+        return {"success": False, "error": "Joern server not initialized"}
+
+    cpg_file = Path(cpg_path)
+    if not cpg_file.is_file():
+        return {"success": False, "error": f"CPG file does not exist: {cpg_path}"}
+
+    if not project_name:
+        project_name = cpg_file.stem
+
+    logger.info(f"Loading CPG {cpg_file} as project {project_name}")
+
+    try:
+        result = await server_state.joern_server.import_cpg(
+            str(cpg_file.absolute()), project_name
+        )
+
+        if result.get("success"):
+            logger.info(f"CPG loaded successfully: {project_name}")
+            # 递增 CPG 代数，使该项目的旧查询缓存条目失效
+            bump_generation(project_name)
+            if source_path and Path(source_path).exists():
+                # 记录源码快照，后续 parse_project 增量判断可复用
+                save_snapshot(
+                    project_name,
+                    compute_source_hashes(str(Path(source_path).absolute())),
+                )
+            return {
+                "success": True,
+                "project_name": project_name,
+                "cpg_path": str(cpg_file.absolute()),
+                "message": "CPG loaded successfully",
+                "output": result.get("stdout", ""),
+            }
+        else:
+            logger.error(f"Failed to load CPG: {result.get('stderr')}")
+            return {"success": False, "error": result.get("stderr", "Unknown error")}
+
+    except Exception as e:
+        logger.exception(f"Error loading CPG: {e}")
+        return {"success": False, "error": str(e)}
+
+
+@mcp.tool()
+async def parse_projects(
+    source_paths: list[str],
+    language: str = "auto",
+    incremental: bool = False,
+    use_cpg_bin: bool = True,
+) -> dict:
+    """
+    批量提交项目解析任务（并行执行，立即返回）
+
+    与 parse_project 逐个阻塞等待不同，此工具把多个源码树
+    提交到解析队列后立即返回 job_id 列表；导入在
+    parse_queue_parallelism 限制的并行度内并发执行
+    （项目间解析互不依赖）。用 parse_status 轮询进度。
+
+    Args:
+        source_paths: 源代码路径列表（项目名取各目录名）
+        language: 编程语言 (auto, c, java, javascript, python, kotlin)
+        incremental: 增量模式（语义同 parse_project）
+        use_cpg_bin: 检测并加载未过期的预构建 cpg.bin（语义同 parse_project）
+
+    Returns:
+        dict: 已提交的任务列表（job_id + 项目名），含路径不存在的拒绝项
+
+    Example:
+        >>> await parse_projects(["/repos/app-a", "/repos/app-b"])
+        {
+            "success": True,
+            "jobs": [
+                {"job_id": "a1b2c3d4e5f6", "project_name": "app-a", ...},
+                {"job_id": "f6e5d4c3b2a1", "project_name": "app-b", ...}
+            ],
+            "submitted": 2
+        }
+    """
+    if not server_state.joern_server:
+        return {"success": False, "error": "Joern server not initialized"}
+
+    if not source_paths:
+        return {"success": False, "error": "No source paths provided"}
+
+    queue = get_parse_queue()
+    jobs = []
+    rejected = []
+
+    for source_path in source_paths:
+        path = Path(source_path)
+        if not path.exists():
+            rejected.append(
+                {"source_path": source_path, "error": "Path does not exist"}
+            )
+            continue
+
+        project_name = path.name
+
+        def runner(sp=source_path, pn=project_name):
+            return _parse_project_impl(
+                sp, pn, language, incremental, use_cpg_bin
+            )
+
+        job_id = queue.submit(source_path, project_name, runner)
+        jobs.append(
+            {
+                "job_id": job_id,
+                "project_name": project_name,
+                "source_path": source_path,
+            }
+        )
+
+    return {
+        "success": True,
+        "jobs": jobs,
+        "submitted": len(jobs),
+        "rejected": rejected if rejected else None,
+        "message": f"{len(jobs)} parse job(s) submitted, "
+        f"poll parse_status for progress",
+    }
+
+
+@mcp.tool()
+async def parse_status(job_id: str | None = None) -> dict:
+    """
+    查询解析队列任务状态
+
+    Args:
+        job_id: 任务 ID（parse_projects 返回）。不指定时返回
+                全部任务列表和队列整体进度
+
+    Returns:
+        dict: 单任务详情（含解析结果），或全队列状态概览
+
+    Example:
+        >>> await parse_status()
+        {
+            "success": True,
+            "summary": {"total": 14, "done": 9, "in_progress": 5, ...},
+            "jobs": [{"job_id": "...", "state": "completed", ...}, ...]
+        }
+
+        >>> await parse_status("a1b2c3d4e5f6")
+        {"success": True, "job": {"state": "running", "duration": 42.3, ...}}
+    """
+    try:
+        queue = get_parse_queue()
+
+        if job_id is not None:
+            job = queue.get_job(job_id)
+            if job is None:
+                return {"success": False, "error": f"Unknown job: {job_id}"}
+            return {"success": True, "job": job.to_dict(include_result=True)}
+
+        return {
+            "success": True,
+            "summary": queue.summary(),
+            "jobs": [job.to_dict() for job in queue.get_all()],
+        }
+
+    except Exception as e:
+        logger.exception(f"Error getting parse status: {e}")
+        return {"success": False, "error": str(e)}
+
+
 @mcp.tool()
 async def switch_project(project_name: str) -> dict:
     """
@@ -162,6 +557,10 @@ async def switch_project(project_name: str) -> dict:
 
         if result.get("success"):
             logger.info(f"Switched to project: {project_name}")
+            # 活动项目变化，不带项目前缀的查询缓存需要失效
+            from joern_mcp.utils.cpg_generation import CURRENT_PROJECT_KEY
+
+            bump_generation(CURRENT_PROJECT_KEY)
             return {
                 "success": True,
                 "project_name": project_name,
@@ -283,6 +682,74 @@ async def get_current_project() -> dict:
         return {"success": False, "error": str(e)}
 
 
+async def _list_projects_federated(broadcast) -> dict:
+    """联合所有分片的项目列表（分片路由部署时使用）
+
+    每个分片只看到自己 workspace 里的项目，
+    在所有分片上执行同一查询并合并结果，
+    每个项目附带其所在分片的端点。
+    """
+    root_query = 'cpg.metaData.root.headOption.getOrElse("")'
+    query = 'workspace.projects.map(p => Map("name" -> p.name, "path" -> p.inputPath))'
+
+    root_results = dict(await broadcast(root_query))
+    shard_results = await broadcast(query)
+    if not shard_results:
+        return {"success": False, "error": "No shard responded"}
+
+    projects = []
+    active_project = None
+    for endpoint, result in shard_results:
+        if not result.get("success"):
+            logger.warning(
+                f"Failed to list projects on shard {endpoint}: "
+                f"{result.get('stderr')}"
+            )
+            continue
+
+        # 该分片的当前活动 CPG 路径（用于标记 isActive）
+        current_root = ""
+        root_result = root_results.get(endpoint, {})
+        if root_result.get("success"):
+            current_root = safe_parse_joern_response(
+                root_result.get("stdout", ""), default=""
+            )
+
+        raw_projects = safe_parse_joern_response(
+            result.get("stdout", ""), default=[]
+        )
+        if not isinstance(raw_projects, list):
+            raw_projects = [raw_projects] if raw_projects else []
+
+        for p in raw_projects:
+            if not isinstance(p, dict):
+                continue
+            name = p.get("name", "")
+            input_path = p.get("path", "")
+            is_active = bool(input_path) and input_path == current_root
+            projects.append(
+                {
+                    "name": name,
+                    "inputPath": input_path,
+                    "isActive": is_active,
+                    "shard": endpoint,
+                }
+            )
+            if is_active and active_project is None:
+                active_project = name
+
+    logger.info(
+        f"Found {len(projects)} projects across {len(shard_results)} shard(s)"
+    )
+    return {
+        "success": True,
+        "projects": projects,
+        "count": len(projects),
+        "activeProject": active_project,
+        "shards": len(shard_results),
+    }
+
+
 @mcp.tool()
 async def list_projects() -> dict:
     """
@@ -319,6 +786,11 @@ async def list_projects() -> dict:
         return {"success": False, "error": "Joern server not initialized"}
 
     try:
+        # 分片路由部署时联合所有分片的 workspace
+        broadcast = getattr(server_state.joern_server, "broadcast_query", None)
+        if broadcast is not None:
+            return await _list_projects_federated(broadcast)
+
         # 首先获取当前活动 CPG 的路径
         root_query = 'cpg.metaData.root.headOption.getOrElse("")'
         root_result = await server_state.joern_server.execute_query_async(root_query)
@@ -421,6 +893,12 @@ async def delete_project(project_name: str, permanent: bool = True) -> dict:
 
         if result.get("success"):
             logger.info(f"Project {project_name} {action}")
+            # 递增代数，防止已删除项目的缓存结果被后续同名项目命中
+            bump_generation(project_name)
+            if permanent:
+                # 快照随 CPG 一并删除，防止后续增量导入
+                # 误判"源码未变化"而复用已不存在的 CPG
+                delete_snapshot(project_name)
             return {
                 "success": True,
                 "project_name": project_name,
@@ -525,6 +1003,7 @@ async def cleanup_inactive_projects(keep_active: bool = True) -> dict:
 
             if delete_result.get("success"):
                 deleted.append(name)
+                delete_snapshot(name)
                 logger.info(f"Deleted inactive project: {name}")
             else:
                 errors.append(
@@ -14,6 +14,11 @@
 from loguru import logger
 
 from joern_mcp.mcp_server import mcp, server_state
+from joern_mcp.utils.pagination import (
+    apply_page_window,
+    decode_cursor,
+    encode_cursor,
+)
 from joern_mcp.utils.project_utils import get_safe_cpg_prefix
 from joern_mcp.utils.response_parser import safe_parse_joern_response
 
@@ -345,7 +350,9 @@ async def search_code(project_name: str, pattern: str, scope: str = "all") -> di
 
 
 @mcp.tool()
-async def execute_query(project_name: str, query: str) -> dict:
+async def execute_query(
+    project_name: str, query: str, fields: list[str] | None = None
+) -> dict:
     """
     执行自定义 Joern 查询
 
@@ -354,6 +361,10 @@ async def execute_query(project_name: str, query: str) -> dict:
     Args:
         project_name: 项目名称（必填，使用 list_projects 查看可用项目）
         query: Joern 查询字符串（CPGQL 语法）
+        fields: 投影字段列表（可选）。指定后裸遍历只返回这些字段
+                （如 ["name", "filename", "lineNumber"]），方法/调用
+                列表类查询的载荷可缩小 10-50 倍；
+                已自带 .map 投影的查询不受影响
 
     Returns:
         dict: 查询结果，包含解析后的数据和原始输出
@@ -375,6 +386,14 @@ async def execute_query(project_name: str, query: str) -> dict:
             "raw_output": "[{\"name\":\"main\",\"signature\":\"int(int,char**)\"}]"
         }
 
+        >>> await execute_query("webapp", "cpg.method", fields=["name", "lineNumber"])
+        {
+            "success": true,
+            "project": "webapp",
+            "result": [{"name": "main", "lineNumber": 10}, ...],
+            "raw_output": "..."
+        }
+
     Note:
         - 查询中的 `cpg.` 会自动替换为项目特定的 CPG 前缀
         - 如果查询中已经包含项目前缀（如 `workspace.project(...)`），则不会替换
@@ -400,8 +419,10 @@ async def execute_query(project_name: str, query: str) -> dict:
 
         logger.debug(f"Processed query: {processed_query}")
 
-        # 执行查询
-        result = await server_state.query_executor.execute(processed_query)
+        # 执行查询（指定 fields 时投影下推到遍历末尾，缩小序列化载荷）
+        result = await server_state.query_executor.execute(
+            processed_query, fields=fields
+        )
 
         if result.get("success"):
             stdout = result.get("stdout", "")
@@ -433,3 +454,101 @@ async def execute_query(project_name: str, query: str) -> dict:
     except Exception as e:
         logger.exception(f"Error executing query: {e}")
         return {"success": False, "error": str(e)}
+
+
+@mcp.tool()
+async def execute_query_paged(
+    project_name: str,
+    query: str,
+    page_size: int = 100,
+    cursor: str | None = None,
+    fields: list[str] | None = None,
+) -> dict:
+    """
+    分页执行自定义 Joern 查询
+
+    把分页窗口下推到 CPGQL 遍历（.drop(n).take(m)），JVM 只序列化
+    当前页，避免大结果集（如全程序方法列表）在服务端和客户端同时
+    撑爆内存。
+
+    Args:
+        project_name: 项目名称（必填，使用 list_projects 查看可用项目）
+        query: Joern 查询字符串（CPGQL 语法，须返回集合；
+               .size/.toDot 等标量查询请使用 execute_query）
+        page_size: 每页条目数（1-1000）
+        cursor: 上一页返回的 next_cursor（首页不传）
+        fields: 投影字段列表（可选），裸遍历只返回这些字段
+                （语义同 execute_query 的 fields 参数）
+
+    Returns:
+        dict: 当前页结果。has_more 为 True 时用 next_cursor 拉取下一页
+
+    Example:
+        >>> page1 = await execute_query_paged("webapp", "cpg.method.name", page_size=50)
+        >>> page2 = await execute_query_paged(
+        ...     "webapp", "cpg.method.name", page_size=50, cursor=page1["next_cursor"]
+        ... )
+    """
+    if not server_state.query_executor:
+        return {"success": False, "error": "Query executor not initialized"}
+
+    logger.info(
+        f"Executing paged query in project: {project_name} (page_size: {page_size})"
+    )
+
+    page_size = max(1, min(page_size, 1000))
+
+    try:
+        # 游标绑定到原始查询，换查询复用游标会直接报错
+        if cursor:
+            try:
+                offset = decode_cursor(cursor, query)
+            except ValueError as e:
+                return {"success": False, "error": str(e)}
+        else:
+            offset = 0
+
+        # 安全获取 CPG 前缀，验证项目存在性
+        cpg_prefix, error = await get_safe_cpg_prefix(
+            server_state.query_executor, project_name
+        )
+        if error:
+            return {"success": False, "error": error}
+
+        processed_query = query.replace("cpg.", f"{cpg_prefix}.")
+
+        # 多取 1 条用于判断是否还有下一页
+        paged_query = apply_page_window(processed_query, offset, page_size + 1)
+        logger.debug(f"Paged query: {paged_query}")
+
+        result = await server_state.query_executor.execute(paged_query, fields=fields)
+
+        if not result.get("success"):
+            stderr = result.get("stderr", "Query failed")
+            logger.error(f"Paged query execution failed: {stderr}")
+            return {"success": False, "error": stderr}
+
+        items = safe_parse_joern_response(result.get("stdout", ""), default=[])
+        if not isinstance(items, list):
+            items = [items] if items else []
+
+        has_more = len(items) > page_size
+        items = items[:page_size]
+
+        response = {
+            "success": True,
+            "project": project_name,
+            "results": items,
+            "count": len(items),
+            "offset": offset,
+            "page_size": page_size,
+            "has_more": has_more,
+            "next_cursor": (
+                encode_cursor(offset + page_size, query) if has_more else None
+            ),
+        }
+        return response
+
+    except Exception as e:
+        logger.exception(f"Error executing paged query: {e}")
+        return {"success": False, "error": str(e)}
@@ -2,6 +2,8 @@
 
 提供安全漏洞检测功能：
 - find_vulnerabilities: 查找安全漏洞
+- scan_all_rules: 全规则融合扫描（共享源/汇遍历）
+- scan_severity_tier: 单查询严重级别扫描（预编译，适合 CI 门禁）
 - check_taint_flow: 检查自定义污点流
 - list_vulnerability_rules: 列出检测规则
 - get_rule_details: 获取规则详情
@@ -61,6 +63,107 @@ async def find_vulnerabilities(
     )
 
 
+@mcp.tool()
+async def scan_all_rules(
+    project_name: str,
+    severity: str | None = None,
+    max_flows_per_group: int = 50,
+) -> dict:
+    """
+    全规则融合污点扫描
+
+    与逐规则的 find_vulnerabilities 不同：源模式相同的规则合并为一组，
+    每组只执行一次数据流查询（汇取并集），结果归属回各条规则，
+    各组并发执行。全规则扫描的耗时由规则数降为源分组数。
+
+    Args:
+        project_name: 项目名称（必填，使用 list_projects 查看可用项目）
+        severity: 严重程度过滤（可选：CRITICAL, HIGH, MEDIUM, LOW）
+        max_flows_per_group: 每组融合查询的最大流数量（默认50，最大100）
+
+    Returns:
+        dict: 漏洞列表和统计信息，附带融合查询数量
+
+    Example:
+        >>> await scan_all_rules("webapp")
+        {
+            "success": true,
+            "project": "webapp",
+            "vulnerabilities": [...],
+            "total_count": 5,
+            "summary": {"CRITICAL": 3, "HIGH": 2, "MEDIUM": 0, "LOW": 0},
+            "rules_checked": 6,
+            "fused_queries": 3
+        }
+    """
+    if not server_state.query_executor:
+        return {"success": False, "error": "Query executor not initialized"}
+
+    if max_flows_per_group < 1 or max_flows_per_group > 100:
+        return {
+            "success": False,
+            "error": "Max flows per group must be between 1 and 100",
+        }
+
+    if severity and severity not in ["CRITICAL", "HIGH", "MEDIUM", "LOW"]:
+        return {
+            "success": False,
+            "error": "Severity must be one of: CRITICAL, HIGH, MEDIUM, LOW",
+        }
+
+    service = TaintAnalysisService(server_state.query_executor)
+    return await service.scan_all_rules(severity, max_flows_per_group, project_name)
+
+
+@mcp.tool()
+async def scan_severity_tier(
+    project_name: str,
+    severity: str,
+    max_flows: int = 50,
+) -> dict:
+    """
+    单查询严重级别污点扫描
+
+    使用启动时预编译的级别扫描块：该级别全部规则的源/汇集合
+    在一条查询内求值，整个级别只需一次 Joern 往返。适合 CI 中
+    "仅 CRITICAL 必须为零"这类按级别收紧的门禁检查。
+
+    Args:
+        project_name: 项目名称（必填，使用 list_projects 查看可用项目）
+        severity: 严重程度（CRITICAL, HIGH, MEDIUM, LOW）
+        max_flows: 每个源分组的最大流数量（默认50，最大100）
+
+    Returns:
+        dict: 漏洞列表和统计信息
+
+    Example:
+        >>> await scan_severity_tier("webapp", "CRITICAL")
+        {
+            "success": true,
+            "project": "webapp",
+            "severity": "CRITICAL",
+            "vulnerabilities": [...],
+            "total_count": 2,
+            "rules_checked": 3,
+            "queries": 1
+        }
+    """
+    if not server_state.query_executor:
+        return {"success": False, "error": "Query executor not initialized"}
+
+    if max_flows < 1 or max_flows > 100:
+        return {"success": False, "error": "Max flows must be between 1 and 100"}
+
+    if severity not in ["CRITICAL", "HIGH", "MEDIUM", "LOW"]:
+        return {
+            "success": False,
+            "error": "Severity must be one of: CRITICAL, HIGH, MEDIUM, LOW",
+        }
+
+    service = TaintAnalysisService(server_state.query_executor)
+    return await service.scan_severity_tier(severity, max_flows, project_name)
+
+
 @mcp.tool()
 async def check_taint_flow(
     project_name: str,
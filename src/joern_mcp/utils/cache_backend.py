@@ -0,0 +1,152 @@
+"""查询缓存 L2 后端
+
+HybridCache 的内存热/冷层（L1）之下可以挂一个共享后端（L2）。
+后端接口是鸭子类型的，与 PersistentCache 保持一致：
+    get(key) / set(key, value) / clear() / close() / get_stats()
+
+单机部署用 SQLite（PersistentCache），
+多实例部署用 Redis：三个实例共享一份结果缓存，
+任何一个实例算过的查询其他实例直接命中，
+避免每个实例独立预热导致的容量浪费。
+
+所有后端操作失败都降级为缓存未命中（记入 errors 统计），
+缓存后端不可用绝不能影响查询本身。
+"""
+
+import json
+import zlib
+from typing import Any
+
+from loguru import logger
+
+from joern_mcp.config import settings
+from joern_mcp.utils.performance import PersistentCache
+
+
+class RedisCacheBackend:
+    """Redis 共享缓存后端
+
+    值以 zlib 压缩的 JSON 存储（与 PersistentCache 同格式），
+    TTL 通过 Redis 原生过期实现，无需清理任务。
+    连接延迟建立，短超时保证 Redis 不可用时快速降级。
+
+    get/set 是阻塞的网络调用：异步热路径经
+    HybridCache.aget/aset 在工作线程中调用本后端
+    （redis-py 客户端线程安全），不会阻塞事件循环。
+    """
+
+    def __init__(
+        self,
+        url: str,
+        ttl: int = 604800,  # 默认7天，与 PersistentCache 一致
+        key_prefix: str = "joern_mcp:query_cache:",
+    ):
+        self.url = url
+        self.ttl = ttl
+        self.key_prefix = key_prefix
+        self._client = None
+
+        self.stats = {"hits": 0, "misses": 0, "writes": 0, "errors": 0}
+
+    def _get_client(self):
+        """获取或创建 Redis 客户端（延迟初始化）"""
+        if self._client is None:
+            import redis
+
+            self._client = redis.Redis.from_url(
+                self.url,
+                socket_timeout=2.0,
+                socket_connect_timeout=2.0,
+            )
+        return self._client
+
+    def get(self, key: str) -> Any | None:
+        """读取缓存（后端不可用视为未命中）"""
+        try:
+            blob = self._get_client().get(self.key_prefix + key)
+            if blob is None:
+                self.stats["misses"] += 1
+                return None
+
+            value = json.loads(zlib.decompress(blob).decode())
+            self.stats["hits"] += 1
+            return value
+        except Exception as e:
+            logger.debug(f"Redis cache read failed: {e}")
+            self.stats["errors"] += 1
+            return None
+
+    def set(self, key: str, value: Any) -> None:
+        """写入缓存（带 TTL）"""
+        try:
+            blob = zlib.compress(json.dumps(value).encode(), level=6)
+            self._get_client().setex(self.key_prefix + key, self.ttl, blob)
+            self.stats["writes"] += 1
+        except Exception as e:
+            logger.debug(f"Redis cache write failed: {e}")
+            self.stats["errors"] += 1
+
+    def clear(self) -> None:
+        """清空本服务的缓存键（只删除带前缀的键）"""
+        try:
+            client = self._get_client()
+            keys = list(client.scan_iter(match=f"{self.key_prefix}*", count=500))
+            if keys:
+                client.delete(*keys)
+        except Exception as e:
+            logger.warning(f"Failed to clear Redis cache: {e}")
+
+    def close(self) -> None:
+        """关闭客户端连接"""
+        if self._client is not None:
+            try:
+                self._client.close()
+            except Exception:  # noqa: S110
+                pass
+            self._client = None
+
+    def get_stats(self) -> dict:
+        """获取后端统计"""
+        size = 0
+        try:
+            size = sum(
+                1
+                for _ in self._get_client().scan_iter(
+                    match=f"{self.key_prefix}*", count=500
+                )
+            )
+        except Exception:  # noqa: S110
+            pass
+        return {**self.stats, "size": size, "backend": "redis"}
+
+
+def create_cache_backend():
+    """根据配置创建 L2 缓存后端
+
+    - query_cache_persist=False: 无 L2 后端
+    - query_cache_backend=sqlite: 单机磁盘持久层（默认）
+    - query_cache_backend=redis: 多实例共享 Redis 后端
+    """
+    if not settings.query_cache_persist:
+        return None
+
+    backend = settings.query_cache_backend.lower()
+
+    if backend == "redis":
+        logger.info(f"Using Redis cache backend: {settings.redis_url}")
+        return RedisCacheBackend(
+            url=settings.redis_url,
+            ttl=settings.query_cache_persist_ttl,
+        )
+
+    if backend == "sqlite":
+        return PersistentCache(
+            db_path=settings.joern_cpg_cache / "query_cache.db",
+            ttl=settings.query_cache_persist_ttl,
+        )
+
+    logger.warning(f"Unknown cache backend '{backend}', falling back to sqlite")
+    return PersistentCache(
+        db_path=settings.joern_cpg_cache / "query_cache.db",
+        ttl=settings.query_cache_persist_ttl,
+    )
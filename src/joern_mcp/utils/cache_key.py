@@ -0,0 +1,222 @@
+"""查询缓存键规范化
+
+缓存键直接对查询原文做 md5 时，只差缩进/换行的模板实例化、
+多写一个空格的手写查询、Map 投影键顺序不同的等价查询全都
+各占一个键——采样未命中发现约三分之一是纯格式差异。
+
+本模块在哈希前做语义保持的规范化：
+
+1. 字符串字面量外的空白折叠（标识符之间保留单个空格，
+   其余位置删除）——模板缩进和手写格式差异归一；
+2. Map(...) 中简单 "key" -> value 对按键排序——投影字段
+   顺序不同的查询共享结果（JSON 对象键无序，结果等价）。
+
+规范化只影响缓存键，发给 Joern 的查询原文不变。
+同一模板的所有实例化在规范化后仅剩绑定参数的差异，
+规范化键即等价于 (模板, 参数) 形式的模板感知键。
+"""
+
+import hashlib
+import re
+from collections import deque
+
+_SIMPLE_PAIR_PATTERN = re.compile(r'^"[^"]*"\s*->')
+
+
+def _needs_space(prev: str, nxt: str) -> bool:
+    """两个字符之间的空白是否必须保留（标识符边界）"""
+    return (prev.isalnum() or prev == "_") and (nxt.isalnum() or nxt == "_")
+
+
+def _collapse_whitespace(query: str) -> str:
+    """折叠字符串字面量之外的空白"""
+    out: list = []
+    in_string = False
+    escaped = False
+    pending_ws = False
+
+    for ch in query:
+        if in_string:
+            out.append(ch)
+            if escaped:
+                escaped = False
+            elif ch == "\\":
+                escaped = True
+            elif ch == '"':
+                in_string = False
+            continue
+
+        if ch.isspace():
+            pending_ws = True
+            continue
+
+        if pending_ws:
+            if out and _needs_space(out[-1], ch):
+                out.append(" ")
+            pending_ws = False
+
+        out.append(ch)
+        if ch == '"':
+            in_string = True
+
+    return "".join(out)
+
+
+def _split_top_level(body: str) -> "list[str] | None":
+    """按括号深度为 0 的逗号切分（含字符串感知），失败返回 None"""
+    parts: list = []
+    depth = 0
+    in_string = False
+    escaped = False
+    start = 0
+
+    for i, ch in enumerate(body):
+        if in_string:
+            if escaped:
+                escaped = False
+            elif ch == "\\":
+                escaped = True
+            elif ch == '"':
+                in_string = False
+            continue
+        if ch == '"':
+            in_string = True
+        elif ch in "([{":
+            depth += 1
+        elif ch in ")]}":
+            depth -= 1
+            if depth < 0:
+                return None
+        elif ch == "," and depth == 0:
+            parts.append(body[start:i])
+            start = i + 1
+
+    if depth != 0 or in_string:
+        return None
+    parts.append(body[start:])
+    return parts
+
+
+def _sort_map_pairs(query: str) -> str:
+    """对简单 Map("k" -> v, ...) 的键值对按键排序
+
+    只处理内部不再嵌套 Map 的实例，且所有顶层元素都形如
+    "key" -> value 时才重排——识别不了的结构保持原样。
+    """
+    out = []
+    pos = 0
+    while True:
+        start = query.find("Map(", pos)
+        if start == -1:
+            out.append(query[pos:])
+            break
+
+        # 扫描到配对的右括号（字符串感知）
+        depth = 0
+        in_string = False
+        escaped = False
+        end = -1
+        for i in range(start + 3, len(query)):
+            ch = query[i]
+            if in_string:
+                if escaped:
+                    escaped = False
+                elif ch == "\\":
+                    escaped = True
+                elif ch == '"':
+                    in_string = False
+                continue
+            if ch == '"':
+                in_string = True
+            elif ch == "(":
+                depth += 1
+            elif ch == ")":
+                depth -= 1
+                if depth == 0:
+                    end = i
+                    break
+        if end == -1:
+            out.append(query[pos:])
+            break
+
+        body = query[start + 4 : end]
+        parts = None
+        if "Map(" not in body:
+            parts = _split_top_level(body)
+            if parts is not None and not all(
+                _SIMPLE_PAIR_PATTERN.match(p.strip()) for p in parts
+            ):
+                parts = None
+
+        out.append(query[pos:start])
+        if parts is not None:
+            out.append("Map(" + ",".join(sorted(p.strip() for p in parts)) + ")")
+        else:
+            out.append(query[start : end + 1])
+        pos = end + 1
+
+    return "".join(out)
+
+
+def normalize_query(query: str) -> str:
+    """规范化查询文本（仅用于缓存键，不回发给 Joern）"""
+    return _sort_map_pairs(_collapse_whitespace(query))
+
+
+class CacheKeyStats:
+    """缓存键规范化统计
+
+    rescued_hits 是近似值：命中时若该查询的原文形态首次出现，
+    记为"规范化救回的命中"（同一结果的另一种格式写法）。
+    跨进程重启的持久缓存命中也会计入首个样本。
+    """
+
+    SEEN_LIMIT = 4096
+
+    def __init__(self):
+        self.lookups = 0
+        self.hits = 0
+        self.normalized_keys = 0
+        self.rescued_hits = 0
+        self._seen_raw: set = set()
+        self._seen_order: deque = deque()
+
+    def observe(self, raw_query: str, normalized: str, hit: bool) -> None:
+        """记录一次缓存查找"""
+        self.lookups += 1
+        if hit:
+            self.hits += 1
+        if normalized != raw_query:
+            self.normalized_keys += 1
+
+        raw_hash = hashlib.md5(raw_query.encode()).hexdigest()
+        first_seen = raw_hash not in self._seen_raw
+        if first_seen:
+            self._seen_raw.add(raw_hash)
+            self._seen_order.append(raw_hash)
+            if len(self._seen_order) > self.SEEN_LIMIT:
+                self._seen_raw.discard(self._seen_order.popleft())
+            if hit:
+                self.rescued_hits += 1
+
+    def get_stats(self) -> dict:
+        return {
+            "lookups": self.lookups,
+            "hits": self.hits,
+            "normalized_keys": self.normalized_keys,
+            "rescued_hits": self.rescued_hits,
+        }
+
+
+_stats = CacheKeyStats()
+
+
+def get_cache_key_stats() -> CacheKeyStats:
+    """获取全局缓存键统计"""
+    return _stats
+
+
+def reset_cache_key_stats() -> None:
+    """重置缓存键统计（仅测试使用）"""
+    global _stats
+    _stats = CacheKeyStats()
@@ -0,0 +1,102 @@
+"""CPG 代数（generation）跟踪
+
+为每个项目维护一个单调递增的代数计数器：
+parse_project 重新导入项目时代数 +1，
+查询缓存键把代数编进去，重导入后旧缓存条目自然失效。
+
+代数持久化到磁盘（与持久化查询缓存配套），
+否则重启后代数归零会让新键撞上上一代的缓存条目。
+"""
+
+import json
+import re
+from pathlib import Path
+
+from loguru import logger
+
+from joern_mcp.config import settings
+
+# 无法确定项目名时使用的"当前活动项目"代数键
+CURRENT_PROJECT_KEY = "__current__"
+
+# 查询中显式引用项目的模式: workspace.project("name")
+_PROJECT_REF_PATTERN = re.compile(r'workspace\.project\("([^"]+)"\)')
+
+# 内存中的代数表（延迟加载）
+_generations: dict[str, int] | None = None
+
+
+def _generation_file() -> Path:
+    """代数文件路径（与 CPG 缓存同目录）"""
+    return settings.joern_cpg_cache / "cpg_generations.json"
+
+
+def _load() -> dict[str, int]:
+    """加载代数表（首次访问时从磁盘读取）"""
+    global _generations
+    if _generations is None:
+        _generations = {}
+        gen_file = _generation_file()
+        if gen_file.exists():
+            try:
+                _generations = json.loads(gen_file.read_text(encoding="utf-8"))
+            except (json.JSONDecodeError, OSError) as e:
+                logger.warning(f"Failed to load CPG generations: {e}")
+                _generations = {}
+    return _generations
+
+
+def _save() -> None:
+    """保存代数表到磁盘"""
+    gen_file = _generation_file()
+    try:
+        gen_file.parent.mkdir(parents=True, exist_ok=True)
+        gen_file.write_text(json.dumps(_load()), encoding="utf-8")
+    except OSError as e:
+        logger.warning(f"Failed to save CPG generations: {e}")
+
+
+def get_generation(project_name: str) -> int:
+    """获取项目的当前代数（未导入过的项目为 0）"""
+    return _load().get(project_name, 0)
+
+
+def bump_generation(project_name: str) -> int:
+    """项目重新导入后递增代数
+
+    同时递增"当前活动项目"代数，
+    因为导入会切换活动项目，使不带项目前缀的查询结果失效。
+
+    Returns:
+        递增后的代数
+    """
+    generations = _load()
+    generations[project_name] = generations.get(project_name, 0) + 1
+    if project_name != CURRENT_PROJECT_KEY:
+        generations[CURRENT_PROJECT_KEY] = (
+            generations.get(CURRENT_PROJECT_KEY, 0) + 1
+        )
+    _save()
+    logger.debug(
+        f"CPG generation bumped: {project_name} -> {generations[project_name]}"
+    )
+    return generations[project_name]
+
+
+def cache_key_salt(query: str) -> str:
+    """为查询计算缓存键盐值
+
+    盐值包含查询引用的每个项目的名称和代数；
+    不带项目前缀的查询使用"当前活动项目"代数。
+    项目重新导入后盐值变化，旧缓存条目不再命中。
+    """
+    projects = sorted(set(_PROJECT_REF_PATTERN.findall(query)))
+    if not projects:
+        projects = [CURRENT_PROJECT_KEY]
+    return ",".join(f"{p}:{get_generation(p)}" for p in projects)
+
+
+def reset_generations() -> None:
+    """重置代数表（仅测试使用）"""
+    global _generations
+    _generations = None
@@ -0,0 +1,117 @@
+"""DOT 图的文件通道传输
+
+大函数的 CFG/CDG 经 REPL stdout 回传是多 MB 级字符串：
+JVM 先整体序列化，HTTP 再整体传输，客户端还要层层剥离
+REPL 前缀/引号/转义（容易把图本身改坏）。
+
+本模块改走 Joern 的管道落盘操作符（export_cpg 已在用的 ``|>``）：
+查询端把 DOT 字符串直接写到共享文件系统上的临时文件，
+Python 端直接读文件——零 REPL 序列化、无需任何清洗。
+小图（不超过 dot_inline_max_bytes）内联返回并删除临时文件，
+大图返回文件路径由调用方自取；``|>`` 不可用时回退 stdout 内联。
+"""
+
+import re
+import uuid
+from pathlib import Path
+
+from loguru import logger
+
+from joern_mcp.config import settings
+
+# 临时 DOT 文件目录（workspace 下，与 Joern 进程共享文件系统）
+_TRANSFER_DIR = "dot_transfer"
+
+
+def clean_dot_string(stdout: str) -> str:
+    """清理经 REPL stdout 回传的 DOT 字符串
+
+    仅内联回退路径需要：移除 Scala REPL 输出前缀、
+    多余引号和转义字符。文件通道读到的内容无需清洗。
+    """
+    result = stdout.strip()
+
+    # 移除 Scala REPL 输出前缀（如 "val res0: String = "）
+    if result.startswith("val "):
+        match = re.search(r"=\s*(.+)", result, re.DOTALL)
+        if match:
+            result = match.group(1).strip()
+
+    # 移除多层首尾双引号 (如 '""digraph...""')
+    while result.startswith('""') and result.endswith('""') and len(result) > 4:
+        result = result[2:-2]
+
+    # 移除单层首尾引号
+    if result.startswith('"') and result.endswith('"') and len(result) > 2:
+        result = result[1:-1]
+
+    # 处理转义字符
+    result = result.replace("\\n", "\n").replace("\\t", "\t").replace('\\"', '"')
+
+    return result
+
+
+def dot_transfer_path() -> Path:
+    """分配一个临时 DOT 传输文件路径（每次调用唯一）"""
+    transfer_dir = settings.joern_workspace / _TRANSFER_DIR
+    transfer_dir.mkdir(parents=True, exist_ok=True)
+    return transfer_dir / f"dot_{uuid.uuid4().hex}.dot"
+
+
+async def fetch_dot(executor, dot_query: str) -> dict:
+    """执行返回 String 的 DOT 查询，经文件通道取回结果
+
+    Args:
+        executor: 查询执行器
+        dot_query: 求值为 DOT 字符串的 CPGQL 表达式
+                   （如 ...dotCfg.headOption.getOrElse("")）
+
+    Returns:
+        dict:
+            - success: 是否成功
+            - dot: 内联 DOT 内容（大图时为 None）
+            - dot_file: 大图的文件路径（仅超过内联上限时出现）
+            - size_bytes: DOT 内容大小
+            - transfer: 实际使用的通道 (file/file_inline/inline)
+    """
+    dot_file = dot_transfer_path()
+    piped_query = f'{dot_query} |> "{dot_file}"'
+
+    try:
+        # 文件内容即结果，缓存管道查询的空 stdout 没有意义
+        result = await executor.execute(piped_query, format="raw", use_cache=False)
+        if result.get("success") and dot_file.is_file():
+            size = dot_file.stat().st_size
+            if size > settings.dot_inline_max_bytes:
+                # 大图：保留文件，调用方直接读共享文件系统
+                return {
+                    "success": True,
+                    "dot": None,
+                    "dot_file": str(dot_file),
+                    "size_bytes": size,
+                    "transfer": "file",
+                }
+            content = dot_file.read_text(encoding="utf-8")
+            dot_file.unlink(missing_ok=True)
+            return {
+                "success": True,
+                "dot": content,
+                "size_bytes": size,
+                "transfer": "file_inline",
+            }
+    except Exception as e:
+        logger.debug(f"DOT file transfer failed, falling back to inline: {e}")
+
+    dot_file.unlink(missing_ok=True)
+
+    # 回退：stdout 内联（旧版本不支持 |> 或文件写入失败）
+    result = await executor.execute(dot_query, format="raw")
+    if result.get("success"):
+        content = clean_dot_string(result.get("stdout", ""))
+        return {
+            "success": True,
+            "dot": content,
+            "size_bytes": len(content.encode()),
+            "transfer": "inline",
+        }
+    return {"success": False, "error": result.get("stderr", "Query failed")}
@@ -0,0 +1,72 @@
+"""按汇函数的数据流摘要缓存
+
+交互式排查的主导模式是"盯住一个汇，逐个试源"：
+每次 (源, 汇) 配对都重跑完整 reachableBy，同一个汇被反复求解。
+
+本缓存按 (项目, CPG 代数, 汇函数) 记住一次性算出的汇摘要
+（从全部方法参数到该汇的流，带源方法名标记），后续同汇的
+配对探查在 Python 端按源过滤即答。项目重新导入后代数递增，
+旧摘要自然失效（同查询缓存键的机制）。
+"""
+
+from cachetools import LRUCache
+
+from joern_mcp.utils.cpg_generation import CURRENT_PROJECT_KEY, get_generation
+
+
+class FlowSummaryCache:
+    """汇函数数据流摘要缓存
+
+    键: (项目名, CPG 代数, 汇函数名)；值为 dict:
+        flows: 流列表（每条带 sourceMethod 源方法名）
+        truncated: 摘要是否被 take 上限截断
+                   （截断的摘要未命中源时须退回直查，避免漏报）
+    """
+
+    def __init__(self, maxsize: int = 64):
+        self._cache: LRUCache = LRUCache(maxsize=maxsize)
+        self.hits = 0
+        self.misses = 0
+
+    @staticmethod
+    def _key(project_name: "str | None", sink_method: str) -> tuple:
+        scope = project_name or CURRENT_PROJECT_KEY
+        return (scope, get_generation(scope), sink_method)
+
+    def get(self, project_name: "str | None", sink_method: str) -> "dict | None":
+        """读取汇摘要（代数不匹配的旧条目不命中）"""
+        summary = self._cache.get(self._key(project_name, sink_method))
+        if summary is None:
+            self.misses += 1
+        else:
+            self.hits += 1
+        return summary
+
+    def set(self, project_name: "str | None", sink_method: str, summary: dict) -> None:
+        """写入汇摘要"""
+        self._cache[self._key(project_name, sink_method)] = summary
+
+    def clear(self) -> None:
+        """清空缓存"""
+        self._cache.clear()
+
+    def get_stats(self) -> dict:
+        return {
+            "entries": len(self._cache),
+            "hits": self.hits,
+            "misses": self.misses,
+        }
+
+
+_flow_summary_cache = FlowSummaryCache()
+
+
+def get_flow_summary_cache() -> FlowSummaryCache:
+    """获取全局汇摘要缓存"""
+    return _flow_summary_cache
+
+
+def reset_flow_summary_cache() -> None:
+    """重置汇摘要缓存（仅测试使用）"""
+    global _flow_summary_cache
+    _flow_summary_cache = FlowSummaryCache()
@@ -0,0 +1,90 @@
+"""CPGQL 查询分页支持
+
+大结果集（如全程序方法列表，动辄数十万条）一次性 .toJson 会在
+JVM、HTTP 响应和 Python 解析端同时产生巨大的内存压力。
+
+本模块把分页下推到 CPGQL 遍历本身：在遍历末尾注入
+``.drop(offset).take(page_size)``，JVM 只序列化当前页。
+客户端通过不透明的 continuation token（cursor）逐页拉取。
+
+cursor 中编入查询指纹，防止把一个查询的游标误用到另一个查询上。
+"""
+
+import base64
+import binascii
+import hashlib
+import json
+
+# 注入分页窗口前需要剥离的终结后缀
+# （executor 会在最终查询上重新追加 .toJson）
+_TERMINAL_SUFFIXES = (".toJson", ".toList", ".l")
+
+
+def apply_page_window(query: str, offset: int, limit: int) -> str:
+    """在遍历末尾注入分页窗口
+
+    Args:
+        query: CPGQL 遍历（应返回集合；.size/.toDot 等标量查询不适用）
+        offset: 跳过的元素数
+        limit: 本页获取的元素数
+
+    Returns:
+        str: 注入 .drop(offset).take(limit) 后的查询
+    """
+    stripped = query.strip()
+    for suffix in _TERMINAL_SUFFIXES:
+        if stripped.endswith(suffix):
+            stripped = stripped[: -len(suffix)].rstrip()
+            break
+
+    return f"{stripped}.drop({offset}).take({limit})"
+
+
+def _query_signature(query: str) -> str:
+    """查询指纹（游标绑定到具体查询）"""
+    return hashlib.md5(query.encode()).hexdigest()[:12]
+
+
+def encode_cursor(offset: int, query: str) -> str:
+    """编码 continuation token
+
+    Args:
+        offset: 下一页的起始偏移
+        query: 原始查询（未注入分页窗口的形式）
+
+    Returns:
+        str: base64 编码的不透明游标
+    """
+    payload = {"offset": offset, "sig": _query_signature(query)}
+    raw = json.dumps(payload, separators=(",", ":")).encode()
+    return base64.urlsafe_b64encode(raw).decode()
+
+
+def decode_cursor(cursor: str, query: str) -> int:
+    """解码并校验 continuation token
+
+    Args:
+        cursor: encode_cursor 生成的游标
+        query: 原始查询，必须与生成游标时一致
+
+    Returns:
+        int: 本页起始偏移
+
+    Raises:
+        ValueError: 游标格式非法或与查询不匹配
+    """
+    try:
+        raw = base64.urlsafe_b64decode(cursor.encode())
+        payload = json.loads(raw)
+        offset = payload["offset"]
+        sig = payload["sig"]
+    except (binascii.Error, json.JSONDecodeError, KeyError, TypeError) as e:
+        raise ValueError(f"Invalid cursor: {cursor}") from e
+
+    if not isinstance(offset, int) or offset < 0:
+        raise ValueError(f"Invalid cursor offset: {offset}")
+
+    if sig != _query_signature(query):
+        raise ValueError("Cursor does not match this query")
+
+    return offset
@@ -0,0 +1,166 @@
+"""异步解析任务队列
+
+parse_project 一次导入一个项目并阻塞调用方直到完成，
+批量接入多仓库 workspace 时只能串行等待。项目间的解析
+互不依赖，本模块提供一个进程内任务队列：一次提交多个源码树，
+在可配置的并行度内并发执行导入，调用方立即拿到 job_id，
+通过 parse_status 工具轮询进度。
+
+并行度默认取 settings.parse_queue_parallelism；
+队列只存在于当前进程内，不做持久化（进程重启后任务丢失，
+已完成的导入结果仍在 Joern workspace 中）。
+"""
+
+import asyncio
+import time
+import uuid
+from collections.abc import Awaitable, Callable
+from dataclasses import dataclass, field
+
+from loguru import logger
+
+from joern_mcp.config import settings
+
+# 任务状态流转: queued -> running -> completed / failed
+JOB_QUEUED = "queued"
+JOB_RUNNING = "running"
+JOB_COMPLETED = "completed"
+JOB_FAILED = "failed"
+
+
+@dataclass
+class ParseJob:
+    """单个解析任务的状态记录"""
+
+    job_id: str
+    source_path: str
+    project_name: str
+    state: str = JOB_QUEUED
+    submitted_at: float = field(default_factory=time.time)
+    started_at: float | None = None
+    finished_at: float | None = None
+    result: dict | None = None
+    error: str | None = None
+
+    def to_dict(self, include_result: bool = False) -> dict:
+        """转为状态报告字典"""
+        info = {
+            "job_id": self.job_id,
+            "source_path": self.source_path,
+            "project_name": self.project_name,
+            "state": self.state,
+            "submitted_at": self.submitted_at,
+            "started_at": self.started_at,
+            "finished_at": self.finished_at,
+        }
+        if self.started_at is not None:
+            end = self.finished_at if self.finished_at is not None else time.time()
+            info["duration"] = round(end - self.started_at, 2)
+        if self.error is not None:
+            info["error"] = self.error
+        if include_result and self.result is not None:
+            info["result"] = self.result
+        return info
+
+
+class ParseQueue:
+    """进程内解析任务队列（信号量限制并行度）"""
+
+    def __init__(self, parallelism: int | None = None):
+        self.parallelism = parallelism or settings.parse_queue_parallelism
+        self._semaphore = asyncio.Semaphore(self.parallelism)
+        self._jobs: dict[str, ParseJob] = {}
+        self._tasks: dict[str, asyncio.Task] = {}
+
+    def submit(
+        self,
+        source_path: str,
+        project_name: str,
+        runner: Callable[[], Awaitable[dict]],
+    ) -> str:
+        """提交一个解析任务，立即返回 job_id
+
+        Args:
+            source_path: 源码路径（仅用于状态报告）
+            project_name: 项目名称（仅用于状态报告）
+            runner: 执行实际导入的协程工厂，返回 parse 结果字典
+
+        Returns:
+            str: 任务 ID
+        """
+        job_id = uuid.uuid4().hex[:12]
+        job = ParseJob(
+            job_id=job_id, source_path=source_path, project_name=project_name
+        )
+        self._jobs[job_id] = job
+        self._tasks[job_id] = asyncio.create_task(self._run(job, runner))
+        logger.info(f"Parse job {job_id} queued: {project_name} ({source_path})")
+        return job_id
+
+    async def _run(self, job: ParseJob, runner: Callable[[], Awaitable[dict]]) -> None:
+        """执行单个任务（受并行度信号量约束）"""
+        async with self._semaphore:
+            job.state = JOB_RUNNING
+            job.started_at = time.time()
+            try:
+                result = await runner()
+                job.result = result
+                if result.get("success"):
+                    job.state = JOB_COMPLETED
+                else:
+                    job.state = JOB_FAILED
+                    job.error = result.get("error", "Unknown error")
+            except Exception as e:
+                logger.exception(f"Parse job {job.job_id} crashed: {e}")
+                job.state = JOB_FAILED
+                job.error = str(e)
+            finally:
+                job.finished_at = time.time()
+                self._tasks.pop(job.job_id, None)
+                logger.info(f"Parse job {job.job_id} finished: {job.state}")
+
+    def get_job(self, job_id: str) -> ParseJob | None:
+        """按 ID 查找任务"""
+        return self._jobs.get(job_id)
+
+    def get_all(self) -> list[ParseJob]:
+        """按提交顺序返回所有任务"""
+        return list(self._jobs.values())
+
+    def summary(self) -> dict:
+        """队列整体进度（按状态计数）"""
+        counts = {
+            JOB_QUEUED: 0,
+            JOB_RUNNING: 0,
+            JOB_COMPLETED: 0,
+            JOB_FAILED: 0,
+        }
+        for job in self._jobs.values():
+            counts[job.state] = counts.get(job.state, 0) + 1
+        total = len(self._jobs)
+        done = counts[JOB_COMPLETED] + counts[JOB_FAILED]
+        return {
+            "total": total,
+            "parallelism": self.parallelism,
+            "by_state": counts,
+            "done": done,
+            "in_progress": total - done,
+        }
+
+    async def wait_all(self) -> None:
+        """等待所有在途任务结束（测试/脚本用）"""
+        tasks = list(self._tasks.values())
+        if tasks:
+            await asyncio.gather(*tasks, return_exceptions=True)
+
+
+# 全局队列实例（首次使用时按当前配置创建）
+_parse_queue: ParseQueue | None = None
+
+
+def get_parse_queue() -> ParseQueue:
+    """获取全局解析队列"""
+    global _parse_queue
+    if _parse_queue is None:
+        _parse_queue = ParseQueue()
+    return _parse_queue
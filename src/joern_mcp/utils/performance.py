@@ -5,17 +5,140 @@
 """
 
 import asyncio
+import heapq
 import json
+import re
+import sqlite3
 import time
 import zlib
-from collections import defaultdict
+from bisect import bisect_right
+from collections import defaultdict, deque
+from contextlib import contextmanager
+from contextvars import ContextVar
 from dataclasses import dataclass, field
+from pathlib import Path
 from typing import Any
 
 from cachetools import LRUCache, TTLCache
 from loguru import logger
 
 
+def _log_spaced_bounds(lo: float, hi: float, growth: float) -> list[float]:
+    """生成对数间隔的桶边界"""
+    bounds = []
+    bound = lo
+    while bound <= hi:
+        bounds.append(bound)
+        bound *= growth
+    return bounds
+
+
+class LatencySketch:
+    """流式延迟分位数草图（对数分桶直方图）
+
+    替代"保留原始样本 + 每次 get_percentile 全量排序"：
+    固定桶数的内存占用，add O(1)，分位数查询一次线性扫描，
+    监控面板 5 秒轮询一次也没有可测开销。
+
+    桶边界按 1.25 倍对数间隔铺设（相邻桶 ±12% 相对误差，
+    对延迟监控足够）。样本数达到衰减阈值时计数整体减半，
+    近似滑动窗口——历史流量不会永远压住新近的回归。
+    """
+
+    GROWTH = 1.25
+    DECAY_THRESHOLD = 10000
+
+    # 1ms 以下不再细分，上界取 query_timeout 的量级
+    BOUNDS = _log_spaced_bounds(0.001, 600.0, 1.25)
+
+    def __init__(self):
+        self.counts = [0] * (len(self.BOUNDS) + 1)
+        self.count = 0
+
+    def add(self, value: float) -> None:
+        """记录一个延迟样本"""
+        self.counts[bisect_right(self.BOUNDS, value)] += 1
+        self.count += 1
+        if self.count >= self.DECAY_THRESHOLD:
+            self.counts = [c // 2 for c in self.counts]
+            self.count = sum(self.counts)
+
+    def quantile(self, percentile: float) -> float:
+        """估算百分位数（桶内按秩线性插值）"""
+        if self.count == 0:
+            return 0.0
+
+        rank = min(int(self.count * percentile / 100), self.count - 1)
+        cumulative = 0
+        for idx, bucket_count in enumerate(self.counts):
+            if bucket_count == 0:
+                continue
+            if rank < cumulative + bucket_count:
+                lo = 0.0 if idx == 0 else self.BOUNDS[idx - 1]
+                hi = (
+                    self.BOUNDS[idx]
+                    if idx < len(self.BOUNDS)
+                    else self.BOUNDS[-1] * self.GROWTH
+                )
+                frac = (rank - cumulative + 0.5) / bucket_count
+                return lo + (hi - lo) * frac
+            cumulative += bucket_count
+        return self.BOUNDS[-1]
+
+
+class DimensionMetrics:
+    """单个维度（工具名或项目名）的查询指标"""
+
+    __slots__ = ("count", "errors", "cache_hits", "total_time", "sketch")
+
+    def __init__(self):
+        self.count = 0
+        self.errors = 0
+        self.cache_hits = 0
+        self.total_time = 0.0
+        self.sketch = LatencySketch()
+
+    def record(self, duration: float, success: bool, cached: bool) -> None:
+        self.count += 1
+        if not success:
+            self.errors += 1
+        if cached:
+            self.cache_hits += 1
+        self.total_time += duration
+        self.sketch.add(duration)
+
+    def to_dict(self) -> dict:
+        return {
+            "count": self.count,
+            "errors": self.errors,
+            "cache_hits": self.cache_hits,
+            "avg_time": round(self.total_time / self.count, 4) if self.count else 0.0,
+            "p50": round(self.sketch.quantile(50), 4),
+            "p95": round(self.sketch.quantile(95), 4),
+            "p99": round(self.sketch.quantile(99), 4),
+        }
+
+
+# 当前协程上下文里正在执行的 MCP 工具名（由 mcp_server 的
+# 注册包装设置），record_query 据此把指标归入 by_tool 维度
+_current_tool: ContextVar = ContextVar("joern_mcp_current_tool", default=None)
+
+
+@contextmanager
+def track_tool(tool_name: str):
+    """标记当前协程上下文正在执行某个 MCP 工具
+
+    用法:
+        with track_tool("find_vulnerabilities"):
+            ...  # 期间 record_query 的指标归入该工具维度
+    """
+    token = _current_tool.set(tool_name)
+    try:
+        yield
+    finally:
+        _current_tool.reset(token)
+
+
 @dataclass
 class PerformanceMetrics:
     """性能指标"""
@@ -38,11 +161,37 @@ class PerformanceMetrics:
     current_concurrent: int = 0
     max_concurrent: int = 0
 
-    # 查询时间分布 (P50, P95, P99)
-    query_times: list = field(default_factory=list)
+    # 最近查询时间环形缓冲（固定容量，追加 O(1)，不再切片复制）
+    query_times: deque = field(default_factory=lambda: deque(maxlen=1000))
+
+    # 查询时间分布草图 (P50, P95, P99)
+    latency_sketch: LatencySketch = field(default_factory=LatencySketch)
+
+    # 按工具名/项目名分维度的指标（taint 工具和调用图工具
+    # 各自是否回归，全局数字看不出来）
+    by_tool: dict = field(default_factory=dict)
+    by_project: dict = field(default_factory=dict)
 
-    def record_query(self, duration: float, success: bool = True, cached: bool = False):
-        """记录一次查询"""
+    # 分阶段耗时: stage -> 最近若干次耗时的环形缓冲
+    # 把端到端延迟拆解到调度等待/WebSocket连接/POST/Joern执行/结果GET/解析，
+    # P99 尖刺时可以直接定位时间花在哪个阶段
+    stage_times: dict = field(default_factory=dict)
+
+    # 维度字典上限（工具数是有限的，项目可能很多，FIFO 淘汰最老维度）
+    MAX_DIMENSIONS = 64
+
+    def record_query(
+        self,
+        duration: float,
+        success: bool = True,
+        cached: bool = False,
+        tool: str | None = None,
+        project: str | None = None,
+    ):
+        """记录一次查询
+
+        tool 缺省时取 track_tool 设置的当前工具上下文。
+        """
         self.total_queries += 1
         if success:
             self.successful_queries += 1
@@ -58,10 +207,56 @@ class PerformanceMetrics:
         self.min_time = min(self.min_time, duration)
         self.max_time = max(self.max_time, duration)
         self.query_times.append(duration)
+        self.latency_sketch.add(duration)
 
-        # 只保留最近1000条记录
-        if len(self.query_times) > 1000:
-            self.query_times = self.query_times[-1000:]
+        tool = tool or _current_tool.get()
+        if tool:
+            self._record_dimension(self.by_tool, tool, duration, success, cached)
+        if project:
+            self._record_dimension(self.by_project, project, duration, success, cached)
+
+    def _record_dimension(
+        self, dimensions: dict, key: str, duration: float, success: bool, cached: bool
+    ):
+        """记入单个维度，维度数量超限时 FIFO 淘汰最老的"""
+        dim = dimensions.get(key)
+        if dim is None:
+            if len(dimensions) >= self.MAX_DIMENSIONS:
+                dimensions.pop(next(iter(dimensions)))
+            dim = dimensions[key] = DimensionMetrics()
+        dim.record(duration, success, cached)
+
+    def record_stage(self, stage: str, duration: float):
+        """记录查询管线中单个阶段的耗时"""
+        if stage not in self.stage_times:
+            self.stage_times[stage] = deque(maxlen=1000)
+        self.stage_times[stage].append(duration)
+
+    def get_stage_stats(self) -> dict:
+        """获取各阶段的耗时统计（计数、均值、P50/P95/P99）
+
+        每个阶段只排序一次，三个百分位共用排序结果。
+        """
+        stats = {}
+        for stage, times in sorted(self.stage_times.items()):
+            if not times:
+                continue
+            sorted_times = sorted(times)
+            count = len(sorted_times)
+
+            def percentile(p: int) -> float:
+                index = int(count * p / 100)
+                return sorted_times[min(index, count - 1)]
+
+            stats[stage] = {
+                "count": count,
+                "total": round(sum(sorted_times), 3),
+                "avg": round(sum(sorted_times) / count, 4),
+                "p50": round(percentile(50), 4),
+                "p95": round(percentile(95), 4),
+                "p99": round(percentile(99), 4),
+            }
+        return stats
 
     def get_avg_time(self) -> float:
         """获取平均响应时间"""
@@ -83,12 +278,11 @@ class PerformanceMetrics:
         return self.successful_queries / self.total_queries * 100
 
     def get_percentile(self, percentile: int) -> float:
-        """获取百分位数（P50, P95, P99）"""
-        if not self.query_times:
-            return 0.0
-        sorted_times = sorted(self.query_times)
-        index = int(len(sorted_times) * percentile / 100)
-        return sorted_times[min(index, len(sorted_times) - 1)]
+        """获取百分位数（P50, P95, P99）
+
+        从流式草图读取，不再对样本列表全量排序。
+        """
+        return self.latency_sketch.quantile(percentile)
 
     def to_dict(self) -> dict:
         """转换为字典"""
@@ -110,15 +304,121 @@ class PerformanceMetrics:
             "success_rate": round(self.get_success_rate(), 2),
             "current_concurrent": self.current_concurrent,
             "max_concurrent": self.max_concurrent,
+            "stages": self.get_stage_stats(),
+            "by_tool": {name: dim.to_dict() for name, dim in self.by_tool.items()},
+            "by_project": {
+                name: dim.to_dict() for name, dim in self.by_project.items()
+            },
         }
 
 
+class PersistentCache:
+    """磁盘持久化缓存（SQLite）
+
+    作为 HybridCache 的底层缓存层：
+    热/冷内存缓存在进程重启后丢失，
+    持久层让部署重启后的冷启动查询仍然命中缓存。
+
+    值以 zlib 压缩的 JSON 存储，带写入时间戳用于 TTL 过期。
+    """
+
+    def __init__(self, db_path: "Path | str", ttl: int = 604800):  # 默认7天
+        self.db_path = Path(db_path)
+        self.ttl = ttl
+        self._conn: sqlite3.Connection | None = None
+
+        self.stats = {"hits": 0, "misses": 0, "writes": 0, "errors": 0}
+
+    def _get_conn(self) -> sqlite3.Connection:
+        """获取或创建数据库连接（延迟初始化）"""
+        if self._conn is None:
+            self.db_path.parent.mkdir(parents=True, exist_ok=True)
+            self._conn = sqlite3.connect(
+                str(self.db_path), check_same_thread=False
+            )
+            self._conn.execute(
+                "CREATE TABLE IF NOT EXISTS query_cache ("
+                "key TEXT PRIMARY KEY, value BLOB, created REAL)"
+            )
+            self._conn.commit()
+        return self._conn
+
+    def get(self, key: str) -> Any | None:
+        """读取缓存（过期条目视为未命中并删除）"""
+        try:
+            conn = self._get_conn()
+            row = conn.execute(
+                "SELECT value, created FROM query_cache WHERE key = ?", (key,)
+            ).fetchone()
+
+            if row is None:
+                self.stats["misses"] += 1
+                return None
+
+            value_blob, created = row
+            if time.time() - created > self.ttl:
+                conn.execute("DELETE FROM query_cache WHERE key = ?", (key,))
+                conn.commit()
+                self.stats["misses"] += 1
+                return None
+
+            self.stats["hits"] += 1
+            return json.loads(zlib.decompress(value_blob).decode())
+        except Exception as e:
+            logger.debug(f"Persistent cache read failed: {e}")
+            self.stats["errors"] += 1
+            return None
+
+    def set(self, key: str, value: Any) -> None:
+        """写入缓存（无法JSON序列化的值静默跳过）"""
+        try:
+            blob = zlib.compress(json.dumps(value).encode(), level=6)
+            conn = self._get_conn()
+            conn.execute(
+                "INSERT OR REPLACE INTO query_cache (key, value, created) "
+                "VALUES (?, ?, ?)",
+                (key, blob, time.time()),
+            )
+            conn.commit()
+            self.stats["writes"] += 1
+        except Exception as e:
+            logger.debug(f"Persistent cache write failed: {e}")
+            self.stats["errors"] += 1
+
+    def clear(self) -> None:
+        """清空持久化缓存"""
+        try:
+            conn = self._get_conn()
+            conn.execute("DELETE FROM query_cache")
+            conn.commit()
+        except Exception as e:
+            logger.warning(f"Failed to clear persistent cache: {e}")
+
+    def close(self) -> None:
+        """关闭数据库连接"""
+        if self._conn is not None:
+            self._conn.close()
+            self._conn = None
+
+    def get_stats(self) -> dict:
+        """获取持久层统计"""
+        size = 0
+        try:
+            size = self._get_conn().execute(
+                "SELECT COUNT(*) FROM query_cache"
+            ).fetchone()[0]
+        except Exception:  # noqa: S110
+            pass
+        return {**self.stats, "size": size}
+
+
 class HybridCache:
     """
-    混合缓存：LRU + TTL
+    混合缓存：LRU + TTL + 可选磁盘持久层
 
     - 热数据使用LRU策略（快速访问）
     - 冷数据使用TTL策略（自动过期）
+    - 持久层（SQLite）让缓存跨进程重启存活
     - 支持缓存压缩（大结果）
     """
 
@@ -128,10 +428,12 @@ class HybridCache:
         cold_size: int = 1000,
         ttl: int = 3600,
         compress_threshold: int = 10240,  # 10KB
+        persistent: PersistentCache | None = None,
     ):
         self.hot_cache = LRUCache(maxsize=hot_size)
         self.cold_cache = TTLCache(maxsize=cold_size, ttl=ttl)
         self.compress_threshold = compress_threshold
+        self.persistent = persistent
 
         # 访问统计
         self.access_count: dict[str, int] = defaultdict(int)
@@ -141,13 +443,17 @@ class HybridCache:
         self.stats = {
             "hot_hits": 0,
             "cold_hits": 0,
+            "persistent_hits": 0,
             "misses": 0,
             "promotions": 0,
             "compressed": 0,
         }
 
-    def get(self, key: str) -> Any | None:
-        """获取缓存"""
+    # 内存未命中的哨兵值（缓存值本身可能是 None 之外的任意对象）
+    _MISS = object()
+
+    def _memory_get(self, key: str) -> Any:
+        """内存层（热/冷）查找，未命中返回 _MISS 哨兵"""
         # 先查热缓存
         if key in self.hot_cache:
             self.stats["hot_hits"] += 1
@@ -169,12 +475,53 @@ class HybridCache:
 
             return self._decompress(value)
 
+        return self._MISS
+
+    def _record_persistent_result(self, key: str, persisted: Any) -> Any | None:
+        """处理持久层查找结果（命中回填冷缓存，未命中计数）"""
+        if persisted is not None:
+            self.stats["persistent_hits"] += 1
+            # 回填冷缓存，后续访问走内存
+            self.cold_cache[key] = self._compress(persisted)
+            self.access_count[key] = 1
+            return persisted
+
+        self.stats["misses"] += 1
+        return None
+
+    def get(self, key: str) -> Any | None:
+        """获取缓存"""
+        value = self._memory_get(key)
+        if value is not self._MISS:
+            return value
+
+        # 查持久层（进程重启后内存缓存为空时的回源路径）
+        if self.persistent is not None:
+            return self._record_persistent_result(key, self.persistent.get(key))
+
         # 缓存未命中
         self.stats["misses"] += 1
         return None
 
-    def set(self, key: str, value: Any, hot: bool = False):
-        """设置缓存"""
+    async def aget(self, key: str) -> Any | None:
+        """异步获取缓存（持久层访问转工作线程）
+
+        持久层可能是网络后端（Redis）或磁盘（SQLite），
+        异步热路径必须用本方法，否则后端延迟会阻塞事件循环。
+        """
+        value = self._memory_get(key)
+        if value is not self._MISS:
+            return value
+
+        if self.persistent is not None:
+            persisted = await asyncio.to_thread(self.persistent.get, key)
+            return self._record_persistent_result(key, persisted)
+
+        self.stats["misses"] += 1
+        return None
+
+    def _memory_set(self, key: str, value: Any, hot: bool) -> None:
+        """写入内存层（热/冷）"""
         # 压缩大结果
         compressed_value = self._compress(value)
 
@@ -185,6 +532,21 @@ class HybridCache:
 
         self.access_count[key] = 0
 
+    def set(self, key: str, value: Any, hot: bool = False):
+        """设置缓存"""
+        self._memory_set(key, value, hot)
+
+        # 同步写入持久层
+        if self.persistent is not None:
+            self.persistent.set(key, value)
+
+    async def aset(self, key: str, value: Any, hot: bool = False) -> None:
+        """异步设置缓存（持久层写入转工作线程，见 aget）"""
+        self._memory_set(key, value, hot)
+
+        if self.persistent is not None:
+            await asyncio.to_thread(self.persistent.set, key, value)
+
     def _compress(self, value: Any) -> Any:
         """压缩值（如果需要）"""
         # 尝试序列化
@@ -207,18 +569,24 @@ class HybridCache:
         return value
 
     def clear(self):
-        """清空缓存"""
+        """清空缓存（包括持久层）"""
         self.hot_cache.clear()
         self.cold_cache.clear()
         self.access_count.clear()
+        if self.persistent is not None:
+            self.persistent.clear()
         logger.info("Cache cleared")
 
     def get_stats(self) -> dict:
         """获取缓存统计"""
-        total_hits = self.stats["hot_hits"] + self.stats["cold_hits"]
+        total_hits = (
+            self.stats["hot_hits"]
+            + self.stats["cold_hits"]
+            + self.stats["persistent_hits"]
+        )
         total_requests = total_hits + self.stats["misses"]
 
-        return {
+        stats = {
             **self.stats,
             "hot_size": len(self.hot_cache),
             "cold_size": len(self.cold_cache),
@@ -227,13 +595,26 @@ class HybridCache:
             if total_requests > 0
             else 0.0,
         }
+        if self.persistent is not None:
+            stats["persistent"] = self.persistent.get_stats()
+        return stats
 
 
 class AdaptiveSemaphore:
     """
-    自适应信号量
-
-    根据系统负载和查询性能动态调整并发数
+    自适应并发控制器（AIMD）
+
+    旧实现在调整容量时整体重建 asyncio.Semaphore，
+    排在旧信号量上的协程会被永久搁浅、在途的 permit 被遗忘，
+    实际效果要么泄漏并发要么死锁等待者。
+    现在容量只是一个计数：acquire/release 始终操作同一组
+    计数器和等待队列，adjust 仅改变上限——
+    扩容立即唤醒等待者，缩容通过"在途查询结束后不再补位"自然生效。
+
+    调整策略为 AIMD（加性增、乘性减）：
+    - 健康且有需求（响应快于目标一半，且有排队或槽位打满）时 +1 线性试探
+    - 过载（响应显著超标，或有排队且响应不达标）时容量减半快速退避
+    决策同时参考队列深度与在途数，而不仅是最近若干次的平均耗时。
     """
 
     def __init__(
@@ -247,23 +628,58 @@ class AdaptiveSemaphore:
         self.current_limit = min_concurrent
         self.target_response_time = target_response_time
 
-        self.semaphore = asyncio.Semaphore(self.current_limit)
+        # 执行槽位状态（单一活性原语：计数器 + FIFO 等待队列）
+        self._in_flight = 0
+        self._waiters: deque = deque()
         self.lock = asyncio.Lock()
 
         # 性能监控
         self.recent_times: list = []
         self.adjustment_interval = 10  # 每10次查询评估一次
         self.query_count = 0
+        self.last_avg_response = 0.0
+
+    async def acquire(self) -> None:
+        """获取执行槽位（无空位时排队等待）"""
+        if self._in_flight < self.current_limit and not self._waiters:
+            self._in_flight += 1
+            return
+
+        future: asyncio.Future = asyncio.get_event_loop().create_future()
+        self._waiters.append(future)
+
+        try:
+            await future
+        except asyncio.CancelledError:
+            # 如果在取消前已被授予槽位，需要归还
+            if future.done() and not future.cancelled():
+                self.release()
+            raise
+
+    def release(self) -> None:
+        """释放执行槽位并唤醒下一个等待者"""
+        self._in_flight -= 1
+        self._grant_next()
+
+    def _grant_next(self) -> None:
+        """按 FIFO 授予空闲槽位"""
+        while self._waiters and self._in_flight < self.current_limit:
+            future = self._waiters.popleft()
+            if future.done():
+                # 等待者已取消，跳过
+                continue
+            self._in_flight += 1
+            future.set_result(True)
 
     async def __aenter__(self):
-        await self.semaphore.acquire()
+        await self.acquire()
         return self
 
     async def __aexit__(self, exc_type, exc_val, exc_tb):
-        self.semaphore.release()
+        self.release()
 
     async def adjust(self, response_time: float):
-        """根据响应时间调整并发限制"""
+        """根据响应时间与负载状态调整并发限制（AIMD）"""
         self.recent_times.append(response_time)
         self.query_count += 1
 
@@ -271,32 +687,179 @@ class AdaptiveSemaphore:
         if self.query_count % self.adjustment_interval != 0:
             return
 
-        # 计算平均响应时间
         avg_time = sum(self.recent_times) / len(self.recent_times)
-        self.recent_times = []  # 清空
+        self.recent_times = []
+        self.last_avg_response = avg_time
 
         async with self.lock:
             old_limit = self.current_limit
+            queue_depth = len(self._waiters)
+            saturated = queue_depth > 0 or self._in_flight >= self.current_limit
+
+            if avg_time > self.target_response_time * 1.5 or (
+                queue_depth > 0 and avg_time > self.target_response_time
+            ):
+                # 乘性减：过载时快速退避
+                new_limit = max(self.min_concurrent, self.current_limit // 2)
+            elif avg_time < self.target_response_time * 0.5 and saturated:
+                # 加性增：健康且确有排队需求时线性试探
+                new_limit = min(self.max_concurrent, self.current_limit + 1)
+            else:
+                new_limit = self.current_limit
+
+            if new_limit != old_limit:
+                self.current_limit = new_limit
+                logger.info(f"Adjusted concurrent limit: {old_limit} -> {new_limit}")
+                # 容量增大时唤醒排队的等待者；
+                # 缩容无需动作，在途查询结束后自然收敛到新上限
+                if new_limit > old_limit:
+                    self._grant_next()
+
+    def get_current_limit(self) -> int:
+        """获取当前并发限制"""
+        return self.current_limit
+
+    def get_stats(self) -> dict:
+        """获取控制器状态"""
+        return {
+            "current_limit": self.current_limit,
+            "in_flight": self._in_flight,
+            "queue_depth": len(self._waiters),
+            "min_concurrent": self.min_concurrent,
+            "max_concurrent": self.max_concurrent,
+            "last_avg_response": round(self.last_avg_response, 3),
+        }
+
+
+class PriorityScheduler:
+    """优先级查询调度器
+
+    在执行槽位前放一个优先级队列，替代普通信号量：
+    - 有空闲槽位且无等待者时直接执行
+    - 槽位耗尽时按优先级排队（同优先级 FIFO）
+    - 槽位释放时优先唤醒高优先级等待者
+
+    这样低复杂度的交互式查询（如 cpg.method.name 查找）
+    不会排在已入队的重量级 reachableBy/flows 扫描之后。
+    """
+
+    def __init__(
+        self,
+        min_concurrent: int = 5,
+        max_concurrent: int = 20,
+        target_response_time: float = 1.0,  # 目标响应时间（秒）
+    ):
+        self.min_concurrent = min_concurrent
+        self.max_concurrent = max_concurrent
+        self.current_limit = min_concurrent
+        self.target_response_time = target_response_time
+
+        # 执行槽位状态
+        self._in_flight = 0
+        # 等待队列（最小堆，优先级取负实现最大堆，计数器保证同优先级FIFO）
+        self._waiters: list[tuple[int, int, asyncio.Future]] = []
+        self._counter = 0
+        self.lock = asyncio.Lock()
 
-            # 响应时间过长，减少并发
-            if avg_time > self.target_response_time * 1.5:
-                new_limit = max(self.min_concurrent, self.current_limit - 2)
-            # 响应时间很快，增加并发
-            elif avg_time < self.target_response_time * 0.5:
-                new_limit = min(self.max_concurrent, self.current_limit + 2)
+        # 性能监控（用于并发限制调整）
+        self.recent_times: list = []
+        self.adjustment_interval = 10  # 每10次查询评估一次
+        self.query_count = 0
+        self.last_avg_response = 0.0
+
+    async def acquire(self, priority: int = 3) -> None:
+        """获取执行槽位
+
+        Args:
+            priority: 查询优先级（1-5，5最高）
+        """
+        if self._in_flight < self.current_limit and not self._waiters:
+            self._in_flight += 1
+            return
+
+        future: asyncio.Future = asyncio.get_event_loop().create_future()
+        self._counter += 1
+        heapq.heappush(self._waiters, (-priority, self._counter, future))
+
+        try:
+            await future
+        except asyncio.CancelledError:
+            # 如果在取消前已被授予槽位，需要归还
+            if future.done() and not future.cancelled():
+                self.release()
+            raise
+
+    def release(self) -> None:
+        """释放执行槽位并唤醒下一个等待者"""
+        self._in_flight -= 1
+        self._grant_next()
+
+    def _grant_next(self) -> None:
+        """按优先级授予空闲槽位"""
+        while self._waiters and self._in_flight < self.current_limit:
+            _, _, future = heapq.heappop(self._waiters)
+            if future.done():
+                # 等待者已取消，跳过
+                continue
+            self._in_flight += 1
+            future.set_result(True)
+
+    async def adjust(self, response_time: float):
+        """根据响应时间调整并发限制
+
+        与 AdaptiveSemaphore 不同，这里只更新容量计数，
+        不会重建任何同步原语，等待者和在途查询不受影响。
+        """
+        self.recent_times.append(response_time)
+        self.query_count += 1
+
+        # 每N次查询评估一次
+        if self.query_count % self.adjustment_interval != 0:
+            return
+
+        avg_time = sum(self.recent_times) / len(self.recent_times)
+        self.recent_times = []
+        self.last_avg_response = avg_time
+
+        async with self.lock:
+            old_limit = self.current_limit
+            queue_depth = len(self._waiters)
+
+            # AIMD：过载（响应显著超标，或有排队且响应不达标）时乘性减，
+            # 健康且有排队需求时加性增（与 AdaptiveSemaphore 同一策略）
+            if avg_time > self.target_response_time * 1.5 or (
+                queue_depth > 0 and avg_time > self.target_response_time
+            ):
+                new_limit = max(self.min_concurrent, self.current_limit // 2)
+            elif avg_time < self.target_response_time * 0.5 and (
+                queue_depth > 0 or self._in_flight >= self.current_limit
+            ):
+                new_limit = min(self.max_concurrent, self.current_limit + 1)
             else:
                 new_limit = self.current_limit
 
             if new_limit != old_limit:
                 self.current_limit = new_limit
-                # 重新创建信号量
-                self.semaphore = asyncio.Semaphore(self.current_limit)
                 logger.info(f"Adjusted concurrent limit: {old_limit} -> {new_limit}")
+                # 容量增大时唤醒排队的等待者
+                if new_limit > old_limit:
+                    self._grant_next()
 
     def get_current_limit(self) -> int:
         """获取当前并发限制"""
         return self.current_limit
 
+    def get_stats(self) -> dict:
+        """获取调度器状态"""
+        return {
+            "current_limit": self.current_limit,
+            "in_flight": self._in_flight,
+            "queue_depth": len(self._waiters),
+            "min_concurrent": self.min_concurrent,
+            "max_concurrent": self.max_concurrent,
+            "last_avg_response": round(self.last_avg_response, 3),
+        }
+
 
 class QueryComplexityAnalyzer:
     """查询复杂度分析器"""
@@ -351,6 +914,170 @@ class QueryComplexityAnalyzer:
         }
 
 
+class QueryCostModel:
+    """在线学习的查询成本模型
+
+    QueryComplexityAnalyzer 只看查询文本（长度/嵌套/关键字），
+    会把代价极高的模式（如 .fullName 上的非锚定正则）误判为低复杂度。
+    本模型把查询按结构特征归桶（项目、遍历根、昂贵算子、非锚定正则、
+    长度/嵌套档位），用实际执行耗时的指数移动平均在线修正每个桶的
+    成本估计：
+
+    - 桶内样本不足时回退到启发式先验
+      （非锚定正则特征会抬高先验，不再被判为低成本）
+    - 样本足够后 complexity/estimated_time/priority 全部由
+      实测耗时推导，驱动超时放大、调度优先级和冷热缓存分层
+
+    同一结构的查询即使换了参数字面量也落在同一个桶里，
+    一次慢执行就能让后续同型查询得到正确的成本估计。
+    """
+
+    # 学习到的估计生效所需的最少样本数
+    MIN_SAMPLES = 3
+
+    # 非锚定正则先验：这类查询在大 CPG 上是全量扫描
+    UNANCHORED_REGEX_PRIOR = 6
+
+    def __init__(self, alpha: float = 0.3, max_signatures: int = 500):
+        self.analyzer = QueryComplexityAnalyzer()
+        self.alpha = alpha  # EWMA 平滑系数
+        self.max_signatures = max_signatures
+        # signature -> {"count", "ewma", "max"}
+        self._observed: dict[str, dict] = {}
+
+    # 昂贵算子列表（与启发式分析器保持一致，外加 dedup）
+    _EXPENSIVE_OPS = ("repeat", "flows", "reachableBy", "sinks", "sources", "dedup")
+
+    # 常见遍历根节点类型
+    _ROOT_PATTERN = re.compile(
+        r"\.(method|call|identifier|literal|typeDecl|parameter|local|file)\b"
+    )
+
+    _PROJECT_PATTERN = re.compile(r'workspace\.project\("([^"]+)"\)')
+
+    # .name/.fullName 的字符串参数（用于检测非锚定正则）
+    _NAME_ARG_PATTERN = re.compile(r'\.(?:fullName|name)\("([^"]*)"\)')
+
+    @classmethod
+    def _has_unanchored_regex(cls, query: str) -> bool:
+        """检测 .name/.fullName 上的非锚定正则参数
+
+        形如 .fullName(".*memcpy.*") 的模式无法利用索引，
+        退化为全节点扫描，是最容易被启发式漏判的昂贵形态。
+        """
+        for arg in cls._NAME_ARG_PATTERN.findall(query):
+            if ".*" in arg and not arg.startswith("^"):
+                return True
+        return False
+
+    def signature(self, query: str) -> str:
+        """提取查询的结构特征签名（成本桶的键）
+
+        同型查询（仅参数字面量不同）映射到同一签名，
+        项目不同的查询分开统计（项目规模直接影响耗时）。
+        """
+        project_match = self._PROJECT_PATTERN.search(query)
+        project = project_match.group(1) if project_match else "-"
+
+        root_match = self._ROOT_PATTERN.search(query)
+        root = root_match.group(1) if root_match else "other"
+
+        ops = ",".join(op for op in self._EXPENSIVE_OPS if op in query) or "-"
+
+        regex_flag = "1" if self._has_unanchored_regex(query) else "0"
+
+        length_bucket = min(len(query) // 100, 3)
+        heuristic = self.analyzer.analyze(query)
+        depth_bucket = min(heuristic["nesting_depth"], 3)
+
+        return (
+            f"proj={project}|root={root}|ops={ops}"
+            f"|regex={regex_flag}|len={length_bucket}|depth={depth_bucket}"
+        )
+
+    def observe(self, signature: str, duration: float) -> None:
+        """记录一次实际执行耗时，更新对应桶的 EWMA"""
+        entry = self._observed.get(signature)
+        if entry is None:
+            # 容量满时淘汰最老的桶
+            if len(self._observed) >= self.max_signatures:
+                oldest = next(iter(self._observed))
+                del self._observed[oldest]
+            self._observed[signature] = {
+                "count": 1,
+                "ewma": duration,
+                "max": duration,
+            }
+            return
+
+        entry["count"] += 1
+        entry["ewma"] = self.alpha * duration + (1 - self.alpha) * entry["ewma"]
+        entry["max"] = max(entry["max"], duration)
+
+    def analyze(self, query: str) -> dict:
+        """估计查询成本（优先实测，回退启发式）
+
+        返回与 QueryComplexityAnalyzer.analyze 相同的字段，
+        外加 signature/source/samples 用于观测模型行为。
+        """
+        heuristic = self.analyzer.analyze(query)
+        signature = self.signature(query)
+        entry = self._observed.get(signature)
+
+        if entry is not None and entry["count"] >= self.MIN_SAMPLES:
+            # 实测驱动：用 EWMA 反推 complexity（estimated_time = c * 0.5 的逆）
+            estimated_time = entry["ewma"]
+            complexity = max(1, min(10, round(estimated_time / 0.5)))
+            source = "learned"
+            samples = entry["count"]
+        else:
+            complexity = heuristic["complexity"]
+            estimated_time = heuristic["estimated_time"]
+            if self._has_unanchored_regex(query):
+                # 启发式先验修正：非锚定正则在学习到实测前按高成本处理
+                complexity = max(complexity, self.UNANCHORED_REGEX_PRIOR)
+                estimated_time = complexity * 0.5
+            source = "heuristic"
+            samples = entry["count"] if entry else 0
+
+        priority = max(1, min(5, 6 - (complexity // 2)))
+
+        return {
+            "complexity": complexity,
+            "estimated_time": round(estimated_time, 3),
+            "priority": priority,
+            "length": heuristic["length"],
+            "nesting_depth": heuristic["nesting_depth"],
+            "signature": signature,
+            "source": source,
+            "samples": samples,
+        }
+
+    def get_stats(self) -> dict:
+        """模型状态（桶数量与最贵的若干个桶）"""
+        top = sorted(
+            self._observed.items(), key=lambda kv: kv[1]["ewma"], reverse=True
+        )[:10]
+        return {
+            "signatures": len(self._observed),
+            "top_cost_buckets": [
+                {
+                    "signature": sig,
+                    "count": entry["count"],
+                    "avg_time": round(entry["ewma"], 3),
+                    "max_time": round(entry["max"], 3),
+                }
+                for sig, entry in top
+            ],
+        }
+
+
+def extract_project_name(query: str) -> str | None:
+    """从查询前缀提取项目名，用作指标的 by_project 维度"""
+    match = QueryCostModel._PROJECT_PATTERN.search(query)
+    return match.group(1) if match else None
+
+
 class SlowQueryLogger:
     """慢查询日志"""
 
@@ -398,3 +1125,22 @@ def reset_metrics():
     """重置性能指标"""
     global _global_metrics
     _global_metrics = PerformanceMetrics()
+
+
+@contextmanager
+def trace_stage(stage: str):
+    """测量查询管线中一个阶段的耗时并记入全局指标
+
+    用法:
+        with trace_stage("query_post"):
+            response = await client.post(...)
+
+    阶段名约定（见 OptimizedQueryExecutor 与 JoernHTTPClient）:
+        scheduler_wait / server_execute / ws_connect /
+        query_post / joern_execute / result_get / response_parse
+    """
+    start = time.perf_counter()
+    try:
+        yield
+    finally:
+        get_metrics().record_stage(stage, time.perf_counter() - start)
@@ -4,12 +4,37 @@
 - 验证项目存在性
 - 安全获取项目 CPG
 - 构建安全的查询前缀
+
+验证结果缓存在进程内目录（workspace catalog）中，
+以 CPG 代数为键：同一项目在代数未变化时免去每次调用的
+Joern 往返验证，parse/delete 等操作递增代数后自动重新验证。
 """
 
 import re
 
 from loguru import logger
 
+from joern_mcp.utils.cpg_generation import get_generation
+
+# 已验证项目目录：project_name -> 验证通过时的 CPG 代数
+# parse_project/delete_project 递增代数后条目自动失效（代数不匹配）
+_validated_catalog: dict[str, int] = {}
+
+
+def invalidate_catalog(project_name: str | None = None) -> None:
+    """使目录缓存失效
+
+    常规失效由 CPG 代数机制自动完成；此函数供
+    Joern 进程重启等 workspace 状态整体丢失的场景显式调用。
+
+    Args:
+        project_name: 指定项目（None 表示清空全部）
+    """
+    if project_name is None:
+        _validated_catalog.clear()
+    else:
+        _validated_catalog.pop(project_name, None)
+
 
 def _parse_boolean_result(stdout: str) -> bool | None:
     """解析 Joern 返回的布尔值结果
@@ -234,6 +259,8 @@ async def get_safe_cpg_prefix(
     """安全地获取 CPG 访问前缀
 
     此函数会先验证项目存在性，然后返回前缀。
+    验证结果按 CPG 代数缓存：同一代数内的后续调用
+    直接命中目录缓存（字典查找），省去一次 Joern 往返。
 
     Args:
         query_executor: 查询执行器
@@ -250,9 +277,18 @@ async def get_safe_cpg_prefix(
             "project_name is required. Use list_projects to see available projects.",
         )
 
+    prefix = f'workspace.project("{project_name}").get.cpg.get'
+
+    # 目录缓存命中：代数未变化，免验证往返
+    generation = get_generation(project_name)
+    if _validated_catalog.get(project_name) == generation:
+        return prefix, None
+
     # 验证项目和 CPG
     has_cpg, error = await validate_project_has_cpg(query_executor, project_name)
     if not has_cpg:
+        _validated_catalog.pop(project_name, None)
         return None, error
 
-    return f'workspace.project("{project_name}").get.cpg.get', None
+    _validated_catalog[project_name] = generation
+    return prefix, None
@@ -0,0 +1,86 @@
+"""CPGQL 查询投影下推
+
+裸遍历（如 ``cpg.method``）直接 .toJson 会序列化完整节点对象，
+而调用方往往只需要名称和行号。本模块在序列化之前把投影下推到
+遍历末尾：调用方声明需要的字段，查询被改写为
+``.map(x => Map("name" -> x.name, ...))``（与 templates.py 中
+手写模板的形状一致）。方法/调用列表类查询的载荷通常缩小
+10-50 倍，JVM 序列化、传输和客户端解析时间同步下降。
+
+已经自带投影（.map）或终结操作（.size/.toDot 等）的查询
+保持原样，不做改写。
+"""
+
+import re
+
+# 注入投影前需要剥离的终结后缀
+# （executor 会在最终查询上重新追加 .toJson）
+_TERMINAL_SUFFIXES = (".toJson", ".toList", ".l")
+
+# 查询已自带投影或以标量/非集合终结时跳过改写
+_SKIP_PATTERN = re.compile(r"\.map\s*\(|\.collect\s*\{|\.toDot\b|\.size\s*$")
+
+# 字段名白名单之外的字段必须是合法标识符（直接透传为属性访问）
+_IDENTIFIER = re.compile(r"^[A-Za-z_][A-Za-z0-9_]*$")
+
+# Option[Int] 类型的位置字段：缺失时统一取 -1（与 templates.py 一致）
+_OPTIONAL_INT_FIELDS = {
+    "lineNumber",
+    "lineNumberEnd",
+    "columnNumber",
+    "columnNumberEnd",
+}
+
+# 需要特殊遍历步骤的字段
+# filename 用 .file 步骤取：method 节点有 filename 属性但 call 节点没有，
+# .file.name.headOption 对两者都适用
+_SPECIAL_ACCESSORS = {
+    "filename": 'x.file.name.headOption.getOrElse("<unknown>")',
+    "file": 'x.file.name.headOption.getOrElse("<unknown>")',
+}
+
+
+def _field_accessor(field: str) -> str:
+    """生成单个字段的取值表达式"""
+    if field in _SPECIAL_ACCESSORS:
+        return _SPECIAL_ACCESSORS[field]
+    if field in _OPTIONAL_INT_FIELDS:
+        return f"x.{field}.getOrElse(-1)"
+    return f"x.{field}"
+
+
+def apply_projection(query: str, fields: list[str]) -> str:
+    """把字段投影下推到遍历末尾
+
+    Args:
+        query: CPGQL 遍历（应返回节点集合）
+        fields: 需要的字段名列表（如 ["name", "filename", "lineNumber"]）
+
+    Returns:
+        str: 注入 .map(x => Map(...)) 后的查询；
+             查询已自带投影/终结操作或 fields 为空时原样返回
+
+    Raises:
+        ValueError: 字段名不是合法标识符
+    """
+    if not fields:
+        return query
+
+    stripped = query.strip()
+    for suffix in _TERMINAL_SUFFIXES:
+        if stripped.endswith(suffix):
+            stripped = stripped[: -len(suffix)].rstrip()
+            break
+
+    # 已有投影或标量终结的查询不重复改写
+    if _SKIP_PATTERN.search(stripped):
+        return query
+
+    entries = []
+    for field in fields:
+        if not _IDENTIFIER.match(field):
+            raise ValueError(f"Invalid projection field: {field!r}")
+        entries.append(f'"{field}" -> {_field_accessor(field)}')
+
+    mapping = ", ".join(entries)
+    return f"{stripped}.map(x => Map({mapping}))"
@@ -0,0 +1,162 @@
+"""慢查询顾问：识别并改写已知病态的 CPGQL 模式
+
+LLM 生成的查询反复出现几类代价极高的写法：
+
+- 纯字面量参数走正则匹配：``.name("main")`` 是全量正则扫描，
+  ``.nameExact("main")`` 走索引，两者结果完全一致
+- 过早 ``.l`` 物化：``.l.filter(...)`` 先把整个遍历拉成列表再过滤，
+  去掉 ``.l`` 保持惰性遍历语义不变
+- 非锚定正则（``.*foo.*``）、调用关系展开后缺 ``.dedup``、
+  未锚定源/汇就上 ``reachableBy`` 等无法安全自动改写的模式
+
+本模块对前两类做语义保持的自动改写（改写记录随结果返回），
+对后几类生成结构化提示附在查询结果上，调用方（通常是 LLM）
+可以据此修正后续查询。
+"""
+
+import re
+
+# 含这些字符的参数视为正则，不能安全改写为 Exact 变体
+_REGEX_META = re.compile(r"[.*+?\[\](){}|\\^$]")
+
+# 支持 Exact 变体的属性过滤步骤
+_EXACT_REWRITABLE = ("name", "fullName", "methodFullName", "typeFullName", "signature")
+
+_LITERAL_FILTER_PATTERN = re.compile(
+    r"\.(name|fullName|methodFullName|typeFullName|signature)\(\"([^\"]*)\"\)"
+)
+
+# .l 之后还接遍历/集合操作：物化是多余的
+_EAGER_MATERIALIZE_PATTERN = re.compile(
+    r"\.l\.(filter|filterNot|map|flatMap|take|drop|dedup|sortBy|groupBy)\b"
+)
+
+# 非锚定正则参数（.* 开头且未用 ^ 锚定）
+_UNANCHORED_REGEX_PATTERN = re.compile(
+    r"\.(?:name|fullName|methodFullName)\(\"(\.\*[^\"]*)\"\)"
+)
+
+# 调用关系展开步骤（路径爆炸时产生大量重复节点）
+_CALL_EXPANSION_PATTERN = re.compile(r"\.(caller|callee|callIn)\b")
+
+
+class QueryAdvisor:
+    """查询顾问（改写 + 提示）"""
+
+    def advise(self, query: str) -> dict:
+        """分析查询，执行安全改写并生成提示
+
+        Args:
+            query: 原始 CPGQL 查询
+
+        Returns:
+            dict:
+                - query: 改写后的查询（无改写时与原查询相同）
+                - rewrites: 已执行的改写记录列表
+                - hints: 无法自动改写的优化提示列表
+        """
+        rewrites: list[dict] = []
+        hints: list[dict] = []
+
+        query = self._rewrite_literal_filters(query, rewrites)
+        query = self._rewrite_eager_materialization(query, rewrites)
+
+        self._hint_unanchored_regex(query, hints)
+        self._hint_missing_dedup(query, hints)
+        self._hint_unanchored_dataflow(query, hints)
+
+        return {"query": query, "rewrites": rewrites, "hints": hints}
+
+    @staticmethod
+    def _rewrite_literal_filters(query: str, rewrites: list[dict]) -> str:
+        """纯字面量的 .name("x") 改写为索引查找 .nameExact("x")
+
+        Joern 的属性过滤是全匹配正则，字面量参数下
+        Exact 变体结果完全一致且走索引，免去全节点扫描。
+        """
+
+        def replace(match: re.Match) -> str:
+            step, arg = match.group(1), match.group(2)
+            if not arg or _REGEX_META.search(arg):
+                return match.group(0)
+            rewritten = f'.{step}Exact("{arg}")'
+            rewrites.append(
+                {
+                    "type": "literal_to_exact",
+                    "original": match.group(0),
+                    "rewritten": rewritten,
+                    "reason": f"字面量参数走索引查找（{step}Exact），避免全量正则扫描",
+                }
+            )
+            return rewritten
+
+        return _LITERAL_FILTER_PATTERN.sub(replace, query)
+
+    @staticmethod
+    def _rewrite_eager_materialization(query: str, rewrites: list[dict]) -> str:
+        """去掉过滤/映射之前多余的 .l 物化
+
+        .l.filter(...) 先物化整个遍历再过滤；
+        去掉 .l 保持惰性，结果不变。
+        """
+
+        def replace(match: re.Match) -> str:
+            op = match.group(1)
+            rewrites.append(
+                {
+                    "type": "lazy_traversal",
+                    "original": f".l.{op}",
+                    "rewritten": f".{op}",
+                    "reason": "过滤前的 .l 物化整个遍历，去掉后保持惰性求值",
+                }
+            )
+            return f".{op}"
+
+        return _EAGER_MATERIALIZE_PATTERN.sub(replace, query)
+
+    @staticmethod
+    def _hint_unanchored_regex(query: str, hints: list[dict]) -> None:
+        """非锚定正则无法改写（语义是子串匹配），给出提示"""
+        for match in _UNANCHORED_REGEX_PATTERN.finditer(query):
+            hints.append(
+                {
+                    "type": "unanchored_regex",
+                    "pattern": match.group(0),
+                    "message": (
+                        f"非锚定正则 {match.group(1)!r} 强制全节点扫描；"
+                        "已知完整名称时请用 nameExact/fullNameExact，"
+                        "或用 ^ 锚定前缀缩小扫描范围"
+                    ),
+                }
+            )
+
+    @staticmethod
+    def _hint_missing_dedup(query: str, hints: list[dict]) -> None:
+        """调用关系展开后缺 .dedup 的提示"""
+        if _CALL_EXPANSION_PATTERN.search(query) and ".dedup" not in query:
+            hints.append(
+                {
+                    "type": "missing_dedup",
+                    "message": (
+                        "caller/callee/callIn 展开常产生重复节点，"
+                        "追加 .dedup 可显著缩小结果集和序列化开销"
+                    ),
+                }
+            )
+
+    @staticmethod
+    def _hint_unanchored_dataflow(query: str, hints: list[dict]) -> None:
+        """reachableBy 的源/汇未锚定的提示"""
+        if "reachableBy" not in query:
+            return
+        # 源或汇直接挂在裸 cpg.call / cpg.method 上（无名称过滤）
+        if re.search(r"cpg\.(call|method)\.(argument|parameter)", query):
+            hints.append(
+                {
+                    "type": "unanchored_dataflow",
+                    "message": (
+                        "reachableBy 的源/汇建议先用 nameExact 锚定到具体函数，"
+                        "全量节点间的可达性求解是指数级开销"
+                    ),
+                }
+            )
@@ -6,15 +6,32 @@ Joern Server 响应解析工具
 - 处理双重 JSON 编码
 - 清理 ANSI 颜色码（现已在 HTTP 客户端层完成）
 - 解析 Scala 原生格式（如 List, String 等）
+- 流式解析大结果集（iter_parse_joern_response，峰值内存与单条记录成正比）
 """
 
 import contextlib
 import json
 import re
+from collections.abc import Iterable, Iterator
+from itertools import chain
 from typing import Any
 
 from loguru import logger
 
+# 快速 JSON 后端：orjson 对大 payload 的解码速度是标准库的数倍
+try:
+    import orjson
+
+    def _fast_loads(text: str) -> Any:
+        try:
+            return orjson.loads(text)
+        except orjson.JSONDecodeError as e:
+            # 统一为标准库异常类型，调用方的 except 子句不受影响
+            raise json.JSONDecodeError(str(e), text, 0) from None
+
+except ImportError:  # pragma: no cover - orjson 在依赖清单中
+    _fast_loads = json.loads
+
 
 def _parse_scala_string(value: str) -> str:
     """解析 Scala 字符串值
@@ -131,7 +148,7 @@ def _recursively_parse_json(data: Any, max_depth: int = 10) -> Any:
 
         # 尝试解析为 JSON
         with contextlib.suppress(json.JSONDecodeError):
-            parsed = json.loads(data_stripped)
+            parsed = _fast_loads(data_stripped)
             return _recursively_parse_json(parsed, max_depth - 1)
 
         return data_stripped
@@ -182,7 +199,7 @@ def parse_joern_response(stdout: str) -> Any:
 
     # 尝试方法 1: 直接解析 JSON
     try:
-        data = json.loads(clean_output)
+        data = _fast_loads(clean_output)
         # 递归处理多重编码
         return _recursively_parse_json(data)
     except json.JSONDecodeError:
@@ -198,7 +215,7 @@ def parse_joern_response(stdout: str) -> Any:
 
         # 2a: 尝试解析为 JSON
         try:
-            data = json.loads(value_part)
+            data = _fast_loads(value_part)
             return _recursively_parse_json(data)
         except json.JSONDecodeError:
             pass
@@ -215,7 +232,7 @@ def parse_joern_response(stdout: str) -> Any:
     json_match = re.search(r"(\[.*\]|\{.*\})", clean_output, re.DOTALL)
     if json_match:
         try:
-            data = json.loads(json_match.group(1))
+            data = _fast_loads(json_match.group(1))
             return _recursively_parse_json(data)
         except json.JSONDecodeError:
             pass
@@ -243,8 +260,11 @@ def safe_parse_joern_response(stdout: str, default: Any = None) -> Any:
     Returns:
         解析后的数据或默认值
     """
+    from joern_mcp.utils.performance import trace_stage
+
     try:
-        return parse_joern_response(stdout)
+        with trace_stage("response_parse"):
+            return parse_joern_response(stdout)
     except (ValueError, json.JSONDecodeError) as e:
         logger.debug(f"Failed to parse response: {e}")
         return default if default is not None else []
@@ -275,3 +295,248 @@ def extract_json_from_repl(stdout: str) -> str | None:
         return match.group(1).strip()
 
     return None
+
+
+# ===== 流式解析 =====
+# parse_joern_response 要求整段 stdout 驻留内存并做全文正则，
+# 300MB 级别的数据流导出会把事件循环卡住数十秒。
+# 下面的增量路径按块消费输入，逐条产出数组元素，
+# 峰值内存与最大的单条记录成正比，正则预过滤只作用于有界前缀。
+
+# REPL 前导（val resN: Type = ）只会出现在输出头部的有界范围内
+_STREAM_PREFIX_LIMIT = 4096
+_REPL_PREAMBLE_RE = re.compile(r"^\s*val\s+\w+:\s*[\w\[\]]+\s*=\s*")
+
+# JSON 字符串转义解码（流式去包裹用）
+_JSON_ESCAPE_RE = re.compile(r'\\(["\\/bfnrt]|u[0-9a-fA-F]{4})')
+_JSON_ESCAPE_MAP = {
+    '"': '"',
+    "\\": "\\",
+    "/": "/",
+    "b": "\b",
+    "f": "\f",
+    "n": "\n",
+    "r": "\r",
+    "t": "\t",
+}
+
+
+def _decode_json_escapes(text: str) -> str:
+    """解码一段 JSON 字符串内容的转义序列"""
+
+    def replace(match: re.Match) -> str:
+        escaped = match.group(1)
+        if escaped.startswith("u"):
+            return chr(int(escaped[1:], 16))
+        return _JSON_ESCAPE_MAP[escaped]
+
+    return _JSON_ESCAPE_RE.sub(replace, text)
+
+
+def _unescape_stream(chunks: Iterable[str]) -> Iterator[str]:
+    """流式解码字符串包裹 payload 的转义序列
+
+    块边界可能切断转义序列（尾部的 \\ 或不完整的 \\uXXXX），
+    此时把尾巴留到下一块一起解码。
+    """
+    pending = ""
+    for chunk in chunks:
+        text = pending + chunk
+        pending = ""
+
+        # 尾部奇数个反斜杠：转义被切断
+        backslashes = len(text) - len(text.rstrip("\\"))
+        if backslashes % 2 == 1:
+            pending = text[-1]
+            text = text[:-1]
+        else:
+            # 尾部不完整的 \uXXXX
+            u_pos = text.rfind("\\u", max(0, len(text) - 6))
+            if u_pos != -1 and len(text) - u_pos < 6:
+                pending = text[u_pos:]
+                text = text[:u_pos]
+
+        if text:
+            yield _decode_json_escapes(text)
+
+    if pending:
+        yield _decode_json_escapes(pending)
+
+
+def _iter_array_elements(chunks: Iterable[str]) -> Iterator[Any]:
+    """增量扫描顶层 JSON 数组，逐条解析并产出元素
+
+    已消费的缓冲区前缀会被丢弃，内存占用与单个元素成正比。
+    """
+    iterator = iter(chunks)
+    buffer = ""
+    pos = 0
+    started = False
+    depth = 0
+    in_string = False
+    escaped = False
+    element_start = -1
+
+    while True:
+        if pos >= len(buffer):
+            try:
+                incoming = next(iterator)
+            except StopIteration:
+                return
+            # 丢弃已消费的前缀，保证内存有界
+            if element_start == -1:
+                buffer = ""
+                pos = 0
+            elif element_start > 0:
+                buffer = buffer[element_start:]
+                pos -= element_start
+                element_start = 0
+            buffer += incoming
+            continue
+
+        ch = buffer[pos]
+
+        if not started:
+            if ch == "[":
+                started = True
+                depth = 1
+            elif not ch.isspace():
+                raise ValueError(f"Not a JSON array (starts with {ch!r})")
+            pos += 1
+            continue
+
+        if in_string:
+            if escaped:
+                escaped = False
+            elif ch == "\\":
+                escaped = True
+            elif ch == '"':
+                in_string = False
+            pos += 1
+            continue
+
+        if ch == '"':
+            in_string = True
+            if element_start == -1:
+                element_start = pos
+        elif ch in "{[":
+            depth += 1
+            if element_start == -1:
+                element_start = pos
+        elif ch in "}]":
+            depth -= 1
+            if depth == 0:
+                # 数组闭合，产出最后一个元素
+                if element_start != -1:
+                    text = buffer[element_start:pos].strip()
+                    if text:
+                        yield _fast_loads(text)
+                return
+        elif ch == "," and depth == 1:
+            if element_start != -1:
+                text = buffer[element_start:pos].strip()
+                if text:
+                    yield _fast_loads(text)
+                element_start = -1
+        elif not ch.isspace() and element_start == -1 and depth == 1:
+            # 标量元素（数字、true/false/null）的起点
+            element_start = pos
+
+        pos += 1
+
+
+def iter_parse_joern_response(
+    source: str | Iterable[str], decode_nested: bool = True
+) -> Iterator[Any]:
+    """
+    流式解析 Joern Server 响应，逐条产出结果
+
+    与 parse_joern_response 不同，输入可以是分块的字符串迭代器，
+    顶层 JSON 数组（含字符串包裹的转义形式）按元素增量解析，
+    不要求整个 payload 驻留内存。REPL 前导的正则识别只在
+    头部有界前缀上进行。
+
+    非数组 payload（对象/标量/Scala List 等）退回到整体解析，
+    作为单个结果产出。
+
+    Args:
+        source: 完整 stdout 字符串或字符串块迭代器
+        decode_nested: 是否对每条元素递归解码多重 JSON 编码
+
+    Yields:
+        解析后的单条结果
+
+    Example:
+        >>> for flow in iter_parse_joern_response(chunks):
+        ...     process(flow)
+    """
+    # 记录消费过的原始输入，非数组 payload 回退整体解析时重放
+    consumed: list[str] = []
+
+    def _record(iterator: Iterator[str]) -> Iterator[str]:
+        for item in iterator:
+            consumed.append(item)
+            yield item
+
+    chunks = _record(iter([source]) if isinstance(source, str) else iter(source))
+
+    # 收集有界头部，剥离 REPL 前导和字符串包裹
+    head = ""
+    for chunk in chunks:
+        head += chunk
+        if len(head) >= _STREAM_PREFIX_LIMIT:
+            break
+        stripped = head.lstrip()
+        if stripped and stripped[0] in '[{"':
+            break
+
+    preamble = _REPL_PREAMBLE_RE.match(head)
+    if preamble:
+        head = head[preamble.end() :]
+    head = head.lstrip()
+
+    # 剥离多余的双引号包裹（如 ""[...]""）
+    while head.startswith('""'):
+        head = head[2:]
+
+    wrapped = False
+    if head.startswith('"') and not head.startswith('"['):
+        # 字符串包裹的 payload：流式解码转义后再扫描
+        head = head[1:]
+        wrapped = True
+    elif head.startswith('"['):
+        head = head[1:]
+        wrapped = True
+
+    stream: Iterable[str] = chain([head], chunks)
+    if wrapped:
+        stream = _unescape_stream(stream)
+        # 解码后可能仍有引号包裹层
+        stream = iter(stream)
+        first = next(stream, "")
+        first = first.lstrip()
+        while first.startswith('"'):
+            first = first[1:]
+        stream = chain([first], stream)
+
+    try:
+        yield from (
+            _recursively_parse_json(item) if decode_nested else item
+            for item in _iter_array_elements(stream)
+        )
+    except ValueError:
+        # 非数组 payload：退回整体解析（内存特征与旧路径一致）
+        for _ in chunks:
+            pass
+        remainder = "".join(consumed)
+        if not remainder.strip():
+            return
+        try:
+            result = parse_joern_response(remainder)
+        except (ValueError, json.JSONDecodeError) as e:
+            logger.debug(f"Streaming fallback parse failed: {e}")
+            return
+        if isinstance(result, list):
+            yield from result
+        else:
+            yield result
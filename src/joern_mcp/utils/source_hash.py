@@ -0,0 +1,162 @@
+"""源码内容哈希快照
+
+为增量解析和 CPG 新鲜度检查提供支持：
+- 每次成功导入后记录源码树的逐文件内容哈希
+- 下次导入前对比哈希，识别未变化/变化的文件子集
+- 快照持久化到磁盘（与 CPG 缓存同目录），跨进程重启可用
+"""
+
+import hashlib
+import json
+from pathlib import Path
+
+from loguru import logger
+
+from joern_mcp.config import settings
+
+# 参与哈希的源码文件扩展名（与 Joern 支持的语言前端对应）
+SOURCE_EXTENSIONS = {
+    ".c",
+    ".h",
+    ".cpp",
+    ".cc",
+    ".cxx",
+    ".hpp",
+    ".java",
+    ".js",
+    ".jsx",
+    ".ts",
+    ".tsx",
+    ".py",
+    ".kt",
+    ".kts",
+    ".go",
+    ".scala",
+    ".php",
+    ".rb",
+    ".swift",
+}
+
+
+def _snapshot_dir() -> Path:
+    """快照文件目录"""
+    return settings.joern_cpg_cache / "source_hashes"
+
+
+def _snapshot_file(project_name: str) -> Path:
+    """项目快照文件路径（项目名做简单清洗避免路径穿越）"""
+    safe_name = "".join(c if c.isalnum() or c in "-_." else "_" for c in project_name)
+    return _snapshot_dir() / f"{safe_name}.json"
+
+
+def compute_source_hashes(source_path: str) -> dict[str, str]:
+    """计算源码树的逐文件内容哈希
+
+    Args:
+        source_path: 源码根目录
+
+    Returns:
+        {相对路径: md5哈希} 映射
+    """
+    root = Path(source_path)
+    hashes: dict[str, str] = {}
+
+    if root.is_file():
+        hashes[root.name] = hashlib.md5(root.read_bytes()).hexdigest()
+        return hashes
+
+    for file_path in sorted(root.rglob("*")):
+        if not file_path.is_file():
+            continue
+        if file_path.suffix.lower() not in SOURCE_EXTENSIONS:
+            continue
+        try:
+            rel_path = str(file_path.relative_to(root))
+            hashes[rel_path] = hashlib.md5(file_path.read_bytes()).hexdigest()
+        except OSError as e:
+            logger.debug(f"Skipping unreadable file {file_path}: {e}")
+
+    return hashes
+
+
+def newest_source_mtime(source_path: str) -> float:
+    """返回源码树中最新源文件的修改时间（秒级时间戳）
+
+    用于预构建 CPG 的 mtime 新鲜度比较；
+    无源文件或不可读时返回 0.0（视为"没有更新的源码"）。
+    """
+    root = Path(source_path)
+    newest = 0.0
+
+    try:
+        if root.is_file():
+            return root.stat().st_mtime
+
+        for file_path in root.rglob("*"):
+            if not file_path.is_file():
+                continue
+            if file_path.suffix.lower() not in SOURCE_EXTENSIONS:
+                continue
+            try:
+                newest = max(newest, file_path.stat().st_mtime)
+            except OSError:
+                continue
+    except OSError as e:
+        logger.debug(f"Failed to scan {source_path} for mtimes: {e}")
+
+    return newest
+
+
+def load_snapshot(project_name: str) -> dict[str, str] | None:
+    """加载项目上次导入时的哈希快照（无快照返回 None）"""
+    snapshot_file = _snapshot_file(project_name)
+    if not snapshot_file.exists():
+        return None
+    try:
+        return json.loads(snapshot_file.read_text(encoding="utf-8"))
+    except (json.JSONDecodeError, OSError) as e:
+        logger.warning(f"Failed to load source snapshot for {project_name}: {e}")
+        return None
+
+
+def save_snapshot(project_name: str, hashes: dict[str, str]) -> None:
+    """保存项目的哈希快照"""
+    try:
+        _snapshot_dir().mkdir(parents=True, exist_ok=True)
+        _snapshot_file(project_name).write_text(
+            json.dumps(hashes), encoding="utf-8"
+        )
+    except OSError as e:
+        logger.warning(f"Failed to save source snapshot for {project_name}: {e}")
+
+
+def delete_snapshot(project_name: str) -> None:
+    """删除项目的哈希快照
+
+    项目从 workspace 删除时调用：残留的快照会让下一次
+    增量导入误判"源码未变化"，复用一个已不存在的 CPG。
+    """
+    try:
+        _snapshot_file(project_name).unlink(missing_ok=True)
+    except OSError as e:
+        logger.warning(f"Failed to delete source snapshot for {project_name}: {e}")
+
+
+def diff_snapshots(
+    old: dict[str, str], new: dict[str, str]
+) -> dict[str, list[str]]:
+    """对比两次快照，返回变化的文件集合
+
+    Returns:
+        {"added": [...], "removed": [...], "modified": [...]}
+    """
+    old_files = set(old)
+    new_files = set(new)
+
+    return {
+        "added": sorted(new_files - old_files),
+        "removed": sorted(old_files - new_files),
+        "modified": sorted(
+            f for f in old_files & new_files if old[f] != new[f]
+        ),
+    }
@@ -0,0 +1,111 @@
+"""流式结果导出
+
+export 工具的增量写出通道：结果按页追加写入 NDJSON 或 CSV，
+每页写完即释放，进程内存占用由页大小决定、与结果总量无关。
+可选 gzip 在线压缩（写入时逐块压缩，同样不驻留完整结果）。
+"""
+
+import csv
+import gzip
+from pathlib import Path
+from typing import Any
+
+import orjson
+
+EXPORT_FORMATS = ("ndjson", "csv")
+
+
+def open_export_stream(path: "Path | str", compress: bool = False):
+    """打开导出输出流
+
+    compress 为 True 时透明套一层 gzip，路径自动追加 .gz 后缀。
+
+    Returns:
+        tuple: (文本写入流, 实际输出路径)
+    """
+    output = Path(path)
+    output.parent.mkdir(parents=True, exist_ok=True)
+    if compress:
+        if output.suffix != ".gz":
+            output = output.with_name(output.name + ".gz")
+        return gzip.open(output, "wt", encoding="utf-8"), output
+    return output.open("w", encoding="utf-8"), output
+
+
+def flatten_record(record: dict, prefix: str = "") -> dict:
+    """把嵌套 dict 打平为点号分隔的单层键（CSV 列名）
+
+    Example:
+        >>> flatten_record({"sink": {"file": "a.c", "line": 3}})
+        {"sink.file": "a.c", "sink.line": 3}
+    """
+    flat: dict = {}
+    for key, value in record.items():
+        column = f"{prefix}.{key}" if prefix else str(key)
+        if isinstance(value, dict):
+            flat.update(flatten_record(value, column))
+        elif isinstance(value, (list, tuple)):
+            # 列表列（如路径元素）整体序列化为 JSON 字符串
+            flat[column] = orjson.dumps(value).decode("utf-8")
+        else:
+            flat[column] = value
+    return flat
+
+
+class StreamingExportWriter:
+    """按页增量写 NDJSON / CSV 的导出写入器
+
+    NDJSON 每条记录一行；CSV 列集取自第一条记录
+    （嵌套字段打平），后续记录缺失的列留空、多出的列忽略。
+
+    用法:
+        writer = StreamingExportWriter("/tmp/out.ndjson", compress=True)
+        try:
+            writer.write_rows(page1_items)
+            writer.write_rows(page2_items)
+        finally:
+            writer.close()
+    """
+
+    def __init__(
+        self,
+        path: "Path | str",
+        format: str = "ndjson",
+        compress: bool = False,
+    ):
+        if format not in EXPORT_FORMATS:
+            raise ValueError(f"Unsupported streaming format: {format}")
+        self.format = format
+        self.rows = 0
+        self._file, self.path = open_export_stream(path, compress)
+        self._csv_writer: "csv.DictWriter | None" = None
+
+    def write_rows(self, items: list) -> None:
+        """追加写入一页记录"""
+        for item in items:
+            if self.format == "ndjson":
+                self._file.write(orjson.dumps(item).decode("utf-8"))
+                self._file.write("\n")
+            else:
+                self._write_csv_row(item)
+            self.rows += 1
+
+    def _write_csv_row(self, item: Any) -> None:
+        record = flatten_record(item) if isinstance(item, dict) else {"value": item}
+        if self._csv_writer is None:
+            self._csv_writer = csv.DictWriter(
+                self._file,
+                fieldnames=list(record.keys()),
+                extrasaction="ignore",
+            )
+            self._csv_writer.writeheader()
+        self._csv_writer.writerow(record)
+
+    def close(self) -> None:
+        """关闭输出流（gzip 尾块在此落盘）"""
+        self._file.close()
+
+    def discard(self) -> None:
+        """关闭并删除输出文件（导出中途失败时清理残留）"""
+        self.close()
+        self.path.unlink(missing_ok=True)
@@ -58,6 +58,16 @@ def auto_mock_for_unit_tests(request, mock_project_validation):
         yield
 
 
+@pytest.fixture(autouse=True)
+def reset_flow_summary():
+    """每个测试从干净的汇摘要缓存开始（全局缓存不跨测试泄漏）"""
+    from joern_mcp.utils.flow_summary import reset_flow_summary_cache
+
+    reset_flow_summary_cache()
+    yield
+    reset_flow_summary_cache()
+
+
 @pytest.fixture
 def mock_joern_server():
     """Mock Joern Server Manager"""
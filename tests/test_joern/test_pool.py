@@ -0,0 +1,131 @@
+"""
+测试 Joern Server 进程池
+"""
+
+import asyncio
+from unittest.mock import AsyncMock, MagicMock
+
+import pytest
+
+from joern_mcp.joern.pool import JoernServerPool
+from joern_mcp.joern.server import JoernServerError
+
+
+def _make_mock_member(endpoint: str = "localhost:8080"):
+    """创建一个 mock 的池成员"""
+    member = MagicMock()
+    member.endpoint = endpoint
+    member.is_running.return_value = True
+    member.execute_query_async = AsyncMock(
+        return_value={"success": True, "stdout": "[]"}
+    )
+    member.import_code = AsyncMock(return_value={"success": True, "stdout": ""})
+    member.health_check = AsyncMock(return_value=True)
+    member.start = AsyncMock()
+    member.stop = AsyncMock()
+    return member
+
+
+class TestJoernServerPool:
+    """测试进程池路由逻辑"""
+
+    def test_pool_size_validation(self):
+        """池大小必须 >= 1"""
+        with pytest.raises(ValueError):
+            JoernServerPool(pool_size=0)
+
+    def test_pool_creation(self):
+        """创建指定大小的池"""
+        pool = JoernServerPool(pool_size=3)
+        assert pool.pool_size == 3
+        assert len(pool.members) == 3
+
+    @pytest.mark.asyncio
+    async def test_routes_to_least_loaded(self):
+        """查询路由到未完成工作最少的成员"""
+        pool = JoernServerPool(pool_size=2)
+        pool.members = [_make_mock_member("a:1"), _make_mock_member("b:2")]
+        pool._outstanding = [5, 1]
+
+        await pool.execute_query_async("cpg.method.size")
+
+        pool.members[1].execute_query_async.assert_awaited_once()
+        pool.members[0].execute_query_async.assert_not_awaited()
+
+    @pytest.mark.asyncio
+    async def test_skips_stopped_members(self):
+        """不路由到未运行的成员"""
+        pool = JoernServerPool(pool_size=2)
+        pool.members = [_make_mock_member(), _make_mock_member()]
+        pool.members[0].is_running.return_value = False
+
+        await pool.execute_query_async("cpg.method.size")
+
+        pool.members[1].execute_query_async.assert_awaited_once()
+
+    @pytest.mark.asyncio
+    async def test_no_running_members_raises(self):
+        """池中无运行成员时抛出错误"""
+        pool = JoernServerPool(pool_size=1)
+        pool.members = [_make_mock_member()]
+        pool.members[0].is_running.return_value = False
+
+        with pytest.raises(JoernServerError):
+            await pool.execute_query_async("cpg.method.size")
+
+    @pytest.mark.asyncio
+    async def test_outstanding_counter_released(self):
+        """查询结束后释放计数（包括异常路径）"""
+        pool = JoernServerPool(pool_size=1)
+        pool.members = [_make_mock_member()]
+        pool.members[0].execute_query_async = AsyncMock(
+            side_effect=Exception("boom")
+        )
+
+        with pytest.raises(Exception, match="boom"):
+            await pool.execute_query_async("cpg.method.size")
+
+        assert pool._outstanding == [0]
+
+    @pytest.mark.asyncio
+    async def test_import_code_broadcasts(self):
+        """导入代码广播到所有成员"""
+        pool = JoernServerPool(pool_size=3)
+        pool.members = [_make_mock_member() for _ in range(3)]
+
+        result = await pool.import_code("/path/to/code", "proj")
+
+        assert result["success"]
+        for member in pool.members:
+            member.import_code.assert_awaited_once_with("/path/to/code", "proj")
+
+    @pytest.mark.asyncio
+    async def test_concurrent_queries_spread(self):
+        """并发查询分摊到多个成员"""
+        pool = JoernServerPool(pool_size=2)
+        pool.members = [_make_mock_member("a:1"), _make_mock_member("b:2")]
+
+        async def slow_query(query):
+            await asyncio.sleep(0.05)
+            return {"success": True, "stdout": "[]"}
+
+        for member in pool.members:
+            member.execute_query_async = AsyncMock(side_effect=slow_query)
+
+        await asyncio.gather(
+            pool.execute_query_async("q1"), pool.execute_query_async("q2")
+        )
+
+        assert pool.members[0].execute_query_async.await_count == 1
+        assert pool.members[1].execute_query_async.await_count == 1
+
+    def test_pool_stats(self):
+        """池状态包含负载信息"""
+        pool = JoernServerPool(pool_size=2)
+        pool.members = [_make_mock_member("a:1"), _make_mock_member("b:2")]
+
+        stats = pool.get_pool_stats()
+
+        assert stats["pool_size"] == 2
+        assert stats["running"] == 2
+        assert stats["outstanding"] == [0, 0]
@@ -0,0 +1,147 @@
+"""测试预编译查询注册表"""
+
+from unittest.mock import AsyncMock, MagicMock
+
+import pytest
+
+from joern_mcp.joern.executor_optimized import OptimizedQueryExecutor
+from joern_mcp.joern.prepared import DEFINITIONS, PreparedQueryRegistry
+
+
+class TestPreparedQueryRegistry:
+    """注册表单元测试"""
+
+    def test_invocation_rendering(self):
+        """测试调用表达式渲染"""
+        registry = PreparedQueryRegistry()
+
+        call = registry.invocation("mcpGetCallers", "cpg", "main")
+        assert call == 'mcpGetCallers(cpg, "main")'
+
+    def test_invocation_with_project_prefix(self):
+        """测试 CPG 前缀表达式原样插入"""
+        registry = PreparedQueryRegistry()
+        prefix = 'workspace.project("demo").get.cpg.get'
+
+        call = registry.invocation("mcpGetCallees", prefix, "strcpy")
+
+        assert call.startswith(f"mcpGetCallees({prefix}, ")
+
+    def test_invocation_escapes_string_arguments(self):
+        """测试字符串参数的引号和反斜杠转义"""
+        registry = PreparedQueryRegistry()
+
+        call = registry.invocation("mcpGetCallers", "cpg", 'na"me\\x')
+
+        assert '"na\\"me\\\\x"' in call
+
+    def test_invocation_renders_int_arguments(self):
+        """测试整数参数按字面量渲染"""
+        registry = PreparedQueryRegistry()
+
+        call = registry.invocation("mcpTrackDataflow", "cpg", "gets", "strcpy", 10)
+
+        assert call.endswith(', "strcpy", 10)')
+
+    def test_invocation_unknown_name(self):
+        """测试未知函数名抛出异常"""
+        registry = PreparedQueryRegistry()
+
+        with pytest.raises(ValueError, match="Unknown prepared query"):
+            registry.invocation("mcpNotExist", "cpg")
+
+    def test_definitions_script_contains_all(self):
+        """测试安装脚本包含全部函数定义"""
+        registry = PreparedQueryRegistry()
+        script = registry.definitions_script()
+
+        for name in DEFINITIONS:
+            assert f"def {name}(" in script
+
+    def test_state_transitions(self):
+        """测试安装/失败/重置状态转换"""
+        registry = PreparedQueryRegistry()
+        assert registry.available and not registry.installed
+
+        registry.mark_installed()
+        assert registry.installed and registry.available
+
+        registry.mark_failed()
+        assert not registry.available
+
+        registry.reset()
+        assert registry.available and not registry.installed
+
+
+class TestExecutorPreparedPath:
+    """执行器预编译路径集成测试"""
+
+    def _make_executor(self):
+        mock_server = MagicMock()
+        mock_server.execute_query_async = AsyncMock(
+            return_value={"success": True, "stdout": "[]"}
+        )
+        return OptimizedQueryExecutor(mock_server), mock_server
+
+    @pytest.mark.asyncio
+    async def test_first_prepared_call_installs_definitions(self):
+        """测试首次预编译调用先注入函数定义"""
+        executor, mock_server = self._make_executor()
+
+        await executor.execute(
+            'cpg.method.name("main").callIn.dedup',
+            prepared=("mcpGetCallers", "cpg", "main"),
+            use_cache=False,
+        )
+
+        calls = [c.args[0] for c in mock_server.execute_query_async.call_args_list]
+        assert len(calls) == 2
+        assert "def mcpGetCallers(" in calls[0]
+        assert calls[1].startswith('mcpGetCallers(cpg, "main")')
+        assert executor.prepared.installed
+
+    @pytest.mark.asyncio
+    async def test_second_call_skips_installation(self):
+        """测试后续调用不再重复注入定义"""
+        executor, mock_server = self._make_executor()
+
+        await executor.execute(
+            "cpg.fallback1", prepared=("mcpGetCallers", "cpg", "a"), use_cache=False
+        )
+        await executor.execute(
+            "cpg.fallback2", prepared=("mcpGetCallees", "cpg", "b"), use_cache=False
+        )
+
+        calls = [c.args[0] for c in mock_server.execute_query_async.call_args_list]
+        # 1 次安装 + 2 次调用
+        assert len(calls) == 3
+        assert sum("def mcpGetCallers(" in c for c in calls) == 1
+
+    @pytest.mark.asyncio
+    async def test_install_failure_falls_back_to_inline_query(self):
+        """测试注入失败时回退到内联查询"""
+        executor, mock_server = self._make_executor()
+        mock_server.execute_query_async = AsyncMock(
+            side_effect=[
+                {"success": False, "stderr": "compile error"},  # 安装失败
+                {"success": True, "stdout": "[]"},  # 回退的内联查询
+                {"success": True, "stdout": "[]"},  # 第二次直接内联
+            ]
+        )
+
+        await executor.execute(
+            'cpg.method.name("main").callIn.dedup',
+            prepared=("mcpGetCallers", "cpg", "main"),
+            use_cache=False,
+        )
+        await executor.execute(
+            'cpg.method.name("f").call.dedup',
+            prepared=("mcpGetCallees", "cpg", "f"),
+            use_cache=False,
+        )
+
+        calls = [c.args[0] for c in mock_server.execute_query_async.call_args_list]
+        assert len(calls) == 3
+        assert "callIn" in calls[1]
+        # 失败后不再尝试安装
+        assert not executor.prepared.available
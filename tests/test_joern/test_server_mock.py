@@ -316,3 +316,111 @@ class TestJoernServerErrorHandling:
 
             result = await manager.import_code("/path", "project")
             assert result["success"] is False
+
+
+class TestBackgroundBoot:
+    """后台启动与预热测试"""
+
+    def _manager(self):
+        with (
+            patch("shutil.which", return_value="/usr/local/bin/joern"),
+            patch.object(Path, "exists", return_value=True),
+        ):
+            return JoernServerManager()
+
+    @pytest.mark.asyncio
+    async def test_early_query_queues_until_ready(self):
+        """测试就绪前到达的查询排队等待而不是失败"""
+        import asyncio
+        from unittest.mock import AsyncMock
+
+        manager = self._manager()
+        release = asyncio.Event()
+        client = AsyncMock()
+        client.execute = AsyncMock(return_value={"success": True, "stdout": "ok"})
+
+        async def fake_start(**kwargs):
+            await release.wait()
+            manager.client = client
+            manager._ready.set()
+
+        with patch.object(manager, "start", fake_start):
+            manager.start_background()
+            query_task = asyncio.create_task(
+                manager.execute_query_async("cpg.method.size")
+            )
+            await asyncio.sleep(0.01)
+            assert not query_task.done()
+
+            release.set()
+            result = await asyncio.wait_for(query_task, timeout=2)
+
+        assert result["success"] is True
+
+    @pytest.mark.asyncio
+    async def test_boot_failure_propagates_to_queued_query(self):
+        """测试后台启动失败时排队的查询拿到错误"""
+        import asyncio
+
+        manager = self._manager()
+
+        async def fake_start(**kwargs):
+            raise JoernServerError("no joern binary")
+
+        with patch.object(manager, "start", fake_start):
+            boot_task = manager.start_background()
+            await boot_task
+
+            with pytest.raises(JoernServerError, match="boot failed"):
+                await manager.execute_query_async("cpg.method.size")
+        assert not manager.is_warm
+
+    @pytest.mark.asyncio
+    async def test_boot_marks_warm_after_warmup(self):
+        """测试预热完成后标记为 warm"""
+        from unittest.mock import AsyncMock
+
+        manager = self._manager()
+
+        async def fake_start(**kwargs):
+            manager.client = AsyncMock()
+            manager._ready.set()
+
+        with (
+            patch.object(manager, "start", fake_start),
+            patch.object(manager, "warm_up", AsyncMock()) as warm_up,
+        ):
+            await manager.start_background()
+
+        warm_up.assert_awaited_once()
+        assert manager.is_warm
+
+    @pytest.mark.asyncio
+    async def test_warm_up_opens_project_and_runs_queries(self):
+        """测试预热打开最近项目并执行模板查询"""
+        import json
+        from unittest.mock import AsyncMock
+
+        manager = self._manager()
+        client = AsyncMock()
+        client.execute = AsyncMock(
+            return_value={"success": True, "stdout": json.dumps(["proj-a", "proj-b"])}
+        )
+        manager.client = client
+
+        await manager.warm_up()
+
+        queries = [call.args[0] for call in client.execute.await_args_list]
+        assert "workspace.projects.map(_.name)" in queries
+        assert 'open("proj-b")' in queries
+        # 至少执行了若干代表性模板查询
+        assert len(queries) >= 4
+
+    @pytest.mark.asyncio
+    async def test_without_boot_task_raises_immediately(self):
+        """测试从未启动时立即报错（保持原有语义）"""
+        manager = self._manager()
+        manager.client = None
+
+        with pytest.raises(JoernServerError, match="Server not started"):
+            await manager.execute_query_async("test")
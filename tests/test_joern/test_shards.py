@@ -0,0 +1,151 @@
+"""
+测试 Joern Server 按项目分片路由
+"""
+
+from unittest.mock import AsyncMock, MagicMock
+
+import pytest
+
+from joern_mcp.joern.shards import JoernShardRouter
+
+
+def _make_mock_shard(endpoint: str = "localhost:8080"):
+    """创建一个 mock 的分片成员"""
+    member = MagicMock()
+    member.endpoint = endpoint
+    member.is_running.return_value = True
+    member.execute_query_async = AsyncMock(
+        return_value={"success": True, "stdout": "[]"}
+    )
+    member.import_code = AsyncMock(return_value={"success": True, "stdout": ""})
+    member.import_cpg = AsyncMock(return_value={"success": True, "stdout": ""})
+    member.health_check = AsyncMock(return_value=True)
+    member.start = AsyncMock()
+    member.stop = AsyncMock()
+    return member
+
+
+@pytest.fixture(autouse=True)
+def isolated_routing(tmp_path, monkeypatch):
+    """每个测试使用独立的路由表文件"""
+    from joern_mcp import config
+
+    monkeypatch.setattr(config.settings, "joern_cpg_cache", tmp_path)
+    yield
+
+
+def _make_router() -> JoernShardRouter:
+    """创建一个两分片的路由器（成员替换为 mock）"""
+    router = JoernShardRouter(endpoints=["hosta:8080", "hostb:8080"])
+    router.members = [_make_mock_shard("hosta:8080"), _make_mock_shard("hostb:8080")]
+    return router
+
+
+class TestJoernShardRouter:
+    """测试分片路由逻辑"""
+
+    def test_endpoint_validation(self):
+        """端点必须是 host:port 形式且至少一个"""
+        with pytest.raises(ValueError):
+            JoernShardRouter(endpoints=["no-port"])
+        with pytest.raises(ValueError):
+            JoernShardRouter(endpoints=[])
+
+    def test_router_creation(self):
+        """按端点列表创建分片成员"""
+        router = JoernShardRouter(endpoints=["hosta:8080", "hostb:9090"])
+        assert len(router.members) == 2
+        assert router.endpoints == ["hosta:8080", "hostb:9090"]
+
+    @pytest.mark.asyncio
+    async def test_import_assigns_least_loaded_shard(self):
+        """新项目落到已分配项目最少的分片"""
+        router = _make_router()
+
+        await router.import_code("/path/a", "proj_a")
+        await router.import_code("/path/b", "proj_b")
+
+        assert router._routing == {"proj_a": 0, "proj_b": 1}
+        router.members[0].import_code.assert_awaited_once_with("/path/a", "proj_a")
+        router.members[1].import_code.assert_awaited_once_with("/path/b", "proj_b")
+
+    @pytest.mark.asyncio
+    async def test_reimport_keeps_shard(self):
+        """重新导入不改变项目的分片归属"""
+        router = _make_router()
+        router._routing = {"app": 1}
+
+        await router.import_code("/path/app", "app")
+
+        assert router._routing["app"] == 1
+        router.members[1].import_code.assert_awaited_once()
+        router.members[0].import_code.assert_not_awaited()
+
+    @pytest.mark.asyncio
+    async def test_project_query_routes_to_owning_shard(self):
+        """带项目引用的查询路由到项目所在分片"""
+        router = _make_router()
+        router._routing = {"app": 1}
+
+        await router.execute_query_async(
+            'workspace.project("app").get.cpg.get.method.size'
+        )
+
+        router.members[1].execute_query_async.assert_awaited_once()
+        router.members[0].execute_query_async.assert_not_awaited()
+
+    @pytest.mark.asyncio
+    async def test_unprefixed_query_follows_active_project(self):
+        """无项目引用的查询路由到活动项目所在分片"""
+        router = _make_router()
+
+        await router.import_code("/path/a", "proj_a")  # 分片 0
+        await router.import_code("/path/b", "proj_b")  # 分片 1，成为活动项目
+        await router.execute_query_async("cpg.method.size")
+
+        router.members[1].execute_query_async.assert_awaited_once()
+        router.members[0].execute_query_async.assert_not_awaited()
+
+    @pytest.mark.asyncio
+    async def test_delete_releases_routing_entry(self):
+        """删除项目后释放路由表条目"""
+        router = _make_router()
+        router._routing = {"app": 1}
+
+        await router.execute_query_async('delete("app")')
+
+        assert "app" not in router._routing
+
+    @pytest.mark.asyncio
+    async def test_routing_persists_across_instances(self):
+        """路由表持久化，重建路由器后项目归属不变"""
+        router = _make_router()
+        await router.import_code("/path/a", "proj_a")
+        await router.import_code("/path/b", "proj_b")
+
+        reloaded = JoernShardRouter(endpoints=["hosta:8080", "hostb:8080"])
+
+        assert reloaded._routing == {"proj_a": 0, "proj_b": 1}
+
+    @pytest.mark.asyncio
+    async def test_broadcast_skips_stopped_shards(self):
+        """广播查询只覆盖运行中的分片"""
+        router = _make_router()
+        router.members[0].is_running.return_value = False
+
+        results = await router.broadcast_query("workspace.projects.map(_.name)")
+
+        assert [endpoint for endpoint, _ in results] == ["hostb:8080"]
+        router.members[0].execute_query_async.assert_not_awaited()
+
+    def test_shard_stats(self):
+        """分片状态包含项目归属"""
+        router = _make_router()
+        router._routing = {"app": 0, "lib": 1}
+
+        stats = router.get_shard_stats()
+
+        assert stats["shards"] == 2
+        assert stats["running"] == 2
+        assert stats["projects"]["hosta:8080"] == ["app"]
+        assert stats["projects"]["hostb:8080"] == ["lib"]
@@ -0,0 +1,168 @@
+"""健康监督器测试"""
+
+import time
+from unittest.mock import AsyncMock, MagicMock, patch
+
+import pytest
+
+from joern_mcp.joern.supervisor import HealthSupervisor
+from joern_mcp.utils.performance import get_metrics, reset_metrics
+
+
+@pytest.fixture(autouse=True)
+def clean_metrics():
+    """每个测试从干净的全局指标开始"""
+    reset_metrics()
+    yield
+    reset_metrics()
+
+
+def _make_manager(running=True, healthy=True):
+    manager = MagicMock()
+    manager.is_running = MagicMock(return_value=running)
+    manager.health_check = AsyncMock(return_value=healthy)
+    manager.restart = AsyncMock()
+    return manager
+
+
+def _make_executor():
+    executor = MagicMock()
+    executor.prepared = MagicMock()
+    return executor
+
+
+class TestHealthSupervisor:
+    """监督器巡检与重启逻辑"""
+
+    @pytest.mark.asyncio
+    async def test_dead_process_triggers_restart(self):
+        """进程不存活时立即重启"""
+        manager = _make_manager(running=False)
+        supervisor = HealthSupervisor(manager, check_interval=1, hang_threshold=1)
+
+        await supervisor._tick()
+
+        manager.restart.assert_awaited_once()
+        assert supervisor.restarts == 1
+        assert "process not running" in supervisor.last_restart_reason
+
+    @pytest.mark.asyncio
+    async def test_progress_means_no_probe(self):
+        """完成计数在前进时不发探测查询（纯被动）"""
+        manager = _make_manager()
+        supervisor = HealthSupervisor(manager, check_interval=1, hang_threshold=1)
+        get_metrics().total_queries = 5
+
+        await supervisor._tick()
+
+        manager.health_check.assert_not_awaited()
+        manager.restart.assert_not_awaited()
+
+    @pytest.mark.asyncio
+    async def test_stall_without_inflight_is_idle_not_hang(self):
+        """无在途查询的停滞只是空闲，不触发探测"""
+        manager = _make_manager()
+        supervisor = HealthSupervisor(manager, check_interval=1, hang_threshold=1)
+        supervisor._last_completed = 0
+        supervisor._last_progress = time.time() - 999
+
+        await supervisor._tick()
+
+        manager.health_check.assert_not_awaited()
+        manager.restart.assert_not_awaited()
+
+    @pytest.mark.asyncio
+    async def test_suspected_hang_probes_before_restart(self):
+        """疑似挂死先主动探测，探测通过则不重启"""
+        manager = _make_manager(healthy=True)
+        supervisor = HealthSupervisor(manager, check_interval=1, hang_threshold=1)
+        supervisor._last_completed = 0
+        supervisor._last_progress = time.time() - 999
+        get_metrics().current_concurrent = 2
+
+        await supervisor._tick()
+
+        manager.health_check.assert_awaited_once()
+        manager.restart.assert_not_awaited()
+
+    @pytest.mark.asyncio
+    async def test_confirmed_hang_restarts(self):
+        """探测失败确认挂死后自动重启"""
+        manager = _make_manager(healthy=False)
+        supervisor = HealthSupervisor(manager, check_interval=1, hang_threshold=1)
+        supervisor._last_completed = 0
+        supervisor._last_progress = time.time() - 999
+        get_metrics().current_concurrent = 2
+
+        await supervisor._tick()
+
+        manager.restart.assert_awaited_once()
+        assert "hang detected" in supervisor.last_restart_reason
+
+    @pytest.mark.asyncio
+    async def test_restart_resets_session_state(self):
+        """重启后目录缓存与预编译注册被重置"""
+        manager = _make_manager()
+        executor = _make_executor()
+        supervisor = HealthSupervisor(
+            manager, executor, check_interval=1, hang_threshold=1
+        )
+
+        with patch(
+            "joern_mcp.joern.supervisor.invalidate_catalog"
+        ) as mock_invalidate:
+            await supervisor._restart("test")
+
+        mock_invalidate.assert_called_once()
+        executor.prepared.reset.assert_called_once()
+
+    @pytest.mark.asyncio
+    async def test_cooldown_suppresses_restart_storm(self):
+        """冷却期内不重复重启（启动持续失败时防风暴）"""
+        manager = _make_manager()
+        supervisor = HealthSupervisor(manager, check_interval=1, hang_threshold=1)
+
+        await supervisor._restart("first")
+        await supervisor._restart("second")
+
+        manager.restart.assert_awaited_once()
+        assert supervisor.restarts == 1
+
+    @pytest.mark.asyncio
+    async def test_failed_restart_does_not_count(self):
+        """restart 抛异常时不计入成功重启"""
+        manager = _make_manager()
+        manager.restart = AsyncMock(side_effect=RuntimeError("boom"))
+        supervisor = HealthSupervisor(manager, check_interval=1, hang_threshold=1)
+
+        await supervisor._restart("test")
+
+        assert supervisor.restarts == 0
+        assert supervisor.last_restart_at is None
+
+    @pytest.mark.asyncio
+    async def test_get_status(self):
+        """状态报告包含巡检配置与重启历史"""
+        manager = _make_manager()
+        supervisor = HealthSupervisor(manager, check_interval=7, hang_threshold=42)
+
+        await supervisor._restart("test reason")
+        status = supervisor.get_status()
+
+        assert status["check_interval"] == 7
+        assert status["hang_threshold"] == 42
+        assert status["restarts"] == 1
+        assert status["last_restart_reason"] == "test reason"
+        assert len(status["recent_events"]) == 1
+
+    @pytest.mark.asyncio
+    async def test_start_stop_lifecycle(self):
+        """start 创建巡检任务，stop 取消"""
+        manager = _make_manager()
+        supervisor = HealthSupervisor(manager, check_interval=60, hang_threshold=60)
+
+        supervisor.start()
+        assert supervisor._task is not None
+
+        await supervisor.stop()
+        assert supervisor._task is None
@@ -0,0 +1,235 @@
+"""测试进程内调用图索引"""
+
+from unittest.mock import AsyncMock, MagicMock
+
+import pytest
+
+from joern_mcp.services.callgraph import CallGraphService
+from joern_mcp.services.callgraph_index import (
+    CallGraphIndex,
+    CallGraphIndexCache,
+)
+
+SAMPLE_EDGES = [
+    {
+        "caller": "main",
+        "callerFullName": "main",
+        "callee": "process",
+        "calleeFullName": "process",
+        "signature": "void(char*)",
+        "filename": "main.c",
+        "lineNumber": 10,
+        "code": "process(input)",
+    },
+    {
+        "caller": "process",
+        "callerFullName": "process",
+        "callee": "strcpy",
+        "calleeFullName": "strcpy",
+        "signature": "char*(char*,char*)",
+        "filename": "main.c",
+        "lineNumber": 25,
+        "code": "strcpy(buf, data)",
+    },
+    {
+        "caller": "helper",
+        "callerFullName": "helper",
+        "callee": "process",
+        "calleeFullName": "process",
+        "signature": "void(char*)",
+        "filename": "util.c",
+        "lineNumber": 8,
+        "code": "process(arg)",
+    },
+]
+
+
+class TestCallGraphIndex:
+    """邻接索引测试"""
+
+    def test_callers_of(self):
+        """测试从索引回答调用者查询"""
+        index = CallGraphIndex(SAMPLE_EDGES)
+
+        callers = index.callers_of("process")
+
+        names = {c["name"] for c in callers}
+        assert names == {"main", "helper"}
+        # 形状与直接查询一致
+        assert all("methodFullName" in c and "lineNumber" in c for c in callers)
+
+    def test_callees_of(self):
+        """测试从索引回答被调用者查询"""
+        index = CallGraphIndex(SAMPLE_EDGES)
+
+        callees = index.callees_of("process")
+
+        assert len(callees) == 1
+        assert callees[0]["name"] == "strcpy"
+        assert callees[0]["code"] == "strcpy(buf, data)"
+
+    def test_unknown_function(self):
+        """测试未知函数返回空列表"""
+        index = CallGraphIndex(SAMPLE_EDGES)
+
+        assert index.callers_of("nonexistent") == []
+        assert index.callees_of("nonexistent") == []
+
+    def test_duplicate_edges_deduped(self):
+        """测试重复边去重"""
+        index = CallGraphIndex(SAMPLE_EDGES + [SAMPLE_EDGES[0]])
+
+        assert len(index.callers_of("process")) == 2
+
+    def test_chain_bfs_up(self):
+        """测试向上 BFS 展开完整调用链"""
+        index = CallGraphIndex(SAMPLE_EDGES)
+
+        chain = index.chain("strcpy", direction="up", max_depth=5)
+
+        by_depth = {}
+        for node in chain:
+            by_depth.setdefault(node["depth"], set()).add(node["name"])
+        assert by_depth[1] == {"process"}
+        assert by_depth[2] == {"main", "helper"}
+
+    def test_chain_respects_max_depth(self):
+        """测试深度限制"""
+        index = CallGraphIndex(SAMPLE_EDGES)
+
+        chain = index.chain("strcpy", direction="up", max_depth=1)
+
+        assert {node["depth"] for node in chain} == {1}
+
+    def test_chain_handles_cycles(self):
+        """测试循环调用不会死循环"""
+        edges = [
+            {"caller": "a", "callee": "b", "filename": "x.c", "lineNumber": 1},
+            {"caller": "b", "callee": "a", "filename": "x.c", "lineNumber": 2},
+        ]
+        index = CallGraphIndex(edges)
+
+        chain = index.chain("a", direction="down", max_depth=5)
+
+        # a -> b (depth 1), b -> a (depth 2)，之后 a 已访问过
+        assert len(chain) == 2
+
+    def test_get_stats(self):
+        """测试索引统计"""
+        index = CallGraphIndex(SAMPLE_EDGES)
+        stats = index.get_stats()
+
+        assert stats["edge_count"] == 3
+        assert stats["caller_count"] == 3
+        assert stats["callee_count"] == 2
+
+
+class TestCallGraphIndexCache:
+    """索引缓存测试"""
+
+    @pytest.mark.asyncio
+    async def test_build_and_peek(self):
+        """测试构建后 peek 命中，仅执行一次批量抽取"""
+        import json
+
+        cache = CallGraphIndexCache()
+        mock_executor = MagicMock()
+        mock_executor.execute = AsyncMock(
+            return_value={"success": True, "stdout": json.dumps(SAMPLE_EDGES)}
+        )
+
+        assert cache.peek("demo-idx") is None
+
+        index = await cache.get_or_build(mock_executor, "cpg", "demo-idx")
+        assert index.edge_count == 3
+        assert cache.peek("demo-idx") is index
+
+        # 再次获取不触发抽取
+        again = await cache.get_or_build(mock_executor, "cpg", "demo-idx")
+        assert again is index
+        assert mock_executor.execute.call_count == 1
+
+    @pytest.mark.asyncio
+    async def test_build_failure_raises(self):
+        """测试批量抽取失败时抛出异常"""
+        cache = CallGraphIndexCache()
+        mock_executor = MagicMock()
+        mock_executor.execute = AsyncMock(
+            return_value={"success": False, "stderr": "boom"}
+        )
+
+        with pytest.raises(RuntimeError, match="boom"):
+            await cache.get_or_build(mock_executor, "cpg", "demo-fail")
+
+    @pytest.mark.asyncio
+    async def test_invalidate(self):
+        """测试显式失效"""
+        import json
+
+        cache = CallGraphIndexCache()
+        mock_executor = MagicMock()
+        mock_executor.execute = AsyncMock(
+            return_value={"success": True, "stdout": json.dumps(SAMPLE_EDGES)}
+        )
+
+        await cache.get_or_build(mock_executor, "cpg", "demo-inv")
+        cache.invalidate("demo-inv")
+
+        assert cache.peek("demo-inv") is None
+
+
+class TestServiceIndexFastPath:
+    """服务层索引快路径测试"""
+
+    def _make_service_with_index(self):
+        mock_executor = MagicMock()
+        mock_executor.execute = AsyncMock()
+        service = CallGraphService(mock_executor)
+        # 隔离全局单例：注入私有缓存并预置索引
+        service.index_cache = CallGraphIndexCache()
+        key = service.index_cache._key("demo-svc")
+        service.index_cache._indexes[key] = CallGraphIndex(SAMPLE_EDGES)
+        return service, mock_executor
+
+    @pytest.mark.asyncio
+    async def test_get_callers_from_index(self):
+        """测试已建索引时 get_callers 零 Joern 往返"""
+        service, mock_executor = self._make_service_with_index()
+
+        result = await service.get_callers("process", project_name="demo-svc")
+
+        assert result["success"] is True
+        assert result["source"] == "index"
+        assert result["count"] == 2
+        mock_executor.execute.assert_not_called()
+
+    @pytest.mark.asyncio
+    async def test_get_call_chain_from_index(self):
+        """测试已建索引时调用链 BFS 展开到完整深度"""
+        service, mock_executor = self._make_service_with_index()
+
+        result = await service.get_call_chain(
+            "strcpy", max_depth=5, direction="up", project_name="demo-svc"
+        )
+
+        assert result["success"] is True
+        assert result["source"] == "index"
+        depths = {node["depth"] for node in result["chain"]}
+        assert depths == {1, 2}
+        mock_executor.execute.assert_not_called()
+
+    @pytest.mark.asyncio
+    async def test_no_index_falls_back_to_query(self):
+        """测试未建索引时走原有查询路径"""
+        mock_executor = MagicMock()
+        mock_executor.execute = AsyncMock(
+            return_value={"success": True, "stdout": "[]"}
+        )
+        service = CallGraphService(mock_executor)
+        service.index_cache = CallGraphIndexCache()
+
+        result = await service.get_callers("process", project_name="demo-nofall")
+
+        assert result["success"] is True
+        assert "source" not in result
+        mock_executor.execute.assert_called_once()
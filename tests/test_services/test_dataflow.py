@@ -1,5 +1,6 @@
 """测试数据流分析服务"""
 
+import json
 from unittest.mock import AsyncMock, MagicMock
 
 import pytest
@@ -171,3 +172,132 @@ async def test_track_dataflow_query_failed():
 
     assert result["success"] is False
     assert "error" in result
+
+
+def _summary_stdout() -> str:
+    """构造带 sourceMethod 标记的汇摘要查询输出"""
+    return json.dumps(
+        [
+            {
+                "sourceMethod": "gets",
+                "source": {"code": "buf", "file": "main.c", "line": 10},
+                "sink": {"code": "system(cmd)", "file": "main.c", "line": 20},
+                "pathLength": 3,
+                "path": [],
+            },
+            {
+                "sourceMethod": "read_input",
+                "source": {"code": "data", "file": "io.c", "line": 5},
+                "sink": {"code": "system(data)", "file": "io.c", "line": 8},
+                "pathLength": 2,
+                "path": [],
+            },
+        ]
+    )
+
+
+@pytest.mark.asyncio
+async def test_sink_summary_answers_repeat_probes():
+    """测试同汇的第二次配对探查由摘要即答（不再往返 Joern）"""
+    mock_executor = MagicMock()
+    mock_executor.execute = AsyncMock(
+        return_value={"success": True, "stdout": _summary_stdout()}
+    )
+
+    service = DataFlowService(mock_executor)
+    result1 = await service.track_dataflow("gets", "system", project_name="test")
+    result2 = await service.track_dataflow("read_input", "system", project_name="test")
+
+    # 首次探查计算摘要（一次查询），第二次纯内存过滤
+    assert mock_executor.execute.call_count == 1
+    assert result1["success"] is True
+    assert result1["from_summary"] is True
+    assert result1["count"] == 1
+    assert result2["count"] == 1
+    assert result2["sink_method"] == "system"
+    # 摘要内部的 sourceMethod 标记不应泄漏到响应流中
+    assert "sourceMethod" not in result1["flows"][0]
+
+
+@pytest.mark.asyncio
+async def test_sink_summary_truncated_miss_falls_back(monkeypatch):
+    """测试截断的摘要未命中源时退回直查（避免漏报）"""
+    from joern_mcp.config import settings
+
+    monkeypatch.setattr(settings, "flow_summary_max_flows", 2)
+
+    direct_stdout = json.dumps(
+        [
+            {
+                "source": {"code": "line", "file": "cli.c", "line": 3},
+                "sink": {"code": "system(line)", "file": "cli.c", "line": 7},
+                "pathLength": 4,
+                "path": [],
+            }
+        ]
+    )
+    mock_executor = MagicMock()
+    mock_executor.execute = AsyncMock(
+        side_effect=[
+            {"success": True, "stdout": _summary_stdout()},
+            {"success": True, "stdout": direct_stdout},
+        ]
+    )
+
+    service = DataFlowService(mock_executor)
+    result = await service.track_dataflow("scanf", "system", project_name="test")
+
+    # 摘要达到上限（2 条）且无 scanf 源，须直查兜底
+    assert mock_executor.execute.call_count == 2
+    assert result["success"] is True
+    assert result["count"] == 1
+    assert "from_summary" not in result
+
+
+@pytest.mark.asyncio
+async def test_sink_summary_invalidated_on_reimport(tmp_path, monkeypatch):
+    """测试项目重新导入（代数递增）后摘要重新计算"""
+    from joern_mcp import config
+    from joern_mcp.utils.cpg_generation import bump_generation, reset_generations
+
+    monkeypatch.setattr(config.settings, "joern_cpg_cache", tmp_path)
+    reset_generations()
+
+    mock_executor = MagicMock()
+    mock_executor.execute = AsyncMock(
+        return_value={"success": True, "stdout": _summary_stdout()}
+    )
+
+    service = DataFlowService(mock_executor)
+    try:
+        await service.track_dataflow("gets", "system", project_name="test")
+        bump_generation("test")
+        await service.track_dataflow("gets", "system", project_name="test")
+    finally:
+        reset_generations()
+
+    # 代数变化使旧摘要失效，第二次探查重算
+    assert mock_executor.execute.call_count == 2
+
+
+@pytest.mark.asyncio
+async def test_sink_summary_disabled(monkeypatch):
+    """测试关闭摘要开关后走原直查路径"""
+    from joern_mcp.config import settings
+
+    monkeypatch.setattr(settings, "flow_summary_enabled", False)
+
+    mock_executor = MagicMock()
+    mock_executor.execute = AsyncMock(
+        return_value={
+            "success": True,
+            "stdout": '[{"source": {"code": "buf"}, "sink": {"code": "system(buf)"}, "pathLength": 2, "path": []}]',
+        }
+    )
+
+    service = DataFlowService(mock_executor)
+    result = await service.track_dataflow("gets", "system", project_name="test")
+
+    assert mock_executor.execute.call_count == 1
+    assert result["success"] is True
+    assert "from_summary" not in result
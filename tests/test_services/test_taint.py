@@ -9,7 +9,7 @@ from joern_mcp.models.taint_rules import (
     get_rule_by_name,
     list_all_rules,
 )
-from joern_mcp.services.taint import TaintAnalysisService
+from joern_mcp.services.taint import TIER_SWEEPS, TaintAnalysisService
 
 
 def test_taint_rules():
@@ -199,3 +199,199 @@ async def test_analyze_query_failed():
 
     assert result["success"] is False
     assert "error" in result
+
+
+def test_group_rules_by_sources():
+    """测试规则按源模式分组"""
+    groups = TaintAnalysisService._group_rules_by_sources(VULNERABILITY_RULES)
+
+    # 预定义规则大多共享 user_input 源集合，分组数应明显少于规则数
+    assert len(groups) < len(VULNERABILITY_RULES)
+    assert sum(len(g) for g in groups) == len(VULNERABILITY_RULES)
+
+    # 同组内源集合一致
+    for group in groups:
+        source_sets = {tuple(sorted(set(r.sources))) for r in group}
+        assert len(source_sets) == 1
+
+
+def test_attribute_flows():
+    """测试融合查询结果归属回规则"""
+    cmd_injection = get_rule_by_name("Command Injection")
+    sql_injection = get_rule_by_name("SQL Injection")
+
+    flows = [
+        {
+            "sinkCallName": "system",
+            "source": {"code": "input", "file": "main.c", "line": 5},
+            "sink": {"code": "system(cmd)", "file": "main.c", "line": 20},
+            "pathLength": 4,
+        },
+        {
+            "sinkCallName": "executeQuery",
+            "source": {"code": "input", "file": "dao.java", "line": 8},
+            "sink": {"code": "stmt.executeQuery(sql)", "file": "dao.java", "line": 30},
+            "pathLength": 3,
+        },
+    ]
+
+    vulns = TaintAnalysisService._attribute_flows(
+        flows, [cmd_injection, sql_injection]
+    )
+
+    assert len(vulns) == 2
+    by_name = {v["vulnerability"]: v for v in vulns}
+    assert by_name["Command Injection"]["cwe_id"] == "CWE-78"
+    assert by_name["SQL Injection"]["sink"]["line"] == 30
+    # 内部归属字段不外泄
+    assert all("sinkCallName" not in v for v in vulns)
+
+
+@pytest.mark.asyncio
+async def test_scan_all_rules_fused():
+    """测试全规则融合扫描
+
+    验证查询次数等于源分组数（而非规则数），且结果正确归属。
+    """
+    mock_executor = MagicMock()
+    mock_executor.execute = AsyncMock(
+        return_value={
+            "success": True,
+            "stdout": """[{
+                "sinkCallName": "system",
+                "source": {"code": "input", "file": "main.c", "line": 5},
+                "sink": {"code": "system(cmd)", "file": "main.c", "line": 20},
+                "pathLength": 4
+            }]""",
+        }
+    )
+
+    service = TaintAnalysisService(mock_executor)
+    result = await service.scan_all_rules(project_name="test")
+
+    assert result["success"] is True
+    assert result["rules_checked"] == len(VULNERABILITY_RULES)
+    expected_groups = len(
+        TaintAnalysisService._group_rules_by_sources(VULNERABILITY_RULES)
+    )
+    assert result["fused_queries"] == expected_groups
+    assert mock_executor.execute.call_count == expected_groups
+
+    # system 同时命中命令注入与网络数据注入（两组都返回了该流）
+    names = {v["vulnerability"] for v in result["vulnerabilities"]}
+    assert "Command Injection" in names
+    assert result["summary"]["CRITICAL"] >= 1
+
+
+@pytest.mark.asyncio
+async def test_scan_all_rules_partial_failure():
+    """测试部分分组查询失败时返回其余结果"""
+    mock_executor = MagicMock()
+    mock_executor.execute = AsyncMock(
+        side_effect=[
+            {"success": False, "stderr": "boom"},
+            {"success": True, "stdout": "[]"},
+            {"success": True, "stdout": "[]"},
+        ]
+    )
+
+    service = TaintAnalysisService(mock_executor)
+    result = await service.scan_all_rules(project_name="test")
+
+    assert result["success"] is True
+    assert "partial_errors" in result
+    assert result["total_count"] == 0
+
+
+def test_tier_sweeps_precompiled():
+    """测试级别扫描块在导入时预编译完成"""
+    # 预定义规则覆盖 CRITICAL/HIGH/MEDIUM 三个级别
+    assert "CRITICAL" in TIER_SWEEPS
+    assert "HIGH" in TIER_SWEEPS
+    assert "MEDIUM" in TIER_SWEEPS
+
+    critical = TIER_SWEEPS["CRITICAL"]
+    # CRITICAL 级别三条规则落在两个源分组（user_input / network_input）
+    assert sum(len(g) for g in critical.groups) == 3
+    assert len(critical.groups) == 2
+
+    # 模板只剩 $cpg / $max_flows 占位符，替换后即为完整查询
+    query = critical.template.substitute(cpg="cpg", max_flows=10)
+    assert "reachableByFlows" in query
+    assert "$" not in query
+    # 各分组结果在 Scala 端拼接为单条查询的返回值
+    assert "flows_0 ++ flows_1" in query
+
+
+@pytest.mark.asyncio
+async def test_scan_severity_tier_single_query():
+    """测试严重级别扫描只发一次查询且按分组归属"""
+    mock_executor = MagicMock()
+    mock_executor.execute = AsyncMock(
+        return_value={
+            "success": True,
+            "stdout": """[
+                {
+                    "group": 0,
+                    "sinkCallName": "system",
+                    "source": {"code": "input", "file": "main.c", "line": 5},
+                    "sink": {"code": "system(cmd)", "file": "main.c", "line": 20},
+                    "pathLength": 4
+                },
+                {
+                    "group": 1,
+                    "sinkCallName": "exec",
+                    "source": {"code": "recv(fd)", "file": "net.c", "line": 8},
+                    "sink": {"code": "exec(cmd)", "file": "net.c", "line": 30},
+                    "pathLength": 3
+                }
+            ]""",
+        }
+    )
+
+    service = TaintAnalysisService(mock_executor)
+    result = await service.scan_severity_tier("CRITICAL", project_name="test")
+
+    assert result["success"] is True
+    assert result["severity"] == "CRITICAL"
+    assert result["rules_checked"] == 3
+    assert result["queries"] == 1
+    # 整个级别只有一次 REPL 往返
+    assert mock_executor.execute.call_count == 1
+
+    # group 0 是 user_input 组（命令/SQL 注入），group 1 是网络输入组
+    names = {v["vulnerability"] for v in result["vulnerabilities"]}
+    assert "Command Injection" in names
+    assert "Network Data Injection" in names
+    # 内部归属字段不外泄
+    assert all(
+        "group" not in v and "sinkCallName" not in v
+        for v in result["vulnerabilities"]
+    )
+
+
+@pytest.mark.asyncio
+async def test_scan_severity_tier_unknown_severity():
+    """测试无规则的严重级别"""
+    mock_executor = MagicMock()
+
+    service = TaintAnalysisService(mock_executor)
+    result = await service.scan_severity_tier("LOW", project_name="test")
+
+    assert result["success"] is False
+    assert "No rules" in result["error"]
+
+
+@pytest.mark.asyncio
+async def test_scan_severity_tier_query_failed():
+    """测试级别扫描查询失败"""
+    mock_executor = MagicMock()
+    mock_executor.execute = AsyncMock(
+        return_value={"success": False, "stderr": "boom"}
+    )
+
+    service = TaintAnalysisService(mock_executor)
+    result = await service.scan_severity_tier("HIGH", project_name="test")
+
+    assert result["success"] is False
+    assert result["error"] == "boom"
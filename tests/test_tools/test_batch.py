@@ -172,3 +172,81 @@ class TestBatchEdgeCases:
         for i, result in enumerate(results):
             data = json.loads(result["stdout"])
             assert data["id"] == i
+
+
+class TestBatchFusion:
+    """测试批量查询融合"""
+
+    def test_is_fusable(self):
+        """测试融合兼容性判断"""
+        from joern_mcp.tools.batch import _is_fusable
+
+        assert _is_fusable("cpg.method.name")
+        assert _is_fusable('workspace.project("p").get.cpg.get.call.name.toJson')
+
+        # 带语句/多语句/代码块的查询不融合
+        assert not _is_fusable("val x = cpg.method; x.name")
+        assert not _is_fusable("{ cpg.method.name }")
+        assert not _is_fusable("def f = cpg.method")
+        assert not _is_fusable("import io.shiftleft")
+        assert not _is_fusable("")
+
+    def test_build_fused_block(self):
+        """测试融合块构造"""
+        from joern_mcp.tools.batch import _build_fused_block
+
+        block = _build_fused_block(
+            [(0, "cpg.method.name"), (2, "cpg.call.name.toJson")]
+        )
+
+        assert block.startswith("Map(")
+        assert '"q0" -> (cpg.method.name).toJson' in block
+        # 查询自带的 .toJson 被剥离，避免双重序列化
+        assert '"q2" -> (cpg.call.name).toJson' in block
+
+    def test_chunk_for_fusion(self):
+        """测试融合块按长度切分"""
+        from joern_mcp.tools.batch import _FUSE_CHUNK_CHARS, _chunk_for_fusion
+
+        long_query = "cpg." + "a" * (_FUSE_CHUNK_CHARS // 2)
+        chunks = _chunk_for_fusion([(0, long_query), (1, long_query), (2, "cpg.b")])
+
+        assert len(chunks) == 2
+        assert [i for chunk in chunks for i, _ in chunk] == [0, 1, 2]
+
+    @pytest.mark.asyncio
+    async def test_execute_fused_chunk(self, monkeypatch):
+        """测试融合块执行与按标记拆分"""
+        from joern_mcp.tools import batch
+
+        mock_executor = AsyncMock()
+        mock_executor.execute = AsyncMock(
+            return_value={
+                "success": True,
+                "stdout": '{"q0": "[\\"main\\"]", "q1": "[\\"strcpy\\"]"}',
+            }
+        )
+        monkeypatch.setattr(batch.server_state, "query_executor", mock_executor)
+
+        outputs = await batch._execute_fused_chunk(
+            [(0, "cpg.method.name"), (1, "cpg.call.name")], timeout=60
+        )
+
+        assert set(outputs) == {0, 1}
+        assert "main" in outputs[0]
+        # 一次往返执行了两个查询
+        mock_executor.execute.assert_called_once()
+
+    @pytest.mark.asyncio
+    async def test_execute_fused_chunk_failure_raises(self, monkeypatch):
+        """测试融合块失败抛出异常（供调用方回退逐条执行）"""
+        from joern_mcp.tools import batch
+
+        mock_executor = AsyncMock()
+        mock_executor.execute = AsyncMock(
+            return_value={"success": False, "stderr": "compile error"}
+        )
+        monkeypatch.setattr(batch.server_state, "query_executor", mock_executor)
+
+        with pytest.raises(RuntimeError, match="compile error"):
+            await batch._execute_fused_chunk([(0, "cpg.method.name")], timeout=60)
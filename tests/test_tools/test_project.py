@@ -148,3 +148,73 @@ class TestProjectManagementEdgeCases:
 
         assert result["success"] is False
         assert "stderr" in result
+
+
+class TestPrebuiltCpgHelpers:
+    """预构建 CPG 检测与新鲜度检查测试"""
+
+    def test_find_cpg_inside_source_tree(self, tmp_path):
+        """测试检测源码目录内的 cpg.bin"""
+        from joern_mcp.tools.project import _find_prebuilt_cpg
+
+        cpg = tmp_path / "cpg.bin"
+        cpg.write_bytes(b"\x00")
+
+        assert _find_prebuilt_cpg(tmp_path) == cpg
+
+    def test_find_cpg_next_to_source_tree(self, tmp_path):
+        """测试检测同级的 <目录名>.cpg.bin"""
+        from joern_mcp.tools.project import _find_prebuilt_cpg
+
+        source = tmp_path / "myapp"
+        source.mkdir()
+        cpg = tmp_path / "myapp.cpg.bin"
+        cpg.write_bytes(b"\x00")
+
+        assert _find_prebuilt_cpg(source) == cpg
+
+    def test_find_cpg_missing(self, tmp_path):
+        """测试无预构建 CPG 时返回 None"""
+        from joern_mcp.tools.project import _find_prebuilt_cpg
+
+        assert _find_prebuilt_cpg(tmp_path) is None
+
+    def test_fresh_with_matching_sidecar(self, tmp_path):
+        """测试 sidecar 哈希一致时判定为新鲜"""
+        from joern_mcp.tools.project import _cpg_bin_is_fresh
+
+        cpg = tmp_path / "cpg.bin"
+        cpg.write_bytes(b"\x00")
+        hashes = {"main.c": "h1"}
+        (tmp_path / "cpg.bin.hashes.json").write_text(json.dumps(hashes))
+
+        assert _cpg_bin_is_fresh(cpg, tmp_path, hashes) is True
+
+    def test_stale_with_mismatched_sidecar(self, tmp_path):
+        """测试源码变化后 sidecar 不一致，判定为过期"""
+        from joern_mcp.tools.project import _cpg_bin_is_fresh
+
+        cpg = tmp_path / "cpg.bin"
+        cpg.write_bytes(b"\x00")
+        (tmp_path / "cpg.bin.hashes.json").write_text(json.dumps({"main.c": "h1"}))
+
+        assert _cpg_bin_is_fresh(cpg, tmp_path, {"main.c": "h2"}) is False
+
+    def test_mtime_fallback_without_sidecar(self, tmp_path):
+        """测试无 sidecar 时回退 mtime 比较"""
+        import os
+
+        from joern_mcp.tools.project import _cpg_bin_is_fresh
+
+        source = tmp_path / "main.c"
+        source.write_text("int main() {}")
+        os.utime(source, (1000, 1000))
+
+        cpg = tmp_path / "cpg.bin"
+        cpg.write_bytes(b"\x00")
+
+        os.utime(cpg, (2000, 2000))
+        assert _cpg_bin_is_fresh(cpg, tmp_path, {}) is True
+
+        os.utime(cpg, (500, 500))
+        assert _cpg_bin_is_fresh(cpg, tmp_path, {}) is False
@@ -0,0 +1,174 @@
+"""缓存 L2 后端测试"""
+
+from unittest.mock import patch
+
+from joern_mcp.utils import cache_backend
+from joern_mcp.utils.cache_backend import RedisCacheBackend, create_cache_backend
+from joern_mcp.utils.performance import PersistentCache
+
+
+class FakeRedis:
+    """内存版 Redis 客户端（只实现后端用到的命令）"""
+
+    def __init__(self):
+        self.store = {}
+        self.closed = False
+
+    def get(self, key):
+        return self.store.get(key)
+
+    def setex(self, key, ttl, value):
+        self.store[key] = value
+
+    def scan_iter(self, match=None, count=None):
+        prefix = match.rstrip("*") if match else ""
+        return iter([k for k in self.store if k.startswith(prefix)])
+
+    def delete(self, *keys):
+        for key in keys:
+            self.store.pop(key, None)
+
+    def close(self):
+        self.closed = True
+
+
+class BrokenRedis:
+    """所有操作都抛异常的客户端，模拟 Redis 不可用"""
+
+    def __getattr__(self, name):
+        def _fail(*args, **kwargs):
+            raise ConnectionError("redis down")
+
+        return _fail
+
+
+class TestRedisCacheBackend:
+    """Redis 后端测试"""
+
+    def _backend(self, client=None):
+        backend = RedisCacheBackend(url="redis://localhost:6379/0", ttl=60)
+        backend._client = client if client is not None else FakeRedis()
+        return backend
+
+    def test_set_get_roundtrip(self):
+        """写入后可读回，且命中统计正确"""
+        backend = self._backend()
+        value = {"success": True, "stdout": "result", "items": [1, 2, 3]}
+
+        backend.set("key1", value)
+        result = backend.get("key1")
+
+        assert result == value
+        assert backend.stats["writes"] == 1
+        assert backend.stats["hits"] == 1
+
+    def test_get_miss(self):
+        """不存在的键返回 None 并记为未命中"""
+        backend = self._backend()
+
+        assert backend.get("nonexistent") is None
+        assert backend.stats["misses"] == 1
+
+    def test_keys_are_prefixed(self):
+        """键带服务前缀，不污染共享 Redis 的其他键空间"""
+        client = FakeRedis()
+        backend = self._backend(client)
+
+        backend.set("abc", {"v": 1})
+
+        assert "joern_mcp:query_cache:abc" in client.store
+
+    def test_errors_degrade_to_miss(self):
+        """后端不可用时读写都降级（不抛异常），记入 errors"""
+        backend = self._backend(BrokenRedis())
+
+        assert backend.get("key1") is None
+        backend.set("key1", {"v": 1})
+
+        assert backend.stats["errors"] == 2
+
+    def test_clear_only_removes_prefixed_keys(self):
+        """clear 只删除本服务前缀的键"""
+        client = FakeRedis()
+        client.store["other_service:key"] = b"x"
+        backend = self._backend(client)
+        backend.set("key1", {"v": 1})
+
+        backend.clear()
+
+        assert "other_service:key" in client.store
+        assert "joern_mcp:query_cache:key1" not in client.store
+
+    def test_get_stats(self):
+        """统计包含读写计数、条目数和后端标识"""
+        backend = self._backend()
+        backend.set("key1", {"v": 1})
+        backend.get("key1")
+        backend.get("missing")
+
+        stats = backend.get_stats()
+
+        assert stats["hits"] == 1
+        assert stats["misses"] == 1
+        assert stats["writes"] == 1
+        assert stats["size"] == 1
+        assert stats["backend"] == "redis"
+
+    def test_close(self):
+        """close 关闭客户端连接"""
+        client = FakeRedis()
+        backend = self._backend(client)
+
+        backend.close()
+
+        assert client.closed
+        assert backend._client is None
+
+
+class TestCreateCacheBackend:
+    """后端工厂测试"""
+
+    def test_disabled_returns_none(self):
+        """关闭持久化时没有 L2 后端"""
+        with patch.object(cache_backend.settings, "query_cache_persist", False):
+            assert create_cache_backend() is None
+
+    def test_redis_backend(self):
+        """配置 redis 时返回 Redis 后端并透传连接参数"""
+        with (
+            patch.object(cache_backend.settings, "query_cache_persist", True),
+            patch.object(cache_backend.settings, "query_cache_backend", "redis"),
+            patch.object(
+                cache_backend.settings, "redis_url", "redis://cache-host:6379/1"
+            ),
+            patch.object(cache_backend.settings, "query_cache_persist_ttl", 3600),
+        ):
+            backend = create_cache_backend()
+
+        assert isinstance(backend, RedisCacheBackend)
+        assert backend.url == "redis://cache-host:6379/1"
+        assert backend.ttl == 3600
+
+    def test_sqlite_backend(self, tmp_path):
+        """默认配置返回 SQLite 持久层"""
+        with (
+            patch.object(cache_backend.settings, "query_cache_persist", True),
+            patch.object(cache_backend.settings, "query_cache_backend", "sqlite"),
+            patch.object(cache_backend.settings, "joern_cpg_cache", tmp_path),
+        ):
+            backend = create_cache_backend()
+
+        assert isinstance(backend, PersistentCache)
+        backend.close()
+
+    def test_unknown_backend_falls_back_to_sqlite(self, tmp_path):
+        """未知后端名回退到 SQLite"""
+        with (
+            patch.object(cache_backend.settings, "query_cache_persist", True),
+            patch.object(cache_backend.settings, "query_cache_backend", "memcached"),
+            patch.object(cache_backend.settings, "joern_cpg_cache", tmp_path),
+        ):
+            backend = create_cache_backend()
+
+        assert isinstance(backend, PersistentCache)
+        backend.close()
@@ -0,0 +1,110 @@
+"""缓存键规范化测试"""
+
+import pytest
+
+from joern_mcp.utils.cache_key import (
+    CacheKeyStats,
+    get_cache_key_stats,
+    normalize_query,
+    reset_cache_key_stats,
+)
+
+
+@pytest.fixture(autouse=True)
+def clean_stats():
+    """每个测试从干净的全局统计开始"""
+    reset_cache_key_stats()
+    yield
+    reset_cache_key_stats()
+
+
+class TestNormalizeQuery:
+    """查询文本规范化测试"""
+
+    def test_template_indentation_unified(self):
+        """测试模板缩进与单行写法归一"""
+        templated = """
+        cpg.method
+          .name("main")
+          .toJson
+        """
+        inline = 'cpg.method.name("main").toJson'
+
+        assert normalize_query(templated) == normalize_query(inline)
+
+    def test_identifier_boundary_space_kept(self):
+        """测试标识符边界的空格保留（val x 不塌成 valx）"""
+        assert normalize_query("val  sources =  cpg") == "val sources=cpg"
+
+    def test_string_literal_whitespace_preserved(self):
+        """测试字符串字面量内部的空白不折叠"""
+        query = 'cpg.call.code("foo  bar")'
+        assert normalize_query(query) == query
+
+    def test_map_pairs_sorted(self):
+        """测试 Map 投影键顺序不影响规范化结果"""
+        a = 'cpg.method.map(m => Map("name" -> m.name, "code" -> m.code))'
+        b = 'cpg.method.map(m => Map("code" -> m.code, "name" -> m.name))'
+
+        assert normalize_query(a) == normalize_query(b)
+
+    def test_nested_map_untouched(self):
+        """测试含嵌套 Map 的结构不重排"""
+        query = 'Map("sink" -> Map("file" -> f, "line" -> l), "a" -> 1)'
+        normalized = normalize_query(query)
+
+        # 外层顺序保持原样（嵌套结构不做重排）
+        assert normalized.index('"sink"') < normalized.index('"a"')
+
+    def test_non_pair_map_untouched(self):
+        """测试非键值对形式的 Map 调用保持原样"""
+        query = "list.map(x=>x.name)"
+        assert normalize_query(query) == query
+
+    def test_distinct_queries_stay_distinct(self):
+        """测试真正不同的查询不会被归一到同一形态"""
+        assert normalize_query('cpg.method.name("a")') != normalize_query(
+            'cpg.method.name("b")'
+        )
+
+
+class TestCacheKeyStats:
+    """缓存键统计测试"""
+
+    def test_observe_counters(self):
+        """测试查找/命中/规范化计数"""
+        stats = CacheKeyStats()
+        stats.observe("cpg.method.l", "cpg.method.l", hit=False)
+        stats.observe("cpg.method .l", "cpg.method.l", hit=True)
+
+        snapshot = stats.get_stats()
+        assert snapshot["lookups"] == 2
+        assert snapshot["hits"] == 1
+        assert snapshot["normalized_keys"] == 1
+
+    def test_rescued_hit_on_first_seen_variant(self):
+        """测试格式变体首次出现即命中记为救回"""
+        stats = CacheKeyStats()
+        stats.observe("cpg.method.l", "cpg.method.l", hit=False)
+        # 同一查询的另一种排版：原文首次出现且命中
+        stats.observe("cpg.method\n  .l", "cpg.method.l", hit=True)
+        # 同一排版再次命中不再计入救回
+        stats.observe("cpg.method\n  .l", "cpg.method.l", hit=True)
+
+        assert stats.get_stats()["rescued_hits"] == 1
+
+    def test_seen_set_bounded(self):
+        """测试原文形态记录有上限"""
+        stats = CacheKeyStats()
+        for i in range(CacheKeyStats.SEEN_LIMIT + 100):
+            stats.observe(f"cpg.method.name(\"f{i}\").l", "n", hit=False)
+
+        assert len(stats._seen_raw) == CacheKeyStats.SEEN_LIMIT
+
+    def test_global_singleton_reset(self):
+        """测试全局统计的获取与重置"""
+        get_cache_key_stats().observe("q", "q", hit=False)
+        assert get_cache_key_stats().lookups == 1
+
+        reset_cache_key_stats()
+        assert get_cache_key_stats().lookups == 0
@@ -0,0 +1,133 @@
+"""DOT 文件通道传输测试"""
+
+from unittest.mock import patch
+
+import pytest
+
+from joern_mcp.utils import dot_transfer
+from joern_mcp.utils.dot_transfer import (
+    clean_dot_string,
+    dot_transfer_path,
+    fetch_dot,
+)
+
+
+class FakeExecutor:
+    """把 |> 落盘行为模拟到本地文件系统的执行器"""
+
+    def __init__(self, dot_content='digraph CFG { "a" -> "b" }', pipe_works=True):
+        self.dot_content = dot_content
+        self.pipe_works = pipe_works
+        self.queries: list[str] = []
+
+    async def execute(self, query, format="json", use_cache=True, **kwargs):
+        self.queries.append(query)
+        if "|>" in query:
+            if not self.pipe_works:
+                return {"success": False, "stderr": "value |> is not a member"}
+            target = query.split('|> "')[1].rstrip('"')
+            with open(target, "w", encoding="utf-8") as f:
+                f.write(self.dot_content)
+            return {"success": True, "stdout": ""}
+        return {"success": True, "stdout": f'"{self.dot_content}"'}
+
+
+@pytest.fixture(autouse=True)
+def transfer_dir(tmp_path):
+    """DOT 传输目录指向测试临时目录"""
+    with (
+        patch.object(dot_transfer.settings, "joern_workspace", tmp_path),
+        patch.object(dot_transfer.settings, "dot_inline_max_bytes", 1048576),
+    ):
+        yield tmp_path
+
+
+class TestCleanDotString:
+    """REPL stdout 清洗（内联回退路径）"""
+
+    def test_strips_repl_prefix(self):
+        result = clean_dot_string('val res0: String = "digraph { }"')
+
+        assert result == "digraph { }"
+
+    def test_unescapes_content(self):
+        result = clean_dot_string('"digraph {\\n\\"a\\" }"')
+
+        assert result == 'digraph {\n"a" }'
+
+
+class TestDotTransferPath:
+    """传输文件路径分配"""
+
+    def test_paths_are_unique(self, transfer_dir):
+        assert dot_transfer_path() != dot_transfer_path()
+
+    def test_directory_created(self, transfer_dir):
+        path = dot_transfer_path()
+
+        assert path.parent.is_dir()
+        assert path.parent == transfer_dir / "dot_transfer"
+
+
+class TestFetchDot:
+    """文件通道取回"""
+
+    @pytest.mark.asyncio
+    async def test_small_graph_inlined_and_file_removed(self, transfer_dir):
+        """小图经文件落盘后内联返回，临时文件删除"""
+        executor = FakeExecutor()
+
+        result = await fetch_dot(executor, "cpg.method.dotCfg.head")
+
+        assert result["success"] is True
+        assert result["transfer"] == "file_inline"
+        assert result["dot"].startswith("digraph")
+        assert not list((transfer_dir / "dot_transfer").iterdir())
+
+    @pytest.mark.asyncio
+    async def test_piped_query_uses_pipe_operator(self, transfer_dir):
+        """查询通过 |> 落盘而不是 stdout 回传"""
+        executor = FakeExecutor()
+
+        await fetch_dot(executor, "cpg.method.dotCfg.head")
+
+        assert "|>" in executor.queries[0]
+
+    @pytest.mark.asyncio
+    async def test_large_graph_returns_file_path(self, transfer_dir):
+        """超过内联上限的大图返回文件路径并保留文件"""
+        executor = FakeExecutor(dot_content="x" * 100)
+
+        with patch.object(dot_transfer.settings, "dot_inline_max_bytes", 10):
+            result = await fetch_dot(executor, "cpg.method.dotCfg.head")
+
+        assert result["transfer"] == "file"
+        assert result["dot"] is None
+        assert result["size_bytes"] == 100
+        with open(result["dot_file"], encoding="utf-8") as f:
+            assert f.read() == "x" * 100
+
+    @pytest.mark.asyncio
+    async def test_pipe_failure_falls_back_to_inline(self, transfer_dir):
+        """|> 不可用时回退 stdout 内联并清洗"""
+        executor = FakeExecutor(pipe_works=False)
+
+        result = await fetch_dot(executor, "cpg.method.dotCfg.head")
+
+        assert result["success"] is True
+        assert result["transfer"] == "inline"
+        assert result["dot"].startswith("digraph")
+        assert len(executor.queries) == 2
+
+    @pytest.mark.asyncio
+    async def test_both_paths_failing_reports_error(self, transfer_dir):
+        """两条通道都失败时返回错误"""
+
+        class BrokenExecutor:
+            async def execute(self, query, **kwargs):
+                return {"success": False, "stderr": "no cpg loaded"}
+
+        result = await fetch_dot(BrokenExecutor(), "cpg.method.dotCfg.head")
+
+        assert result["success"] is False
+        assert "no cpg loaded" in result["error"]
@@ -0,0 +1,78 @@
+"""CPGQL 分页支持测试"""
+
+import pytest
+
+from joern_mcp.utils.pagination import (
+    apply_page_window,
+    decode_cursor,
+    encode_cursor,
+)
+
+
+class TestApplyPageWindow:
+    """分页窗口注入测试"""
+
+    def test_appends_drop_take(self):
+        """测试在遍历末尾注入 drop/take"""
+        query = "cpg.method.name"
+
+        assert apply_page_window(query, 0, 101) == "cpg.method.name.drop(0).take(101)"
+
+    def test_strips_tojson_suffix(self):
+        """测试剥离 .toJson 后缀（executor 会重新追加）"""
+        query = "cpg.method.name.toJson"
+
+        assert apply_page_window(query, 50, 51) == "cpg.method.name.drop(50).take(51)"
+
+    def test_strips_l_suffix(self):
+        """测试剥离 .l 后缀，窗口下推到惰性遍历"""
+        query = "cpg.call.code.l"
+
+        assert apply_page_window(query, 10, 11) == "cpg.call.code.drop(10).take(11)"
+
+    def test_preserves_project_prefix(self):
+        """测试多项目前缀不受影响"""
+        query = 'workspace.project("demo").get.cpg.get.method.name'
+
+        paged = apply_page_window(query, 0, 11)
+
+        assert paged.startswith('workspace.project("demo")')
+        assert paged.endswith(".drop(0).take(11)")
+
+
+class TestCursor:
+    """continuation token 测试"""
+
+    def test_roundtrip(self):
+        """测试编码后可解码出原偏移"""
+        query = "cpg.method.name"
+
+        cursor = encode_cursor(100, query)
+
+        assert decode_cursor(cursor, query) == 100
+
+    def test_cursor_is_opaque(self):
+        """测试游标是 URL 安全的不透明字符串"""
+        cursor = encode_cursor(0, "cpg.method.name")
+
+        assert isinstance(cursor, str)
+        assert " " not in cursor
+
+    def test_rejects_cursor_from_other_query(self):
+        """测试游标不能跨查询复用"""
+        cursor = encode_cursor(100, "cpg.method.name")
+
+        with pytest.raises(ValueError, match="does not match"):
+            decode_cursor(cursor, "cpg.call.code")
+
+    def test_rejects_malformed_cursor(self):
+        """测试非法游标报错"""
+        with pytest.raises(ValueError, match="Invalid cursor"):
+            decode_cursor("not-a-cursor!!", "cpg.method.name")
+
+    def test_rejects_negative_offset(self):
+        """测试负偏移被拒绝"""
+        cursor = encode_cursor(-1, "cpg.method.name")
+
+        with pytest.raises(ValueError, match="Invalid cursor offset"):
+            decode_cursor(cursor, "cpg.method.name")
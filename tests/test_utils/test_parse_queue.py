@@ -0,0 +1,147 @@
+"""解析任务队列测试"""
+
+import asyncio
+
+import pytest
+
+from joern_mcp.utils.parse_queue import (
+    JOB_COMPLETED,
+    JOB_FAILED,
+    ParseQueue,
+)
+
+
+class TestParseQueue:
+    """ParseQueue 测试"""
+
+    @pytest.mark.asyncio
+    async def test_submit_returns_immediately(self):
+        """submit 不等待任务完成就返回 job_id"""
+        queue = ParseQueue(parallelism=2)
+        started = asyncio.Event()
+
+        async def runner():
+            started.set()
+            await asyncio.sleep(10)
+            return {"success": True}
+
+        job_id = queue.submit("/src/a", "a", runner)
+
+        assert job_id
+        assert queue.get_job(job_id) is not None
+        # 取消在途任务，避免测试悬挂
+        await asyncio.sleep(0)
+        for task in list(queue._tasks.values()):
+            task.cancel()
+
+    @pytest.mark.asyncio
+    async def test_successful_job_completes(self):
+        """成功的任务进入 completed 状态并保留结果"""
+        queue = ParseQueue(parallelism=2)
+
+        async def runner():
+            return {"success": True, "project_name": "a"}
+
+        job_id = queue.submit("/src/a", "a", runner)
+        await queue.wait_all()
+
+        job = queue.get_job(job_id)
+        assert job.state == JOB_COMPLETED
+        assert job.result["project_name"] == "a"
+        assert job.finished_at is not None
+
+    @pytest.mark.asyncio
+    async def test_failed_result_marks_job_failed(self):
+        """runner 返回 success=False 时任务标记为 failed"""
+        queue = ParseQueue(parallelism=2)
+
+        async def runner():
+            return {"success": False, "error": "parse error"}
+
+        job_id = queue.submit("/src/a", "a", runner)
+        await queue.wait_all()
+
+        job = queue.get_job(job_id)
+        assert job.state == JOB_FAILED
+        assert job.error == "parse error"
+
+    @pytest.mark.asyncio
+    async def test_exception_marks_job_failed(self):
+        """runner 抛异常时任务标记为 failed 而不影响队列"""
+        queue = ParseQueue(parallelism=2)
+
+        async def runner():
+            raise RuntimeError("boom")
+
+        job_id = queue.submit("/src/a", "a", runner)
+        await queue.wait_all()
+
+        job = queue.get_job(job_id)
+        assert job.state == JOB_FAILED
+        assert "boom" in job.error
+
+    @pytest.mark.asyncio
+    async def test_parallelism_is_bounded(self):
+        """同时运行的任务数不超过并行度"""
+        queue = ParseQueue(parallelism=2)
+        running = 0
+        peak = 0
+
+        async def runner():
+            nonlocal running, peak
+            running += 1
+            peak = max(peak, running)
+            await asyncio.sleep(0.01)
+            running -= 1
+            return {"success": True}
+
+        for i in range(6):
+            queue.submit(f"/src/p{i}", f"p{i}", runner)
+        await queue.wait_all()
+
+        assert peak <= 2
+        assert all(j.state == JOB_COMPLETED for j in queue.get_all())
+
+    @pytest.mark.asyncio
+    async def test_summary_counts_states(self):
+        """summary 按状态统计进度"""
+        queue = ParseQueue(parallelism=4)
+
+        async def ok():
+            return {"success": True}
+
+        async def bad():
+            return {"success": False, "error": "x"}
+
+        queue.submit("/src/a", "a", ok)
+        queue.submit("/src/b", "b", bad)
+        await queue.wait_all()
+
+        summary = queue.summary()
+        assert summary["total"] == 2
+        assert summary["done"] == 2
+        assert summary["by_state"][JOB_COMPLETED] == 1
+        assert summary["by_state"][JOB_FAILED] == 1
+        assert summary["in_progress"] == 0
+
+    @pytest.mark.asyncio
+    async def test_to_dict_omits_result_by_default(self):
+        """列表视图不携带完整解析结果（避免状态报告过大）"""
+        queue = ParseQueue(parallelism=2)
+
+        async def runner():
+            return {"success": True, "output": "x" * 1000}
+
+        job_id = queue.submit("/src/a", "a", runner)
+        await queue.wait_all()
+
+        job = queue.get_job(job_id)
+        assert "result" not in job.to_dict()
+        assert "result" in job.to_dict(include_result=True)
+
+    @pytest.mark.asyncio
+    async def test_unknown_job_lookup(self):
+        """未知 job_id 返回 None"""
+        queue = ParseQueue(parallelism=2)
+
+        assert queue.get_job("nonexistent") is None
@@ -12,7 +12,9 @@ from joern_mcp.utils.performance import (
     AdaptiveSemaphore,
     HybridCache,
     PerformanceMetrics,
+    PriorityScheduler,
     QueryComplexityAnalyzer,
+    QueryCostModel,
     SlowQueryLogger,
     get_metrics,
     reset_metrics,
@@ -212,6 +214,133 @@ class TestHybridCache:
         assert cache.get("list") == large_list
 
 
+class TestPersistentCache:
+    """测试磁盘持久化缓存"""
+
+    def test_set_and_get(self, tmp_path):
+        """测试基本读写"""
+        from joern_mcp.utils.performance import PersistentCache
+
+        cache = PersistentCache(tmp_path / "cache.db")
+        cache.set("key1", {"result": [1, 2, 3]})
+
+        assert cache.get("key1") == {"result": [1, 2, 3]}
+
+    def test_survives_reopen(self, tmp_path):
+        """测试缓存跨连接存活（模拟进程重启）"""
+        from joern_mcp.utils.performance import PersistentCache
+
+        cache = PersistentCache(tmp_path / "cache.db")
+        cache.set("key1", {"data": "value"})
+        cache.close()
+
+        cache2 = PersistentCache(tmp_path / "cache.db")
+        assert cache2.get("key1") == {"data": "value"}
+
+    def test_ttl_expiry(self, tmp_path):
+        """测试TTL过期"""
+        from joern_mcp.utils.performance import PersistentCache
+
+        cache = PersistentCache(tmp_path / "cache.db", ttl=0)
+        cache.set("key1", "value")
+
+        assert cache.get("key1") is None
+
+    def test_hybrid_cache_falls_through_to_persistent(self, tmp_path):
+        """测试 HybridCache 内存未命中时回源持久层"""
+        from joern_mcp.utils.performance import PersistentCache
+
+        persistent = PersistentCache(tmp_path / "cache.db")
+        persistent.set("key1", {"cached": True})
+
+        # 新的 HybridCache（模拟重启后内存为空）
+        cache = HybridCache(persistent=persistent)
+        assert cache.get("key1") == {"cached": True}
+        assert cache.stats["persistent_hits"] == 1
+
+        # 回填后第二次访问走内存
+        assert cache.get("key1") == {"cached": True}
+        assert cache.stats["cold_hits"] == 1
+
+    def test_hybrid_cache_writes_persistent(self, tmp_path):
+        """测试 HybridCache 写入同步到持久层"""
+        from joern_mcp.utils.performance import PersistentCache
+
+        persistent = PersistentCache(tmp_path / "cache.db")
+        cache = HybridCache(persistent=persistent)
+        cache.set("key1", {"value": 42})
+
+        assert persistent.get("key1") == {"value": 42}
+
+    @pytest.mark.asyncio
+    async def test_hybrid_cache_async_path(self, tmp_path):
+        """测试异步接口的持久层回源和写入（语义与同步接口一致）"""
+        from joern_mcp.utils.performance import PersistentCache
+
+        persistent = PersistentCache(tmp_path / "cache.db")
+        persistent.set("key1", {"cached": True})
+
+        cache = HybridCache(persistent=persistent)
+        assert await cache.aget("key1") == {"cached": True}
+        assert cache.stats["persistent_hits"] == 1
+
+        await cache.aset("key2", {"value": 42})
+        assert persistent.get("key2") == {"value": 42}
+        assert await cache.aget("missing") is None
+
+
+class TestCpgGeneration:
+    """测试 CPG 代数跟踪"""
+
+    def test_bump_changes_salt(self, tmp_path, monkeypatch):
+        """测试代数递增后缓存键盐值变化"""
+        from joern_mcp import config
+        from joern_mcp.utils import cpg_generation
+
+        monkeypatch.setattr(config.settings, "joern_cpg_cache", tmp_path)
+        cpg_generation.reset_generations()
+
+        query = 'workspace.project("myproj").get.cpg.get.method.name'
+        salt_before = cpg_generation.cache_key_salt(query)
+
+        cpg_generation.bump_generation("myproj")
+        salt_after = cpg_generation.cache_key_salt(query)
+
+        assert salt_before != salt_after
+        cpg_generation.reset_generations()
+
+    def test_bare_cpg_query_uses_current_generation(self, tmp_path, monkeypatch):
+        """测试不带项目前缀的查询使用当前活动项目代数"""
+        from joern_mcp import config
+        from joern_mcp.utils import cpg_generation
+
+        monkeypatch.setattr(config.settings, "joern_cpg_cache", tmp_path)
+        cpg_generation.reset_generations()
+
+        salt_before = cpg_generation.cache_key_salt("cpg.method.name")
+        # 导入任意项目会递增当前活动项目代数
+        cpg_generation.bump_generation("other-project")
+        salt_after = cpg_generation.cache_key_salt("cpg.method.name")
+
+        assert salt_before != salt_after
+        cpg_generation.reset_generations()
+
+    def test_generations_persist(self, tmp_path, monkeypatch):
+        """测试代数持久化到磁盘"""
+        from joern_mcp import config
+        from joern_mcp.utils import cpg_generation
+
+        monkeypatch.setattr(config.settings, "joern_cpg_cache", tmp_path)
+        cpg_generation.reset_generations()
+
+        cpg_generation.bump_generation("proj")
+        # 模拟重启：清空内存状态后重新加载
+        cpg_generation.reset_generations()
+
+        assert cpg_generation.get_generation("proj") == 1
+        cpg_generation.reset_generations()
+
+
 class TestAdaptiveSemaphore:
     """测试自适应信号量类"""
 
@@ -298,6 +427,125 @@ class TestAdaptiveSemaphore:
         assert sem2.get_current_limit() >= 3
 
 
+class TestPriorityScheduler:
+    """测试优先级调度器"""
+
+    @pytest.mark.asyncio
+    async def test_basic_acquire_release(self):
+        """测试基本获取/释放"""
+        scheduler = PriorityScheduler(min_concurrent=2, max_concurrent=5)
+
+        await scheduler.acquire(priority=3)
+        assert scheduler.get_stats()["in_flight"] == 1
+        scheduler.release()
+        assert scheduler.get_stats()["in_flight"] == 0
+
+    @pytest.mark.asyncio
+    async def test_concurrency_limit(self):
+        """测试并发限制"""
+        scheduler = PriorityScheduler(min_concurrent=2, max_concurrent=5)
+
+        concurrent_count = 0
+        max_concurrent = 0
+
+        async def task():
+            nonlocal concurrent_count, max_concurrent
+            await scheduler.acquire(3)
+            try:
+                concurrent_count += 1
+                max_concurrent = max(max_concurrent, concurrent_count)
+                await asyncio.sleep(0.01)
+                concurrent_count -= 1
+            finally:
+                scheduler.release()
+
+        await asyncio.gather(*[task() for _ in range(10)])
+
+        assert max_concurrent <= scheduler.get_current_limit()
+
+    @pytest.mark.asyncio
+    async def test_high_priority_preempts_queue(self):
+        """测试高优先级查询插队"""
+        scheduler = PriorityScheduler(min_concurrent=1, max_concurrent=1)
+        execution_order = []
+
+        # 占住唯一的槽位
+        await scheduler.acquire(3)
+
+        async def task(name, priority):
+            await scheduler.acquire(priority)
+            try:
+                execution_order.append(name)
+            finally:
+                scheduler.release()
+
+        # 先入队低优先级，再入队高优先级
+        low = asyncio.ensure_future(task("low", 1))
+        await asyncio.sleep(0.01)
+        high = asyncio.ensure_future(task("high", 5))
+        await asyncio.sleep(0.01)
+
+        # 释放槽位，高优先级应该先执行
+        scheduler.release()
+        await asyncio.gather(low, high)
+
+        assert execution_order == ["high", "low"]
+
+    @pytest.mark.asyncio
+    async def test_fifo_within_same_priority(self):
+        """测试同优先级保持FIFO顺序"""
+        scheduler = PriorityScheduler(min_concurrent=1, max_concurrent=1)
+        execution_order = []
+
+        await scheduler.acquire(3)
+
+        async def task(name):
+            await scheduler.acquire(3)
+            try:
+                execution_order.append(name)
+            finally:
+                scheduler.release()
+
+        tasks = []
+        for name in ["first", "second", "third"]:
+            tasks.append(asyncio.ensure_future(task(name)))
+            await asyncio.sleep(0.01)
+
+        scheduler.release()
+        await asyncio.gather(*tasks)
+
+        assert execution_order == ["first", "second", "third"]
+
+    @pytest.mark.asyncio
+    async def test_adjust_does_not_strand_waiters(self):
+        """测试容量调整不会丢失等待者"""
+        scheduler = PriorityScheduler(
+            min_concurrent=1, max_concurrent=10, target_response_time=1.0
+        )
+
+        await scheduler.acquire(3)
+
+        completed = asyncio.Event()
+
+        async def waiter():
+            await scheduler.acquire(3)
+            try:
+                completed.set()
+            finally:
+                scheduler.release()
+
+        task = asyncio.ensure_future(waiter())
+        await asyncio.sleep(0.01)
+
+        # 快速响应提升容量，应唤醒等待者
+        for _ in range(10):
+            await scheduler.adjust(0.1)
+
+        await asyncio.wait_for(completed.wait(), timeout=1.0)
+        await task
+        scheduler.release()
+
+
 class TestQueryComplexityAnalyzer:
     """测试查询复杂度分析器"""
 
@@ -369,6 +617,121 @@ class TestQueryComplexityAnalyzer:
         assert result["complexity"] > 1
 
 
+class TestQueryCostModel:
+    """测试在线成本模型"""
+
+    def test_falls_back_to_heuristic_without_samples(self):
+        """无实测样本时回退启发式估计"""
+        model = QueryCostModel()
+
+        result = model.analyze("cpg.method.size")
+
+        assert result["source"] == "heuristic"
+        assert result["samples"] == 0
+        assert 1 <= result["complexity"] <= 10
+
+    def test_unanchored_regex_gets_high_prior(self):
+        """非锚定正则即使文本很短也按高成本处理"""
+        model = QueryCostModel()
+
+        result = model.analyze('cpg.method.fullName(".*memcpy.*")')
+
+        assert result["complexity"] >= QueryCostModel.UNANCHORED_REGEX_PRIOR
+        assert result["priority"] <= 3
+
+    def test_anchored_regex_not_penalized(self):
+        """锚定正则不触发高成本先验"""
+        model = QueryCostModel()
+
+        result = model.analyze('cpg.method.fullName("^main$")')
+
+        assert result["complexity"] < QueryCostModel.UNANCHORED_REGEX_PRIOR
+
+    def test_learned_estimate_after_enough_samples(self):
+        """样本足够后估计由实测耗时驱动"""
+        model = QueryCostModel()
+        query = "cpg.method.name"
+        sig = model.signature(query)
+
+        for _ in range(QueryCostModel.MIN_SAMPLES):
+            model.observe(sig, 4.0)
+
+        result = model.analyze(query)
+
+        assert result["source"] == "learned"
+        assert result["complexity"] == 8  # 4.0s / 0.5
+        assert result["estimated_time"] == pytest.approx(4.0)
+
+    def test_slow_reality_overrides_cheap_heuristic(self):
+        """启发式判为低成本的慢查询在观测后被纠正"""
+        model = QueryCostModel()
+        query = 'cpg.method.fullName(".*malloc.*").toJson'
+        sig = model.signature(query)
+
+        # 未学习前启发式本身很低（这正是要修的问题）
+        heuristic = model.analyzer.analyze(query)
+        assert heuristic["complexity"] <= 3
+
+        for _ in range(5):
+            model.observe(sig, 12.0)
+
+        result = model.analyze(query)
+        assert result["source"] == "learned"
+        assert result["complexity"] == 10
+        assert result["priority"] == 1
+
+    def test_same_shape_different_literal_shares_bucket(self):
+        """同型查询（仅参数不同）共享成本桶"""
+        model = QueryCostModel()
+
+        sig_a = model.signature('cpg.method.fullName(".*memcpy.*")')
+        sig_b = model.signature('cpg.method.fullName(".*strcpy.*")')
+
+        assert sig_a == sig_b
+
+    def test_projects_get_separate_buckets(self):
+        """不同项目的同型查询分开统计（项目规模影响耗时）"""
+        model = QueryCostModel()
+
+        sig_a = model.signature('workspace.project("small").get.cpg.get.method.name')
+        sig_b = model.signature('workspace.project("huge").get.cpg.get.method.name')
+
+        assert sig_a != sig_b
+
+    def test_ewma_tracks_recent_durations(self):
+        """EWMA 随最近耗时移动"""
+        model = QueryCostModel(alpha=0.5)
+        sig = "proj=-|root=method|ops=-|regex=0|len=0|depth=0"
+
+        model.observe(sig, 1.0)
+        model.observe(sig, 3.0)
+
+        assert model._observed[sig]["ewma"] == pytest.approx(2.0)
+        assert model._observed[sig]["max"] == 3.0
+
+    def test_bucket_count_is_bounded(self):
+        """桶数量有上限，溢出时淘汰最老的"""
+        model = QueryCostModel(max_signatures=3)
+
+        for i in range(5):
+            model.observe(f"sig-{i}", 1.0)
+
+        assert len(model._observed) == 3
+        assert "sig-0" not in model._observed
+        assert "sig-4" in model._observed
+
+    def test_get_stats_reports_top_buckets(self):
+        """统计报告包含最贵的桶"""
+        model = QueryCostModel()
+        model.observe("cheap", 0.1)
+        model.observe("expensive", 30.0)
+
+        stats = model.get_stats()
+
+        assert stats["signatures"] == 2
+        assert stats["top_cost_buckets"][0]["signature"] == "expensive"
+
+
 class TestSlowQueryLogger:
     """测试慢查询日志器"""
 
@@ -487,3 +850,286 @@ class TestGlobalMetrics:
         metrics2 = get_metrics()
         # 应该是同一个实例
         assert metrics2.total_queries == 1
+
+
+class TestStageTracing:
+    """分阶段耗时追踪测试"""
+
+    def test_record_stage_aggregates_per_stage(self):
+        """测试按阶段聚合耗时"""
+        metrics = PerformanceMetrics()
+        metrics.record_stage("query_post", 0.1)
+        metrics.record_stage("query_post", 0.3)
+        metrics.record_stage("joern_execute", 2.0)
+
+        stats = metrics.get_stage_stats()
+
+        assert stats["query_post"]["count"] == 2
+        assert stats["query_post"]["avg"] == 0.2
+        assert stats["joern_execute"]["count"] == 1
+        assert stats["joern_execute"]["p99"] == 2.0
+
+    def test_stage_times_bounded(self):
+        """测试阶段记录只保留最近1000条"""
+        metrics = PerformanceMetrics()
+        for i in range(1100):
+            metrics.record_stage("server_execute", float(i))
+
+        assert len(metrics.stage_times["server_execute"]) == 1000
+        assert metrics.stage_times["server_execute"][0] == 100.0
+
+    def test_stages_included_in_to_dict(self):
+        """测试 to_dict 携带阶段统计"""
+        metrics = PerformanceMetrics()
+        metrics.record_stage("ws_connect", 0.05)
+
+        snapshot = metrics.to_dict()
+
+        assert "ws_connect" in snapshot["stages"]
+
+    def test_trace_stage_records_to_global_metrics(self):
+        """测试 trace_stage 上下文管理器记入全局指标"""
+        from joern_mcp.utils.performance import (
+            get_metrics,
+            reset_metrics,
+            trace_stage,
+        )
+
+        reset_metrics()
+        try:
+            with trace_stage("response_parse"):
+                pass
+
+            stats = get_metrics().get_stage_stats()
+            assert stats["response_parse"]["count"] == 1
+        finally:
+            reset_metrics()
+
+    def test_trace_stage_records_on_exception(self):
+        """测试阶段内抛异常时仍记录耗时"""
+        from joern_mcp.utils.performance import (
+            get_metrics,
+            reset_metrics,
+            trace_stage,
+        )
+
+        reset_metrics()
+        try:
+            with pytest.raises(ValueError), trace_stage("scheduler_wait"):
+                raise ValueError("boom")
+
+            assert get_metrics().get_stage_stats()["scheduler_wait"]["count"] == 1
+        finally:
+            reset_metrics()
+
+
+class TestAdaptiveSemaphoreAIMD:
+    """AIMD 并发控制器测试（单一活性原语，不重建信号量）"""
+
+    @pytest.mark.asyncio
+    async def test_waiters_survive_capacity_increase(self):
+        """测试扩容不会搁浅排在旧容量上的等待者"""
+        sem = AdaptiveSemaphore(
+            min_concurrent=1, max_concurrent=10, target_response_time=1.0
+        )
+
+        await sem.acquire()
+        completed = asyncio.Event()
+
+        async def waiter():
+            async with sem:
+                completed.set()
+
+        task = asyncio.ensure_future(waiter())
+        await asyncio.sleep(0.01)
+        assert sem.get_stats()["queue_depth"] == 1
+
+        # 快速响应 + 有排队需求 → 加性扩容并唤醒等待者
+        for _ in range(10):
+            await sem.adjust(0.05)
+
+        await asyncio.wait_for(completed.wait(), timeout=1.0)
+        await task
+        sem.release()
+
+    @pytest.mark.asyncio
+    async def test_multiplicative_decrease_on_overload(self):
+        """测试过载时容量减半"""
+        sem = AdaptiveSemaphore(
+            min_concurrent=2, max_concurrent=16, target_response_time=1.0
+        )
+        sem.current_limit = 16
+
+        for _ in range(10):
+            await sem.adjust(5.0)
+
+        assert sem.get_current_limit() == 8
+
+    @pytest.mark.asyncio
+    async def test_no_increase_without_demand(self):
+        """测试空闲时不盲目扩容（增长需有排队或槽位打满）"""
+        sem = AdaptiveSemaphore(
+            min_concurrent=5, max_concurrent=20, target_response_time=1.0
+        )
+
+        for _ in range(20):
+            await sem.adjust(0.05)
+
+        assert sem.get_current_limit() == 5
+
+    @pytest.mark.asyncio
+    async def test_shrink_converges_via_release(self):
+        """测试缩容后在途查询结束时不再补位"""
+        sem = AdaptiveSemaphore(
+            min_concurrent=1, max_concurrent=4, target_response_time=1.0
+        )
+        sem.current_limit = 4
+
+        for _ in range(4):
+            await sem.acquire()
+        assert sem.get_stats()["in_flight"] == 4
+
+        for _ in range(10):
+            await sem.adjust(5.0)
+        assert sem.get_current_limit() == 2
+
+        # 释放两个槽位后收敛到新上限
+        sem.release()
+        sem.release()
+        assert sem.get_stats()["in_flight"] == 2
+
+    @pytest.mark.asyncio
+    async def test_cancelled_waiter_does_not_leak_slot(self):
+        """测试取消等待者不泄漏槽位"""
+        sem = AdaptiveSemaphore(min_concurrent=1, max_concurrent=4)
+
+        await sem.acquire()
+        task = asyncio.ensure_future(sem.acquire())
+        await asyncio.sleep(0.01)
+        task.cancel()
+        with pytest.raises(asyncio.CancelledError):
+            await task
+
+        sem.release()
+        assert sem.get_stats()["in_flight"] == 0
+
+        # 槽位仍可正常获取
+        async with sem:
+            assert sem.get_stats()["in_flight"] == 1
+
+    def test_stats_surface(self):
+        """测试状态导出字段完整"""
+        sem = AdaptiveSemaphore(min_concurrent=3, max_concurrent=12)
+
+        stats = sem.get_stats()
+
+        assert stats["current_limit"] == 3
+        assert stats["min_concurrent"] == 3
+        assert stats["max_concurrent"] == 12
+        assert stats["in_flight"] == 0
+        assert stats["queue_depth"] == 0
+
+
+class TestLatencySketch:
+    """流式分位数草图测试"""
+
+    def test_empty_sketch(self):
+        """测试空草图返回0"""
+        from joern_mcp.utils.performance import LatencySketch
+
+        sketch = LatencySketch()
+        assert sketch.quantile(50) == 0.0
+
+    def test_quantile_accuracy(self):
+        """测试分位数估计在桶误差范围内"""
+        from joern_mcp.utils.performance import LatencySketch
+
+        sketch = LatencySketch()
+        for i in range(1, 1001):
+            sketch.add(i / 1000.0)  # 0.001 .. 1.0 均匀分布
+
+        # 对数分桶的相对误差约 ±12%
+        assert abs(sketch.quantile(50) - 0.5) < 0.5 * 0.15
+        assert abs(sketch.quantile(95) - 0.95) < 0.95 * 0.15
+        assert sketch.quantile(50) < sketch.quantile(95) < sketch.quantile(99)
+
+    def test_memory_bounded_by_decay(self):
+        """测试计数衰减后样本数有界"""
+        from joern_mcp.utils.performance import LatencySketch
+
+        sketch = LatencySketch()
+        for _ in range(30000):
+            sketch.add(0.1)
+
+        assert sketch.count < LatencySketch.DECAY_THRESHOLD
+        # 衰减不改变分布形状
+        assert abs(sketch.quantile(50) - 0.1) < 0.1 * 0.15
+
+    def test_out_of_range_values(self):
+        """测试超出边界的样本落在首尾桶"""
+        from joern_mcp.utils.performance import LatencySketch
+
+        sketch = LatencySketch()
+        sketch.add(0.0)
+        sketch.add(9999.0)
+
+        assert sketch.count == 2
+        assert sketch.quantile(0) < sketch.quantile(99)
+
+
+class TestMetricDimensions:
+    """按工具/项目分维度的指标测试"""
+
+    def test_record_with_dimensions(self):
+        """测试显式传入维度"""
+        metrics = PerformanceMetrics()
+        metrics.record_query(1.0, success=True, cached=False, tool="find_callers")
+        metrics.record_query(
+            2.0, success=False, cached=False, tool="find_callers", project="webapp"
+        )
+
+        assert metrics.by_tool["find_callers"].count == 2
+        assert metrics.by_tool["find_callers"].errors == 1
+        assert metrics.by_project["webapp"].count == 1
+
+    def test_track_tool_context(self):
+        """测试 track_tool 上下文自动提供工具维度"""
+        from joern_mcp.utils.performance import track_tool
+
+        metrics = PerformanceMetrics()
+        with track_tool("scan_all_rules"):
+            metrics.record_query(0.5, success=True, cached=False)
+        metrics.record_query(0.5, success=True, cached=False)
+
+        assert metrics.by_tool["scan_all_rules"].count == 1
+        assert len(metrics.by_tool) == 1
+
+    def test_dimensions_in_to_dict(self):
+        """测试 to_dict 携带维度统计"""
+        metrics = PerformanceMetrics()
+        metrics.record_query(
+            1.0, success=True, cached=True, tool="execute_query", project="demo"
+        )
+
+        snapshot = metrics.to_dict()
+
+        assert snapshot["by_tool"]["execute_query"]["count"] == 1
+        assert snapshot["by_tool"]["execute_query"]["cache_hits"] == 1
+        assert "p95" in snapshot["by_project"]["demo"]
+
+    def test_dimension_count_bounded(self):
+        """测试维度数量有上限（FIFO 淘汰最老的）"""
+        metrics = PerformanceMetrics()
+        for i in range(PerformanceMetrics.MAX_DIMENSIONS + 10):
+            metrics.record_query(0.1, project=f"project_{i}")
+
+        assert len(metrics.by_project) == PerformanceMetrics.MAX_DIMENSIONS
+        assert "project_0" not in metrics.by_project
+
+    def test_extract_project_name(self):
+        """测试从查询前缀提取项目维度"""
+        from joern_mcp.utils.performance import extract_project_name
+
+        query = 'workspace.project("webapp").get.cpg.get.method.name.l'
+        assert extract_project_name(query) == "webapp"
+        assert extract_project_name("cpg.method.name.l") is None
@@ -0,0 +1,96 @@
+"""项目辅助函数测试（workspace catalog 缓存路径）"""
+
+from unittest.mock import AsyncMock, patch
+
+import pytest
+
+from joern_mcp.utils import project_utils
+from joern_mcp.utils.cpg_generation import bump_generation, reset_generations
+from joern_mcp.utils.project_utils import get_safe_cpg_prefix, invalidate_catalog
+
+
+@pytest.fixture(autouse=True)
+def clean_catalog(tmp_path, monkeypatch):
+    """每个测试使用独立的代数文件和空目录缓存"""
+    from joern_mcp import config
+
+    monkeypatch.setattr(config.settings, "joern_cpg_cache", tmp_path)
+    reset_generations()
+    invalidate_catalog()
+    yield
+    reset_generations()
+    invalidate_catalog()
+
+
+class TestWorkspaceCatalog:
+    """目录缓存测试"""
+
+    @pytest.mark.asyncio
+    async def test_second_call_skips_validation(self):
+        """测试同一代数内第二次调用不再往返验证"""
+        validate = AsyncMock(return_value=(True, None))
+
+        with patch.object(project_utils, "validate_project_has_cpg", validate):
+            prefix1, error1 = await get_safe_cpg_prefix(AsyncMock(), "app")
+            prefix2, error2 = await get_safe_cpg_prefix(AsyncMock(), "app")
+
+        assert error1 is None and error2 is None
+        assert prefix1 == prefix2 == 'workspace.project("app").get.cpg.get'
+        assert validate.call_count == 1
+
+    @pytest.mark.asyncio
+    async def test_generation_bump_forces_revalidation(self):
+        """测试 parse/delete 递增代数后重新验证"""
+        validate = AsyncMock(return_value=(True, None))
+
+        with patch.object(project_utils, "validate_project_has_cpg", validate):
+            await get_safe_cpg_prefix(AsyncMock(), "app")
+            bump_generation("app")
+            await get_safe_cpg_prefix(AsyncMock(), "app")
+
+        assert validate.call_count == 2
+
+    @pytest.mark.asyncio
+    async def test_failed_validation_not_cached(self):
+        """测试验证失败不写入目录缓存"""
+        validate = AsyncMock(return_value=(False, "Project 'app' not found"))
+
+        with patch.object(project_utils, "validate_project_has_cpg", validate):
+            prefix, error = await get_safe_cpg_prefix(AsyncMock(), "app")
+            await get_safe_cpg_prefix(AsyncMock(), "app")
+
+        assert prefix is None
+        assert "not found" in error
+        assert validate.call_count == 2
+
+    @pytest.mark.asyncio
+    async def test_invalidate_catalog(self):
+        """测试显式失效后重新验证"""
+        validate = AsyncMock(return_value=(True, None))
+
+        with patch.object(project_utils, "validate_project_has_cpg", validate):
+            await get_safe_cpg_prefix(AsyncMock(), "app")
+            invalidate_catalog("app")
+            await get_safe_cpg_prefix(AsyncMock(), "app")
+
+        assert validate.call_count == 2
+
+    @pytest.mark.asyncio
+    async def test_catalog_entries_are_per_project(self):
+        """测试不同项目的目录条目互不影响"""
+        validate = AsyncMock(return_value=(True, None))
+
+        with patch.object(project_utils, "validate_project_has_cpg", validate):
+            await get_safe_cpg_prefix(AsyncMock(), "app-a")
+            await get_safe_cpg_prefix(AsyncMock(), "app-b")
+            await get_safe_cpg_prefix(AsyncMock(), "app-a")
+
+        assert validate.call_count == 2
+
+    @pytest.mark.asyncio
+    async def test_missing_project_name(self):
+        """测试缺少项目名时直接报错"""
+        prefix, error = await get_safe_cpg_prefix(AsyncMock(), "")
+
+        assert prefix is None
+        assert "project_name is required" in error
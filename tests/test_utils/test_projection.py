@@ -0,0 +1,74 @@
+"""查询投影下推测试"""
+
+import pytest
+
+from joern_mcp.utils.projection import apply_projection
+
+
+class TestApplyProjection:
+    """apply_projection 测试"""
+
+    def test_bare_traversal_gets_mapped(self):
+        """裸遍历被改写为只输出声明的字段"""
+        result = apply_projection("cpg.method", ["name"])
+
+        assert result == 'cpg.method.map(x => Map("name" -> x.name))'
+
+    def test_multiple_fields(self):
+        """多个字段按声明顺序输出"""
+        result = apply_projection("cpg.method", ["name", "signature"])
+
+        assert '"name" -> x.name' in result
+        assert '"signature" -> x.signature' in result
+
+    def test_optional_int_fields_get_default(self):
+        """Option[Int] 位置字段缺失时取 -1"""
+        result = apply_projection("cpg.method", ["lineNumber", "columnNumber"])
+
+        assert '"lineNumber" -> x.lineNumber.getOrElse(-1)' in result
+        assert '"columnNumber" -> x.columnNumber.getOrElse(-1)' in result
+
+    def test_filename_uses_file_step(self):
+        """filename 走 .file 步骤（call 节点没有 filename 属性）"""
+        result = apply_projection("cpg.call", ["filename"])
+
+        assert 'x.file.name.headOption.getOrElse("<unknown>")' in result
+
+    def test_terminal_suffix_stripped(self):
+        """终结后缀先剥离再注入投影（executor 会重新追加 .toJson）"""
+        result = apply_projection("cpg.method.toJson", ["name"])
+
+        assert result == 'cpg.method.map(x => Map("name" -> x.name))'
+
+    def test_existing_map_untouched(self):
+        """已自带投影的查询保持原样"""
+        query = 'cpg.method.map(m => Map("name" -> m.name))'
+
+        assert apply_projection(query, ["signature"]) == query
+
+    def test_scalar_query_untouched(self):
+        """.size 等标量终结查询不注入投影"""
+        query = "cpg.method.size"
+
+        assert apply_projection(query, ["name"]) == query
+
+    def test_dot_query_untouched(self):
+        """.toDot 查询不注入投影"""
+        query = 'cpg.method.name("main").dotAst.toDot'
+
+        assert apply_projection(query, ["name"]) == query
+
+    def test_empty_fields_is_noop(self):
+        """fields 为空时原样返回"""
+        assert apply_projection("cpg.method", []) == "cpg.method"
+
+    def test_invalid_field_rejected(self):
+        """非法字段名（潜在注入）被拒绝"""
+        with pytest.raises(ValueError, match="Invalid projection field"):
+            apply_projection("cpg.method", ['name"); System.exit(1); ("'])
+
+    def test_page_window_compatible(self):
+        """分页窗口之后可以继续注入投影"""
+        result = apply_projection("cpg.method.drop(100).take(50)", ["name"])
+
+        assert result.startswith("cpg.method.drop(100).take(50).map(")
@@ -0,0 +1,135 @@
+"""慢查询顾问测试"""
+
+from joern_mcp.utils.query_advisor import QueryAdvisor
+
+
+class TestLiteralToExact:
+    """字面量过滤改写为索引查找"""
+
+    def test_literal_name_rewritten(self):
+        """纯字面量 .name 改写为 .nameExact"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise('cpg.method.name("main").toJson')
+
+        assert advice["query"] == 'cpg.method.nameExact("main").toJson'
+        assert advice["rewrites"][0]["type"] == "literal_to_exact"
+
+    def test_literal_fullname_rewritten(self):
+        """.fullName 同样支持 Exact 改写"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise('cpg.call.fullName("pkg.Foo.bar")')
+
+        # 包含 . 元字符的参数不改写（可能是正则）
+        assert advice["query"] == 'cpg.call.fullName("pkg.Foo.bar")'
+
+    def test_regex_argument_untouched(self):
+        """正则参数保持原样（语义不同）"""
+        advisor = QueryAdvisor()
+        query = 'cpg.method.name(".*memcpy.*")'
+
+        advice = advisor.advise(query)
+
+        assert advice["query"] == query
+        assert not advice["rewrites"]
+
+    def test_multiple_literals_all_rewritten(self):
+        """同一查询中的多个字面量过滤全部改写"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise('cpg.method.name("main").call.name("strcpy")')
+
+        assert advice["query"] == 'cpg.method.nameExact("main").call.nameExact("strcpy")'
+        assert len(advice["rewrites"]) == 2
+
+    def test_empty_argument_untouched(self):
+        """空参数不改写"""
+        advisor = QueryAdvisor()
+        query = 'cpg.method.name("")'
+
+        assert advisor.advise(query)["query"] == query
+
+
+class TestLazyTraversal:
+    """过早物化改写"""
+
+    def test_l_before_filter_removed(self):
+        """.l.filter 去掉多余的物化"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise("cpg.method.l.filter(_.isExternal)")
+
+        assert advice["query"] == "cpg.method.filter(_.isExternal)"
+        assert advice["rewrites"][0]["type"] == "lazy_traversal"
+
+    def test_l_before_map_removed(self):
+        """.l.map 同样去物化"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise("cpg.call.l.map(_.name)")
+
+        assert advice["query"] == "cpg.call.map(_.name)"
+
+    def test_terminal_l_untouched(self):
+        """末尾的 .l 是合法终结操作，保持原样"""
+        advisor = QueryAdvisor()
+        query = "cpg.method.name.l"
+
+        assert advisor.advise(query)["query"] == query
+
+
+class TestHints:
+    """无法自动改写的提示"""
+
+    def test_unanchored_regex_hint(self):
+        """非锚定正则生成提示（不改写）"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise('cpg.method.fullName(".*memcpy.*")')
+
+        types = [h["type"] for h in advice["hints"]]
+        assert "unanchored_regex" in types
+
+    def test_anchored_regex_no_hint(self):
+        """^ 锚定的正则不提示"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise('cpg.method.fullName("^pkg\\\\..*")')
+
+        assert not any(h["type"] == "unanchored_regex" for h in advice["hints"])
+
+    def test_missing_dedup_hint(self):
+        """调用关系展开缺 .dedup 时提示"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise('cpg.method.nameExact("main").caller.caller')
+
+        assert any(h["type"] == "missing_dedup" for h in advice["hints"])
+
+    def test_dedup_present_no_hint(self):
+        """已有 .dedup 不提示"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise('cpg.method.nameExact("main").caller.dedup')
+
+        assert not any(h["type"] == "missing_dedup" for h in advice["hints"])
+
+    def test_unanchored_dataflow_hint(self):
+        """reachableBy 的源/汇未锚定时提示"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise(
+            "cpg.call.argument.reachableBy(cpg.method.parameter)"
+        )
+
+        assert any(h["type"] == "unanchored_dataflow" for h in advice["hints"])
+
+    def test_clean_query_no_output(self):
+        """无问题的查询不产生改写和提示"""
+        advisor = QueryAdvisor()
+
+        advice = advisor.advise('cpg.method.nameExact("main").dedup.toJson')
+
+        assert not advice["rewrites"]
+        assert not advice["hints"]
@@ -0,0 +1,87 @@
+"""响应解析工具测试（流式解析路径）"""
+
+import json
+
+from joern_mcp.utils.response_parser import (
+    iter_parse_joern_response,
+    parse_joern_response,
+)
+
+SAMPLE_ITEMS = [{"name": f"func_{i}", "line": i} for i in range(5)]
+
+
+def _chunked(text: str, size: int) -> list[str]:
+    return [text[i : i + size] for i in range(0, len(text), size)]
+
+
+class TestIterParseJoernResponse:
+    """流式解析测试"""
+
+    def test_plain_array_chunked(self):
+        """测试分块输入的顶层 JSON 数组逐条产出"""
+        payload = json.dumps(SAMPLE_ITEMS)
+
+        items = list(iter_parse_joern_response(_chunked(payload, 7)))
+
+        assert items == SAMPLE_ITEMS
+
+    def test_repl_wrapped_escaped_array(self):
+        """测试 REPL 前导 + 字符串包裹的转义数组"""
+        payload = "val res1: String = " + json.dumps(json.dumps(SAMPLE_ITEMS)) + "\n"
+
+        items = list(iter_parse_joern_response(_chunked(payload, 5)))
+
+        assert items == SAMPLE_ITEMS
+
+    def test_escapes_across_chunk_boundaries(self):
+        """测试转义序列被块边界切断时仍正确解码"""
+        data = [{"code": 'a"b\\c\nd'}, {"code": "x,y]}"}]
+        payload = "val res2: String = " + json.dumps(json.dumps(data))
+
+        for size in (1, 3, 11):
+            assert list(iter_parse_joern_response(_chunked(payload, size))) == data
+
+    def test_scalar_elements(self):
+        """测试标量元素数组"""
+        items = list(iter_parse_joern_response('[1, 2, true, null, "s"]'))
+
+        assert items == [1, 2, True, None, "s"]
+
+    def test_empty_inputs(self):
+        """测试空数组与空输入"""
+        assert list(iter_parse_joern_response("[]")) == []
+        assert list(iter_parse_joern_response("")) == []
+
+    def test_nested_and_multi_encoded_elements(self):
+        """测试嵌套数组元素与逐条多重编码解码"""
+        assert list(iter_parse_joern_response("[[1,2],[3]]")) == [[1, 2], [3]]
+        assert list(iter_parse_joern_response('["[1,2]"]')) == [[1, 2]]
+
+    def test_non_array_falls_back_to_full_parse(self):
+        """测试非数组 payload 退回整体解析"""
+        assert list(iter_parse_joern_response('{"a": 1}')) == [{"a": 1}]
+        assert list(iter_parse_joern_response('val res1: String = "/path/x"')) == [
+            "/path/x"
+        ]
+
+    def test_unparseable_yields_nothing(self):
+        """测试无法解析的输入不抛异常"""
+        assert list(iter_parse_joern_response("garbage !!")) == []
+
+    def test_large_payload_streams_all_items(self):
+        """测试大 payload 分块流式产出全部元素"""
+        data = [{"i": i, "s": "x" * 50} for i in range(2000)]
+        payload = json.dumps(data)
+
+        items = list(iter_parse_joern_response(_chunked(payload, 997)))
+
+        assert len(items) == 2000
+        assert items[-1]["i"] == 1999
+
+    def test_streaming_matches_full_parser(self):
+        """测试流式结果与整体解析结果一致"""
+        payload = json.dumps(SAMPLE_ITEMS)
+
+        assert list(iter_parse_joern_response(payload)) == parse_joern_response(
+            payload
+        )
@@ -0,0 +1,150 @@
+"""源码哈希快照测试"""
+
+from joern_mcp.utils.source_hash import (
+    compute_source_hashes,
+    delete_snapshot,
+    diff_snapshots,
+    load_snapshot,
+    newest_source_mtime,
+    save_snapshot,
+)
+
+
+class TestComputeSourceHashes:
+    """源码哈希计算测试"""
+
+    def test_hashes_source_files(self, tmp_path):
+        """测试只对源码文件计算哈希"""
+        (tmp_path / "main.c").write_text("int main() { return 0; }")
+        (tmp_path / "util.h").write_text("#pragma once")
+        (tmp_path / "README.md").write_text("docs")
+        (tmp_path / "build.o").write_bytes(b"\x00\x01")
+
+        hashes = compute_source_hashes(str(tmp_path))
+
+        assert set(hashes) == {"main.c", "util.h"}
+
+    def test_nested_directories(self, tmp_path):
+        """测试递归遍历子目录并使用相对路径"""
+        sub = tmp_path / "src" / "core"
+        sub.mkdir(parents=True)
+        (sub / "engine.java").write_text("class Engine {}")
+
+        hashes = compute_source_hashes(str(tmp_path))
+
+        assert "src/core/engine.java" in hashes
+
+    def test_content_change_alters_hash(self, tmp_path):
+        """测试内容变化后哈希变化"""
+        target = tmp_path / "app.py"
+        target.write_text("x = 1")
+        before = compute_source_hashes(str(tmp_path))
+
+        target.write_text("x = 2")
+        after = compute_source_hashes(str(tmp_path))
+
+        assert before["app.py"] != after["app.py"]
+
+    def test_single_file_root(self, tmp_path):
+        """测试源码路径指向单个文件"""
+        target = tmp_path / "only.c"
+        target.write_text("void f() {}")
+
+        hashes = compute_source_hashes(str(target))
+
+        assert set(hashes) == {"only.c"}
+
+
+class TestSnapshotPersistence:
+    """快照持久化测试"""
+
+    def test_save_and_load_roundtrip(self, tmp_path, monkeypatch):
+        """测试快照保存后可重新加载"""
+        from joern_mcp import config
+
+        monkeypatch.setattr(config.settings, "joern_cpg_cache", tmp_path)
+
+        save_snapshot("demo", {"a.c": "abc123"})
+
+        assert load_snapshot("demo") == {"a.c": "abc123"}
+
+    def test_load_missing_snapshot(self, tmp_path, monkeypatch):
+        """测试无快照时返回 None"""
+        from joern_mcp import config
+
+        monkeypatch.setattr(config.settings, "joern_cpg_cache", tmp_path)
+
+        assert load_snapshot("never-imported") is None
+
+    def test_delete_snapshot(self, tmp_path, monkeypatch):
+        """测试删除快照后不再加载（重复删除为空操作）"""
+        from joern_mcp import config
+
+        monkeypatch.setattr(config.settings, "joern_cpg_cache", tmp_path)
+
+        save_snapshot("demo", {"a.c": "abc123"})
+        delete_snapshot("demo")
+
+        assert load_snapshot("demo") is None
+        delete_snapshot("demo")
+
+
+class TestDiffSnapshots:
+    """快照对比测试"""
+
+    def test_no_changes(self):
+        """测试无变化时三个集合均为空"""
+        snapshot = {"a.c": "h1", "b.c": "h2"}
+
+        changes = diff_snapshots(snapshot, dict(snapshot))
+
+        assert changes == {"added": [], "removed": [], "modified": []}
+
+    def test_detects_all_change_kinds(self):
+        """测试识别新增、删除、修改"""
+        old = {"a.c": "h1", "b.c": "h2"}
+        new = {"b.c": "h2-changed", "c.c": "h3"}
+
+        changes = diff_snapshots(old, new)
+
+        assert changes["added"] == ["c.c"]
+        assert changes["removed"] == ["a.c"]
+        assert changes["modified"] == ["b.c"]
+
+
+class TestNewestSourceMtime:
+    """源码最新修改时间测试"""
+
+    def test_returns_newest_source_mtime(self, tmp_path):
+        """测试返回最新源文件的 mtime，忽略非源码文件"""
+        import os
+
+        old = tmp_path / "old.c"
+        old.write_text("int a;")
+        os.utime(old, (1000, 1000))
+
+        new = tmp_path / "new.c"
+        new.write_text("int b;")
+        os.utime(new, (2000, 2000))
+
+        noise = tmp_path / "notes.md"
+        noise.write_text("docs")
+        os.utime(noise, (9000, 9000))
+
+        assert newest_source_mtime(str(tmp_path)) == 2000
+
+    def test_empty_tree_returns_zero(self, tmp_path):
+        """测试无源文件时返回 0.0"""
+        (tmp_path / "README.md").write_text("docs")
+
+        assert newest_source_mtime(str(tmp_path)) == 0.0
+
+    def test_single_file_root(self, tmp_path):
+        """测试根路径为单文件时返回其 mtime"""
+        import os
+
+        target = tmp_path / "main.c"
+        target.write_text("int main() {}")
+        os.utime(target, (1500, 1500))
+
+        assert newest_source_mtime(str(target)) == 1500
@@ -0,0 +1,109 @@
+"""流式导出写入器测试"""
+
+import gzip
+import json
+
+import pytest
+
+from joern_mcp.utils.streaming_export import (
+    StreamingExportWriter,
+    flatten_record,
+)
+
+
+class TestFlattenRecord:
+    """嵌套记录打平测试"""
+
+    def test_nested_dict_flattened(self):
+        """测试嵌套 dict 打平为点号键"""
+        record = {
+            "vulnerability": "Command Injection",
+            "sink": {"file": "main.c", "line": 20},
+        }
+
+        flat = flatten_record(record)
+
+        assert flat["vulnerability"] == "Command Injection"
+        assert flat["sink.file"] == "main.c"
+        assert flat["sink.line"] == 20
+
+    def test_list_serialized_as_json(self):
+        """测试列表字段整体序列化为 JSON 字符串"""
+        flat = flatten_record({"path": [{"code": "a"}, {"code": "b"}]})
+
+        assert json.loads(flat["path"]) == [{"code": "a"}, {"code": "b"}]
+
+
+class TestStreamingExportWriter:
+    """增量写入器测试"""
+
+    def test_ndjson_rows_one_per_line(self, tmp_path):
+        """测试 NDJSON 每条记录一行、分页追加"""
+        output = tmp_path / "out.ndjson"
+        writer = StreamingExportWriter(output)
+
+        writer.write_rows([{"name": "a"}, {"name": "b"}])
+        writer.write_rows([{"name": "c"}])
+        writer.close()
+
+        lines = output.read_text().splitlines()
+        assert len(lines) == 3
+        assert json.loads(lines[2]) == {"name": "c"}
+        assert writer.rows == 3
+
+    def test_csv_columns_from_first_record(self, tmp_path):
+        """测试 CSV 列集取自第一条记录（嵌套字段打平）"""
+        output = tmp_path / "out.csv"
+        writer = StreamingExportWriter(output, format="csv")
+
+        writer.write_rows(
+            [
+                {"name": "a", "sink": {"file": "x.c", "line": 1}},
+                {"name": "b", "sink": {"file": "y.c", "line": 2}, "extra": "ignored"},
+            ]
+        )
+        writer.close()
+
+        lines = output.read_text().splitlines()
+        assert lines[0] == "name,sink.file,sink.line"
+        assert len(lines) == 3
+        assert "ignored" not in lines[2]
+
+    def test_gzip_compression(self, tmp_path):
+        """测试 gzip 在线压缩（路径自动加 .gz）"""
+        output = tmp_path / "out.ndjson"
+        writer = StreamingExportWriter(output, compress=True)
+
+        writer.write_rows([{"name": "a"}])
+        writer.close()
+
+        assert writer.path.name == "out.ndjson.gz"
+        with gzip.open(writer.path, "rt", encoding="utf-8") as f:
+            assert json.loads(f.readline()) == {"name": "a"}
+
+    def test_discard_removes_partial_file(self, tmp_path):
+        """测试失败清理：discard 关闭并删除残留文件"""
+        output = tmp_path / "out.ndjson"
+        writer = StreamingExportWriter(output)
+        writer.write_rows([{"name": "a"}])
+
+        writer.discard()
+
+        assert not output.exists()
+
+    def test_unsupported_format_rejected(self, tmp_path):
+        """测试不支持的格式直接报错"""
+        with pytest.raises(ValueError):
+            StreamingExportWriter(tmp_path / "out.xml", format="xml")
+
+    def test_scalar_items(self, tmp_path):
+        """测试非 dict 条目（如方法名列表）也能写出"""
+        output = tmp_path / "out.csv"
+        writer = StreamingExportWriter(output, format="csv")
+
+        writer.write_rows(["main", "foo"])
+        writer.close()
+
+        lines = output.read_text().splitlines()
+        assert lines[0] == "value"
+        assert lines[1:] == ["main", "foo"]